@@ -0,0 +1,142 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+#include <algorithm>
+
+using namespace devi::core;
+
+// float32 array sizes fitting into successive levels of the memory hierarchy
+struct level {
+  const char *name;
+  std::size_t elements;
+};
+
+int main(int argc, char **argv)
+{
+  constexpr level levels[] {
+    { "L1", 1UL << 11 },     // 8KB
+    { "L2", 1UL << 15 },     // 128KB
+    { "L3", 1UL << 19 },     // 2MB
+    { "DRAM", 1UL << 24 },  // 64MB
+  };
+  constexpr std::size_t cols { 64 };
+
+  BenchmarkRunner runner { "devi::core::array", argc, argv };
+  for (const auto &l : levels) {
+    const std::size_t n { l.elements }, rows { n / cols }, f { sizeof(float) };
+    const auto name { [&](const char *op) { return std::string(op) + " " + l.name; } };
+
+    runner.run(name("construct"), n, n * f, [&] { do_not_optimize(float32(shape(n))); });
+    buffer_pool pool;
+    runner.run(name("construct pooled"), n, n * f,
+      [&] { do_not_optimize(float32(shape(n), pool)); });
+
+    float32 a { shape(rows, cols), 1.5F };
+    runner.run(name("fill"), n, n * f, [&] {
+      a.fill(2.5F);
+      do_not_optimize(a.data());
+    });
+
+    const uint8 bytes { shape(rows, cols), 7 };
+    runner.run(name("astype u8->f32"), n, n * (1 + f),
+      [&] { do_not_optimize(bytes.astype<type::float32>()); });
+    runner.run(name("astype f32->f16"), n, n * (f + 2),
+      [&] { do_not_optimize(a.astype<type::float16>()); });
+    uint8 frame { bytes.copy() };
+    auto crop { frame(slice(), slice(0, 0, 2)) };
+    runner.run(name("as<f32> crop copy"), n / 2, n / 2 * (1 + f),
+      [&] { do_not_optimize(crop.as<type::float32>().copy()); });
+
+    runner.run(name("copy"), n, 2 * n * f, [&] { do_not_optimize(a.copy()); });
+    runner.run(name("pad reflect 2"), n, 2 * n * f,
+      [&] { do_not_optimize(pad(a, 2, border::reflect)); });
+    const auto pools { sliding_window_view(a, shape(2, 2), { 2, 2 }) };
+    runner.run(name("reduce_windows max 2x2"), n, n * f * 5 / 4, [&] {
+      do_not_optimize(
+        reduce_windows(pools, 0.0F, [](float m, float x) { return std::max(m, x); }));
+    });
+
+    const std::vector<float32> quarters(4, float32 { shape(rows / 4, cols), 0.5F });
+    runner.run(name("stack 4"), n, 2 * n * f, [&] { do_not_optimize(stack(quarters)); });
+    runner.run(name("concatenate 4 cols"), n, 2 * n * f,
+      [&] { do_not_optimize(concatenate(quarters, 1)); });
+
+    // four independent chains of element-wise operations joined at the end
+    runner.run(name("eager 4 chains"), n, 7 * n * f, [&] {
+      std::vector<float32> chains;
+      for (const auto &q : quarters) chains.push_back((q * q + q) * q);
+      do_not_optimize((chains[0] + chains[1]) + (chains[2] + chains[3]));
+    });
+    graph pipeline;
+    std::vector<lazy<type::float32>> chains;
+    for (const auto &q : quarters) {
+      const auto x { pipeline.input(q) };
+      chains.push_back((x * x + x) * x);
+    }
+    (void)((chains[0] + chains[1]) + (chains[2] + chains[3]));
+    runner.run(name("graph 4 chains"), n, 7 * n * f, [&] { pipeline.run(); });
+
+    bool8 half_mask { shape(rows, cols) };
+    random::bernoulli(half_mask);
+    runner.run(name("masked_select 50%"), n, n * (f + 1) + n / 2 * f,
+      [&] { do_not_optimize(masked_select(a, half_mask)); });
+    int64 shuffled { shape(rows) };
+    random::integers(shuffled, 0, std::int64_t(rows));
+    runner.run(name("take rows"), n, 2 * n * f,
+      [&] { do_not_optimize(take(a, shuffled)); });
+
+    float32 random_values { shape(rows, cols) };
+    runner.run(name("random::uniform"), n, n * f, [&] {
+      random::uniform(random_values);
+      do_not_optimize(random_values.data());
+    });
+    runner.run(name("random::normal"), n, n * f, [&] {
+      random::normal(random_values);
+      do_not_optimize(random_values.data());
+    });
+
+    const auto b { a.copy() };
+    runner.run(name("operator=="), n, 2 * n * f, [&] { do_not_optimize(a == b); });
+    const auto wide { bytes.astype<type::float32>() };  // equal, so nothing exits early
+    runner.run(name("operator== u8/f32"), n, n * (1 + f),
+      [&] { do_not_optimize(bytes == wide); });
+    runner.run(name("allclose"), n, 2 * n * f, [&] { do_not_optimize(allclose(a, b)); });
+
+    float32 noise { shape(rows, cols) };
+    for (std::size_t i { 0 }; i < n; ++i) noise[i] = float((i * 2654435761UL) % 1000003);
+    runner.run(name("sort rows"), n, 2 * n * f, [&] { do_not_optimize(sort(noise, 1)); });
+    runner.run(name("topk 8 rows"), n, n * f,
+      [&] { do_not_optimize(topk(noise, 8, 1)); });
+    auto line { noise.copy() };
+    line.reshape(n);
+    runner.run(name("sort 1D"), n, 2 * n * f, [&] { do_not_optimize(sort(line, 0)); });
+
+    runner.run(name("reshape"), 0, 0, [&] {
+      a.reshape(cols, rows);
+      a.reshape(shape(rows, cols));
+      do_not_optimize(a.shape());
+    });
+
+    runner.run(name("operator()"), n, n * f, [&] {
+      float sum { 0 };
+      for (std::size_t i { 0 }; i < rows; ++i)
+        for (std::size_t j { 0 }; j < cols; ++j) sum += a(i, j);
+      do_not_optimize(sum);
+    });
+
+    runner.run(name("slice"), 0, 0,
+      [&] { do_not_optimize(a(slice(0, 0, 2), slice(1, cols - 1)).size()); });
+
+    auto v { a(slice(0, 0, 2), slice(0, 0, 2)) };
+    const auto vr { v.shape()[0] }, vc { v.shape()[1] };
+    runner.run(name("view operator()"), v.size(), v.size() * f, [&] {
+      float sum { 0 };
+      for (std::size_t i { 0 }; i < vr; ++i)
+        for (std::size_t j { 0 }; j < vc; ++j) sum += v(i, j);
+      do_not_optimize(sum);
+    });
+  }
+
+  return 0;
+}
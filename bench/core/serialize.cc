@@ -0,0 +1,62 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+#include <cmath>
+#include <cstdio>
+
+using namespace devi::core;
+
+// Times encoding and decoding `a`, named after its contents and compression ratio
+template<type _DType>
+void run_dataset(BenchmarkRunner &runner, const char *name, const array<_DType> &a)
+{
+  const auto bytes { a.size() * sizeof(*a.data()) };
+  const auto packed { serialize(a) };
+  char label[96];
+  std::snprintf(label, sizeof label, "%s (%.1fx)", name,
+    double(bytes) / double(packed.size()));
+
+  // throughput is of the raw bytes, which are read by encoding and written by decoding
+  runner.run(std::string("serialize ") + label, a.size(), bytes,
+    [&] { do_not_optimize(serialize(a)); });
+  array<_DType> out { a.shape() };
+  runner.run(std::string("deserialize ") + label, a.size(), bytes, [&] {
+    deserialize(packed.data(), packed.size(), out);
+    do_not_optimize(out.data());
+  });
+}
+
+int main(int argc, char **argv)
+{
+  constexpr std::size_t rows { 2048 }, cols { 2048 };
+  BenchmarkRunner runner { "devi::core::serialize", argc, argv };
+
+  // an 8-bit photo-like image: smooth shading with a little sensor noise
+  uint8 image { shape(rows, cols) };
+  uint8 grain { shape(rows, cols) };
+  random::integers(grain, 0, 4);
+  for (std::size_t i { 0 }; i < rows; ++i)
+    for (std::size_t j { 0 }; j < cols; ++j)
+      image(i, j) = std::uint8_t((i + j) / 24 + grain(i, j));
+  run_dataset(runner, "u8 image", image);
+
+  // a segmentation mask of a few large regions
+  int32 labels { shape(rows, cols) };
+  for (std::size_t i { 0 }; i < rows; ++i)
+    for (std::size_t j { 0 }; j < cols; ++j) labels(i, j) = int(i / 300 * 8 + j / 500);
+  run_dataset(runner, "i32 labels", labels);
+
+  // a smooth float field (like a depth map) and incompressible noise
+  float32 depth { shape(rows, cols) };
+  for (std::size_t i { 0 }; i < rows; ++i)
+    for (std::size_t j { 0 }; j < cols; ++j)
+      depth(i, j) = 2.0F + std::sin(float(i) / 200) * std::cos(float(j) / 300);
+  run_dataset(runner, "f32 depth", depth);
+  run_dataset(runner, "f16 depth", depth.astype<type::float16>());
+  float32 noise { shape(rows, cols) };
+  random::uniform(noise);
+  run_dataset(runner, "f32 noise", noise);
+
+  return 0;
+}
@@ -0,0 +1,50 @@
+#include "../utils.hh"
+
+#include <devi/net>
+
+using namespace devi::core;
+using namespace devi::net;
+
+// convolution layer of a ResNet-style network
+struct layer {
+  const char *name;
+  std::size_t channels, size, filters, kernel, stride, groups;
+};
+
+int main(int argc, char **argv)
+{
+  constexpr layer layers[] {
+    { "conv1 7x7/2", 3, 224, 64, 7, 2, 1 },
+    { "res2 1x1", 64, 56, 64, 1, 1, 1 },
+    { "res2 3x3", 64, 56, 64, 3, 1, 1 },
+    { "res3 3x3/2", 128, 56, 128, 3, 2, 1 },
+    { "res3 3x3", 128, 28, 128, 3, 1, 1 },
+    { "res4 3x3", 256, 14, 256, 3, 1, 1 },
+    { "res4 1x1 expand", 256, 14, 1024, 1, 1, 1 },
+    { "res5 3x3", 512, 7, 512, 3, 1, 1 },
+    { "depthwise 3x3", 256, 28, 256, 3, 1, 256 },
+  };
+  constexpr std::size_t batch { 4 };
+
+  BenchmarkRunner runner { "devi::net::conv2d", argc, argv };
+  for (const auto &l : layers) {
+    const auto kernel { shape(l.filters, l.channels / l.groups, l.kernel, l.kernel) };
+    float32 input { shape(batch, l.channels, l.size, l.size), 0.5F };
+    float32 weight { kernel, 0.25F };
+    conv2d conv { weight, l.stride, l.kernel / 2, 1, l.groups };
+    float32 output { conv.output_shape(input.shape()) };
+
+    const double ops { 2.0 * output.size() * weight.size() / l.filters };
+    const auto elements { input.size() + weight.size() + output.size() };
+    runner.run(std::string("f32 ") + l.name, output.size(), elements * sizeof(float), ops,
+      [&] { conv.forward(input, output); });
+
+    quantized<type::uint8> qinput { uint8(input.shape(), 140), 0.05F, 128 };
+    qconv2d qconv { quantized<type::int8> { int8(kernel, 3), 0.01F }, 0.1F, 0, l.stride,
+      l.kernel / 2, 1, l.groups };
+    runner.run(std::string("int8 ") + l.name, output.size(), elements, ops,
+      [&] { do_not_optimize(qconv.forward(qinput)); });
+  }
+
+  return 0;
+}
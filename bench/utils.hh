@@ -0,0 +1,162 @@
+#ifndef _HEADER_GUARD__DEVI_BENCH_UTILS_HH_
+#define _HEADER_GUARD__DEVI_BENCH_UTILS_HH_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Keeps the compiler from optimizing away the computation of `value`
+template<typename _Type>
+inline void do_not_optimize(const _Type &value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/* Timing summary of a single benchmark
+ *
+ * `elements` and `bytes` are the amount of work (elements processed, bytes read plus
+ * bytes written) and `ops` the number of arithmetic operations done by one call, all of
+ * which are only used for reporting throughput (zero means not applicable)
+ */
+struct BenchmarkResult {
+  std::string name;
+  std::size_t elements, bytes;
+  double ops;
+  std::size_t samples, iterations;  // iterations of the call timed by every sample
+  double median, p99, min;          // seconds per call
+};
+
+/* Runs benchmarks with a warmup and repeated timed samples, printing a table of the
+ * median/p99 time per call and the throughput of every benchmark
+ *
+ * Command line options:
+ *   --json <file>     also write all the results into `file` as JSON
+ *   --filter <text>   only run benchmarks whose name contains `text`
+ *   --samples <n>     number of timed samples of every benchmark (default 31)
+ *   --warmup <n>      number of untimed calls before sampling (default 2)
+ *
+ * Every sample repeats the call enough times to last atleast 50us (so that L1-sized
+ * benchmarks are not dominated by the clock resolution), and sampling stops early once a
+ * benchmark has used up its time budget of 2s (keeping atleast 5 samples)
+ */
+class BenchmarkRunner {
+
+  using clock = std::chrono::steady_clock;
+
+  std::string m_suite, m_json, m_filter;
+  std::size_t m_samples { 31 }, m_warmup { 2 };
+  std::vector<BenchmarkResult> m_results;
+
+  static double seconds_since(const clock::time_point start)
+  {
+    return std::chrono::duration<double>(clock::now() - start).count();
+  }
+
+  static void print_header()
+  {
+    std::printf("%-40s %12s %12s %10s %10s %10s\n", "benchmark", "median (us)",
+      "p99 (us)", "Gelem/s", "GB/s", "GOP/s");
+  }
+
+  static void print(const BenchmarkResult &r)
+  {
+    const auto rate { [&](const double amount) { return amount / r.median * 1e-9; } };
+    std::printf("%-40s %12.3f %12.3f ", r.name.c_str(), r.median * 1e6, r.p99 * 1e6);
+    r.elements ? std::printf("%10.3f ", rate(r.elements)) : std::printf("%10s ", "-");
+    r.bytes ? std::printf("%10.2f ", rate(r.bytes)) : std::printf("%10s ", "-");
+    r.ops ? std::printf("%10.2f\n", rate(r.ops)) : std::printf("%10s\n", "-");
+  }
+
+  void write_json() const
+  {
+    std::ofstream out { m_json };
+    out << "{\n  \"suite\": \"" << m_suite << "\",\n  \"benchmarks\": [";
+    for (std::size_t i { 0 }; i < m_results.size(); ++i) {
+      const auto &r { m_results[i] };
+      out << (i ? ",\n" : "\n") << "    { \"name\": \"" << r.name << "\""
+          << ", \"elements\": " << r.elements << ", \"bytes\": " << r.bytes
+          << ", \"ops\": " << r.ops << ", \"samples\": " << r.samples
+          << ", \"iterations\": " << r.iterations << ", \"median_s\": " << r.median
+          << ", \"p99_s\": " << r.p99 << ", \"min_s\": " << r.min
+          << ", \"elements_per_s\": " << r.elements / r.median
+          << ", \"bytes_per_s\": " << r.bytes / r.median
+          << ", \"ops_per_s\": " << r.ops / r.median << " }";
+    }
+    out << "\n  ]\n}\n";
+  }
+
+public:
+
+  BenchmarkRunner(const std::string &suite, const int argc, char **const argv)
+    : m_suite { suite }
+  {
+    for (int i { 1 }; i + 1 < argc; i += 2) {
+      if (!std::strcmp(argv[i], "--json")) m_json = argv[i + 1];
+      else if (!std::strcmp(argv[i], "--filter")) m_filter = argv[i + 1];
+      else if (!std::strcmp(argv[i], "--samples"))
+        m_samples = std::max(1UL, std::stoul(argv[i + 1]));
+      else if (!std::strcmp(argv[i], "--warmup")) m_warmup = std::stoul(argv[i + 1]);
+    }
+
+    std::printf("Benchmarking: %s\n", m_suite.c_str());
+    print_header();
+  }
+
+  ~BenchmarkRunner()
+  {
+    if (!m_json.empty()) write_json();
+  }
+
+  const std::vector<BenchmarkResult> &results() const noexcept { return m_results; }
+
+  /* Times `call()`, which processes `elements` elements, moves `bytes` bytes and performs
+   * `ops` arithmetic operations
+   */
+  template<typename _Call>
+  void run(const std::string &name, const std::size_t elements, const std::size_t bytes,
+    const double ops, _Call &&call)
+  {
+    if (name.find(m_filter) == std::string::npos) return;
+
+    for (std::size_t w { 0 }; w < m_warmup; ++w) call();
+
+    // calibrate the number of iterations of every sample
+    std::size_t iterations { 1 };
+    for (;;) {
+      const auto start { clock::now() };
+      for (std::size_t it { 0 }; it < iterations; ++it) call();
+      if (seconds_since(start) >= 50e-6 || iterations >= (1UL << 24)) break;
+      iterations *= 2;
+    }
+
+    std::vector<double> times;
+    const auto begin { clock::now() };
+    while (times.size() < m_samples && (times.size() < 5 || seconds_since(begin) < 2.0)) {
+      const auto start { clock::now() };
+      for (std::size_t it { 0 }; it < iterations; ++it) call();
+      times.push_back(seconds_since(start) / double(iterations));
+    }
+
+    std::sort(times.begin(), times.end());
+    const auto n { times.size() };
+    const auto rank { std::size_t(std::ceil(0.99 * double(n))) - 1 };  // nearest rank
+    m_results.push_back({ name, elements, bytes, ops, n, iterations,
+      n % 2 ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2, times[rank],
+      times[0] });
+    print(m_results.back());
+  }
+
+  template<typename _Call>
+  void run(const std::string &name, const std::size_t elements, const std::size_t bytes,
+    _Call &&call)
+  {
+    this->run(name, elements, bytes, 0.0, std::forward<_Call>(call));
+  }
+};
+
+#endif
@@ -0,0 +1,38 @@
+#include "../utils.hh"
+
+#include <devi/vis>
+
+#include <cmath>
+#include <vector>
+
+using namespace devi::core;
+using namespace devi::vis;
+
+int main(int argc, char **argv)
+{
+  constexpr std::size_t H { 1080 }, W { 1920 }, n { H * W };
+  BenchmarkRunner runner { "devi::vis::label", argc, argv };
+
+  // a thresholded frame of round blobs, and salt-and-pepper noise (many tiny components)
+  bool8 blobs { shape(H, W) };
+  for (std::size_t y { 0 }; y < H; ++y)
+    for (std::size_t x { 0 }; x < W; ++x)
+      blobs(y, x) = std::hypot(double(y % 90) - 45, double(x % 120) - 60) < 35;
+  uint8 noise { shape(H, W) };
+  for (std::size_t i { 0 }; i < n; ++i) noise[i] = (i * 2654435761UL >> 11) % 100 < 30;
+
+  std::vector<region> regions;
+  for (const unsigned connectivity : { 4, 8 }) {
+    const auto suffix { " (" + std::to_string(connectivity) + "-connected)" };
+    runner.run("label blobs" + suffix, n, 5 * n,
+      [&] { do_not_optimize(label(blobs, connectivity)); });
+    runner.run("label noise" + suffix, n, 5 * n,
+      [&] { do_not_optimize(label(noise, connectivity)); });
+  }
+  runner.run("label blobs + regions", n, 5 * n,
+    [&] { do_not_optimize(label(blobs, regions)); });
+  runner.run("label noise + regions", n, 5 * n,
+    [&] { do_not_optimize(label(noise, regions)); });
+
+  return 0;
+}
@@ -0,0 +1,29 @@
+#include "../utils.hh"
+
+#include <devi/vis>
+
+using namespace devi::core;
+using namespace devi::vis;
+
+int main(int argc, char **argv)
+{
+  constexpr std::size_t H { 1080 }, W { 1920 }, n { H * W };
+  BenchmarkRunner runner { "devi::vis::morphology", argc, argv };
+
+  uint8 gray { shape(H, W) };
+  for (std::size_t i { 0 }; i < n; ++i) gray[i] = (i * 2654435761UL >> 9) % 256;
+  bool8 mask { shape(H, W) };
+  for (std::size_t i { 0 }; i < n; ++i) mask[i] = gray[i] > 96;
+
+  // the time per pixel should not grow with the size of the structuring element
+  for (const std::size_t k : { 3, 5, 7, 15, 31, 63 }) {
+    const auto size { std::to_string(k) + "x" + std::to_string(k) };
+    runner.run("erode u8 " + size, n, 2 * n, [&] { do_not_optimize(erode(gray, k, k)); });
+    runner.run("dilate mask " + size, n, 2 * n,
+      [&] { do_not_optimize(dilate(mask, k, k)); });
+  }
+  runner.run("open mask 5x5", n, 4 * n, [&] { do_not_optimize(open(mask, 5, 5)); });
+  runner.run("gradient u8 3x3", n, 5 * n, [&] { do_not_optimize(gradient(gray, 3, 3)); });
+
+  return 0;
+}
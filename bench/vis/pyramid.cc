@@ -0,0 +1,40 @@
+#include "../utils.hh"
+
+#include <devi/vis>
+
+using namespace devi::core;
+using namespace devi::vis;
+
+int main(int argc, char **argv)
+{
+  constexpr std::size_t H { 1080 }, W { 1920 }, n { H * W }, levels { 5 };
+  BenchmarkRunner runner { "devi::vis::pyramid", argc, argv };
+
+  uint8 gray { shape(H, W) };
+  for (std::size_t i { 0 }; i < n; ++i) gray[i] = (i * 2654435761UL >> 9) % 256;
+  float32 depth { gray.astype<type::float32>() };
+  uint8 color { shape(H / 2, W / 2, 3) };
+  for (std::size_t i { 0 }; i < color.size(); ++i) color[i] = gray[i];
+
+  // a new frame into the same pyramid allocates nothing, unlike a pyramid per frame
+  pyramid<type::uint8> reused { gray.shape(), levels };
+  runner.run("build u8 1080p (reused)", n, 2 * n, [&] { reused.build(gray); });
+  runner.run("build u8 1080p (new)", n, 2 * n,
+    [&] { do_not_optimize(pyramid<type::uint8>(gray, levels).bytes()); });
+  pyramid<type::float32> floats { depth.shape(), levels };
+  runner.run("build f32 1080p (reused)", n, 8 * n, [&] { floats.build(depth); });
+  pyramid<type::uint8> planes { color.shape(), levels };
+  runner.run("build u8x3 540p (reused)", color.size(), 2 * color.size(),
+    [&] { planes.build(color); });
+  // the levels alone, from a frame already in the base level
+  runner.run("levels u8 1080p", n, n, [&] { reused.build(); });
+
+  laplacian_pyramid<type::uint8> bands { gray.shape(), levels };
+  runner.run("laplacian u8 1080p (reused)", n, 3 * n, [&] { bands.build(gray); });
+  runner.run("reconstruct u8 1080p", n, 3 * n,
+    [&] { do_not_optimize(bands.reconstruct().data()); });
+  runner.run("expand u8 540p to 1080p", n, 5 * n / 4,
+    [&] { do_not_optimize(expand(reused.level(1), gray.shape()).data()); });
+
+  return 0;
+}
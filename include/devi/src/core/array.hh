@@ -18,10 +18,15 @@
 #define _HEADER_GUARD__DEVI_SRC_CORE_ARRAY_HH_
 
 #include "__header_check__"
+#include "memory.hh"
 #include "view.hh"
 
 namespace devi::core::internal
 {
+  // defined in compare.hh (to avoid recursive include error)
+  template<typename _Compute, typename _A, typename _B>
+  bool equal_n(const _A *const a, const _B *const b, const std::size_t n) noexcept;
+
   // Data-owning multi-dimensional array class
   template<type _DType>
   class array {
@@ -31,6 +36,9 @@ namespace devi::core::internal
     //////////////////////////// CONSTRUCTORS ////////////////////////////
 
     /* Constructs a zero-initialized `array` with its shape specified by the argument `s`
+     *
+     * Elements are zeroed in parallel, so that their pages are placed according to
+     * `numa::placement()` (see `allocate`)
      *
      * Errors:
      * `new` can throw an `std::bad_alloc` exception
@@ -38,6 +46,14 @@ namespace devi::core::internal
     array(const class shape &s);
     array(class shape &&s);
 
+    /* Constructs a zero-initialized `array` of shape `s`, whose storage is taken from
+     * `pool` and handed back to it when the array is destroyed
+     *
+     * Errors:
+     * `new` can throw an `std::bad_alloc` exception
+     */
+    array(const class shape &s, buffer_pool &pool);
+
     /* Constructs an `array` with every element equal to `fill` and its shape specified by
      * the argument `s`
      *
@@ -63,7 +79,11 @@ namespace devi::core::internal
 
     ///////////////////////// OPERATOR OVERLOADS /////////////////////////
 
-    // Equality operator overload
+    /* Equality operator overload
+     *
+     * Arrays of different datatypes are equal if their shapes are equal and their
+     * elements compare equal after being promoted to `result_type<_DType, _Other>`
+     */
     [[nodiscard]] bool operator==(const array &other) const noexcept;
     template<enum type _Other>
     [[nodiscard]] bool operator==(const array<_Other> &other) const noexcept;
@@ -113,6 +133,18 @@ namespace devi::core::internal
     // Returns the `devi::core::type` of the array
     [[nodiscard]] enum type type() const noexcept;
 
+    // Returns a pointer to the contiguous memory owned by the array
+    [[nodiscard]] native_type *data() noexcept;
+    [[nodiscard]] const native_type *data() const noexcept;
+
+    /* Returns the distance (in elements) between consecutive indices of every dimension,
+     * which are always the row-major strides of the shape
+     */
+    [[nodiscard]] slice_data stride() const;
+
+    // Returns true, since the elements of an array are always adjacent in row-major order
+    [[nodiscard]] constexpr bool is_contiguous() const noexcept;
+
     ////////////////////////////// CREATION //////////////////////////////
 
     // Returns a element-wise type-casted copy of the current array
@@ -122,6 +154,12 @@ namespace devi::core::internal
     // Returns a copy of the current array
     [[nodiscard]] array copy() const;
 
+    /* Returns a read-only window which reads the elements of the array as `_AsType`, each
+     * one converted only when it is accessed (a lazy `astype`, which never allocates)
+     */
+    template<enum type _AsType>
+    [[nodiscard]] cast_view<_AsType, _DType> as() const;
+
   public:
     ////////////////////////////// MUTATION //////////////////////////////
 
@@ -131,11 +169,15 @@ namespace devi::core::internal
     // Flattens the current array to a single dimension
     void flatten();
 
-    // Reshapes the current array
+    /* Reshapes the current array, without moving any of its elements
+     *
+     * Errors:
+     * `std::invalid_argument` if the size of the new shape is not equal to array's size
+     */
     template<typename... _Args>
     void reshape(const _Args... args);
     void reshape(const class shape &s);
-    void reshape(class shape &&s) noexcept;
+    void reshape(class shape &&s);
 
     // Squeeze the array shape to remove all unit dimensions
     void squeeze() noexcept;
@@ -148,7 +190,7 @@ namespace devi::core::internal
   private:
     ///////////////////////////// ATTRIBUTES /////////////////////////////
 
-    std::unique_ptr<native_type[]> p_data;
+    storage<native_type> p_data;
     class shape m_shape;
 
     ////////////////////////////// FRIENDS ///////////////////////////////
@@ -162,17 +204,19 @@ namespace devi::core::internal
 
   // type aliases for `array`
   // TODO: move this into `devi/core` and make it a union of array and view
-  using bool8   = array<type::bool8>;
-  using int8    = array<type::int8>;
-  using int16   = array<type::int16>;
-  using int32   = array<type::int32>;
-  using int64   = array<type::int64>;
-  using uint8   = array<type::uint8>;
-  using uint16  = array<type::uint16>;
-  using uint32  = array<type::uint32>;
-  using uint64  = array<type::uint64>;
-  using float32 = array<type::float32>;
-  using float64 = array<type::float64>;
+  using bool8    = array<type::bool8>;
+  using int8     = array<type::int8>;
+  using int16    = array<type::int16>;
+  using int32    = array<type::int32>;
+  using int64    = array<type::int64>;
+  using uint8    = array<type::uint8>;
+  using uint16   = array<type::uint16>;
+  using uint32   = array<type::uint32>;
+  using uint64   = array<type::uint64>;
+  using float16  = array<type::float16>;
+  using bfloat16 = array<type::bfloat16>;
+  using float32  = array<type::float32>;
+  using float64  = array<type::float64>;
 
 }  // namespace devi::core::internal
 
@@ -187,12 +231,21 @@ namespace devi::core::internal
 
   template<type _DType>
   array<_DType>::array(const class shape &s)
-    : p_data { new native_type[s.size()] {} }, m_shape { s }
-  { }
+    : p_data { allocate<native_type>(s.size()) }, m_shape { s }
+  {
+    DEVI_PROFILE_ALLOCATION(array, m_shape.size() * sizeof(native_type));
+  }
 
   template<type _DType>
   array<_DType>::array(class shape &&s)
-    : p_data { new native_type[s.size()] {} }, m_shape { std::move(s) }
+    : p_data { allocate<native_type>(s.size()) }, m_shape { std::move(s) }
+  {
+    DEVI_PROFILE_ALLOCATION(array, m_shape.size() * sizeof(native_type));
+  }
+
+  template<type _DType>
+  array<_DType>::array(const class shape &s, buffer_pool &pool)
+    : p_data { allocate<native_type>(s.size(), pool) }, m_shape { s }
   { }
 
   template<type _DType>
@@ -210,9 +263,11 @@ namespace devi::core::internal
   //////////////////////// COPY-MOVE SEMANTICS /////////////////////////
 
   template<type _DType>
-  array<_DType>::array(const array &copy) : array { copy.m_shape }
+  array<_DType>::array(const array &copy) : m_shape { copy.m_shape }
   {
-    std::copy_n(copy.p_data.get(), m_shape.size(), p_data.get());
+    DEVI_PROFILE_SCOPE("core::array::copy");
+    DEVI_PROFILE_ALLOCATION(array, m_shape.size() * sizeof(native_type));
+    p_data = allocate(m_shape.size(), copy.p_data.get());
   }
 
   template<type _DType>
@@ -232,15 +287,23 @@ namespace devi::core::internal
   template<type _DType>
   bool array<_DType>::operator==(const array &other) const noexcept
   {
+    DEVI_PROFILE_SCOPE("core::array::operator==");
     return m_shape == other.m_shape
-        && std::equal(p_data.get(), p_data.get() + m_shape.size(), other.p_data.get());
+        && equal_n<compute_type<native_type>>(p_data.get(), other.p_data.get(),
+          m_shape.size());
   }
 
   template< type _DType>
   template<type _Other>
   bool array<_DType>::operator==(const array<_Other> &other) const noexcept
   {
-    return false;
+    DEVI_PROFILE_SCOPE("core::array::operator==");
+    // both elements are promoted to the common datatype before being compared
+    using compute = compute_type<typename core::internal::native_type<
+      promote_types(_DType, _Other)>::type>;
+
+    return m_shape == other.m_shape
+        && equal_n<compute>(p_data.get(), other.p_data.get(), m_shape.size());
   }
 
   template<type _DType>
@@ -253,7 +316,7 @@ namespace devi::core::internal
   template<type _Other>
   bool array<_DType>::operator!=(const array<_Other> &other) const noexcept
   {
-    return true;
+    return !(*this == other);
   }
 
   template<type _DType>
@@ -369,17 +432,39 @@ namespace devi::core::internal
     return _DType;
   }
 
+  template<type _DType>
+  typename array<_DType>::native_type *array<_DType>::data() noexcept
+  {
+    return p_data.get();
+  }
+
+  template<type _DType>
+  const typename array<_DType>::native_type *array<_DType>::data() const noexcept
+  {
+    return p_data.get();
+  }
+
+  template<type _DType>
+  slice_data array<_DType>::stride() const
+  {
+    return slice_data::get_stride(m_shape);
+  }
+
+  template<type _DType>
+  constexpr bool array<_DType>::is_contiguous() const noexcept
+  {
+    return true;
+  }
+
   ////////////////////////////// CREATION //////////////////////////////
 
   template<type _DType>
   template<type _AsType>
   array<_AsType> array<_DType>::astype() const
   {
+    DEVI_PROFILE_SCOPE("core::array::astype");
     array<_AsType> ret { m_shape };
-    std::transform(p_data.get(), p_data.get() + m_shape.size(), ret.p_data.get(),
-      [](const native_type value) {
-        return static_cast<typename core::internal::native_type<_AsType>::type>(value);
-      });
+    convert(p_data.get(), ret.p_data.get(), m_shape.size());
 
     return ret;
   }
@@ -390,11 +475,22 @@ namespace devi::core::internal
     return array { *this };
   }
 
+  template<type _DType>
+  template<type _AsType>
+  cast_view<_AsType, _DType> array<_DType>::as() const
+  {
+    // the window is read-only, so the elements are never modified through the view
+    const view<_DType> whole { const_cast<native_type *>(p_data.get()), m_shape, 0,
+      slice_data::get_stride(m_shape) };
+    return cast_view<_AsType, _DType> { whole };
+  }
+
   ////////////////////////////// MUTATION //////////////////////////////
 
   template<type _DType>
   void array<_DType>::fill(const native_type val) noexcept
   {
+    DEVI_PROFILE_SCOPE("core::array::fill");
     std::fill_n(p_data.get(), m_shape.size(), val);
   }
 
@@ -414,12 +510,14 @@ namespace devi::core::internal
   template<type _DType>
   void array<_DType>::reshape(const class shape &s)
   {
-    m_shape = s;
+    this->reshape(core::internal::shape { s });
   }
 
   template<type _DType>
-  void array<_DType>::reshape(class shape &&s) noexcept
+  void array<_DType>::reshape(class shape &&s)
   {
+    if (s.size() != m_shape.size())
+      throw std::invalid_argument { "Reshape: size of the array must not change" };
     m_shape = std::move(s);
   }
 
@@ -444,4 +542,7 @@ namespace devi::core::internal
 
 }  // namespace devi::core::internal
 
+#include "cast.hh"
+#include "compare.hh"
+
 #endif
@@ -0,0 +1,222 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_CAST_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_CAST_HH_
+
+#include "__header_check__"
+#include "array.hh"
+#include "strided.hh"
+
+namespace devi::core::internal
+{
+  /* Read-only window into the elements of an `array` or a `view` of datatype `_From`,
+   * which reads them as datatype `_To` (like `astype`) without ever converting all of
+   * them at once
+   *
+   * Elements are converted one at a time on access, or block by block (in a small buffer
+   * which stays in L1) by `for_each_block`, so a consuming kernel never needs a converted
+   * copy of its input. It does not own the elements it reads, which must outlive it.
+   */
+  template<type _To, type _From>
+  class cast_view {
+    using native_type = typename native_type<_To>::type;
+    using source_type = typename internal::native_type<_From>::type;
+
+  public:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    // Constructs a window reading the elements of `source` as `_To`
+    explicit cast_view(const view<_From> &source);
+
+    ///////////////////////// OPERATOR OVERLOADS /////////////////////////
+
+    // Flat indexing into the elements, in row-major order
+    [[nodiscard]] native_type operator[](const std::size_t i) const;
+
+    /* Multi-dimensional full indexing using integers
+     *
+     * Errors:
+     * 1) `std::invalid_argument` if the number of `indices` arguments is not equal to
+     *    view's dimensionality
+     * 2) `std::out_of_range` if the argument index is valid but out of bounds for atleast
+     *    one dimension in view's shape
+     */
+    template<typename... _Indices,
+      typename = std::enable_if_t<(std::is_integral_v<_Indices> && ...)>>
+    [[nodiscard]] native_type operator()(const _Indices... indices) const;
+
+    ////////////////////////////// GETTERS ///////////////////////////////
+
+    // Returns the dimensionality of the view
+    [[nodiscard]] unsigned ndims() const noexcept;
+
+    // Returns the shape of the view
+    [[nodiscard]] const class shape &shape() const noexcept;
+
+    // Returns the total size of the view
+    [[nodiscard]] std::size_t size() const noexcept;
+
+    // Returns the `devi::core::type` the elements are read as
+    [[nodiscard]] enum type type() const noexcept;
+
+    // Returns the window into the unconverted elements
+    [[nodiscard]] const view<_From> &source() const noexcept;
+
+    ////////////////////////////// GENERAL ///////////////////////////////
+
+    /* Calls `body(index, block, n)` for consecutive blocks of the converted elements, in
+     * parallel, where `block` points to `n` elements starting at position `index` of
+     * row-major order (and is only valid during the call)
+     */
+    template<typename _Body>
+    void for_each_block(_Body &&body) const;
+
+    /* Returns a copy of the converted elements (identical to `astype` of the source)
+     *
+     * Errors:
+     * `new` can throw an `std::bad_alloc` exception
+     */
+    [[nodiscard]] array<_To> copy() const;
+
+  private:
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    view<_From> m_source;
+    runs m_runs;
+
+  };  // class cast_view
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    // number of elements converted at a time, small enough for the blocks to stay in L1
+    constexpr std::size_t cast_block { 1024 };
+  }
+
+  //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+  template<type _To, type _From>
+  cast_view<_To, _From>::cast_view(const view<_From> &source)
+    : m_source { source }, m_runs { source.shape(), source.stride() }
+  { }
+
+  ///////////////////////// OPERATOR OVERLOADS /////////////////////////
+
+  template<type _To, type _From>
+  typename cast_view<_To, _From>::native_type cast_view<_To, _From>::operator[](
+    const std::size_t i) const
+  {
+    const source_type value { m_source[i] };
+    native_type ret;
+    convert(&value, &ret, 1);
+    return ret;
+  }
+
+  template<type _To, type _From>
+  template<typename... _Indices, typename>
+  typename cast_view<_To, _From>::native_type cast_view<_To, _From>::operator()(
+    const _Indices... indices) const
+  {
+    const source_type value { m_source(indices...) };
+    native_type ret;
+    convert(&value, &ret, 1);
+    return ret;
+  }
+
+  ////////////////////////////// GETTERS ///////////////////////////////
+
+  template<type _To, type _From>
+  unsigned cast_view<_To, _From>::ndims() const noexcept
+  {
+    return m_source.ndims();
+  }
+
+  template<type _To, type _From>
+  const shape &cast_view<_To, _From>::shape() const noexcept
+  {
+    return m_source.shape();
+  }
+
+  template<type _To, type _From>
+  std::size_t cast_view<_To, _From>::size() const noexcept
+  {
+    return m_source.size();
+  }
+
+  template<type _To, type _From>
+  type cast_view<_To, _From>::type() const noexcept
+  {
+    return _To;
+  }
+
+  template<type _To, type _From>
+  const view<_From> &cast_view<_To, _From>::source() const noexcept
+  {
+    return m_source;
+  }
+
+  ////////////////////////////// GENERAL ///////////////////////////////
+
+  template<type _To, type _From>
+  template<typename _Body>
+  void cast_view<_To, _From>::for_each_block(_Body &&body) const
+  {
+    const auto step { m_runs.step() };
+    const auto *const data { m_source.data() };
+    const auto parts { partition_count(m_runs.size(), 1UL << 15) };
+    thread_pool::instance().run(parts, [&](const unsigned i) {
+      source_type gathered[cast_block];
+      native_type converted[cast_block];
+
+      m_runs.for_each(parts, i,
+        [&](const std::size_t index, const std::size_t offset, const std::size_t n) {
+          for (std::size_t j { 0 }; j < n; j += cast_block) {
+            const auto m { std::min(cast_block, n - j) };
+            const auto *in { data + offset + j * step };
+            if (step != 1) {  // strided elements are gathered before being converted
+              for (std::size_t k { 0 }; k < m; ++k) gathered[k] = in[k * step];
+              in = gathered;
+            }
+            convert(in, converted, m);
+            body(index + j, static_cast<const native_type *>(converted), m);
+          }
+        });
+    });
+  }
+
+  template<type _To, type _From>
+  array<_To> cast_view<_To, _From>::copy() const
+  {
+    DEVI_PROFILE_SCOPE("core::cast_view::copy");
+    array<_To> ret { m_source.shape() };
+    auto *const out { ret.data() };
+    this->for_each_block([out](const std::size_t index, const native_type *const block,
+                           const std::size_t n) { std::copy_n(block, n, out + index); });
+    return ret;
+  }
+
+}  // namespace devi::core::internal
+
+#endif
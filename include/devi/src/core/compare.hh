@@ -0,0 +1,322 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_COMPARE_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_COMPARE_HH_
+
+#include "__header_check__"
+#include "array.hh"
+#include "strided.hh"
+
+namespace devi::core::internal
+{
+  // `devi::core::type` of an `array` or a `view` (`is_tensor_v` is false for other types)
+  template<typename _Type>
+  struct tensor_type {
+    static constexpr bool is_tensor { false };
+  };
+  template<type _DType>
+  struct tensor_type<array<_DType>> {
+    static constexpr bool is_tensor { true };
+    static constexpr type value { _DType };
+  };
+  template<type _DType>
+  struct tensor_type<view<_DType>> {
+    static constexpr bool is_tensor { true };
+    static constexpr type value { _DType };
+  };
+
+  template<typename _Type>
+  inline constexpr bool is_tensor_v { tensor_type<_Type>::is_tensor };
+
+  // Enables an overload for any combination of `array` and `view` operands
+  template<typename _A, typename _B>
+  using enable_if_tensors = std::enable_if_t<is_tensor_v<_A> && is_tensor_v<_B>>;
+
+  /* Returns true if `a` and `b` have equal shapes and all of their elements are equal
+   * (after promotion to `result_type` when their datatypes differ)
+   *
+   * Contiguous integers of the same datatype are compared bytewise with `memcmp`, other
+   * contiguous data with a vectorized loop, and large operands are split between threads
+   * which all stop as soon as any one of them finds a mismatch
+   */
+  template<typename _A, typename _B, typename = enable_if_tensors<_A, _B>>
+  [[nodiscard]] bool array_equal(const _A &a, const _B &b);
+
+  /* Returns an element-wise `bool8` mask of whether the elements of `a` and `b` are
+   * close, that is `|a - b| <= atol + rtol * |b|`, where infinities are only close to
+   * themselves and NaNs are only close to each other if `equal_nan` is true
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if the shapes of `a` and `b` are not equal
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<typename _A, typename _B, typename = enable_if_tensors<_A, _B>>
+  [[nodiscard]] array<type::bool8> isclose(const _A &a, const _B &b,
+    const double rtol = 1e-5, const double atol = 1e-8, const bool equal_nan = false);
+
+  /* Returns true if every element of `a` is close to the corresponding element of `b`
+   * (as defined by `isclose`), with all the threads stopping at the first element which
+   * is not
+   *
+   * Errors:
+   * `std::invalid_argument` if the shapes of `a` and `b` are not equal
+   */
+  template<typename _A, typename _B, typename = enable_if_tensors<_A, _B>>
+  [[nodiscard]] bool allclose(const _A &a, const _B &b, const double rtol = 1e-5,
+    const double atol = 1e-8, const bool equal_nan = false);
+
+  /* Element-wise comparisons returning a `bool8` mask, where the elements of both
+   * operands are promoted to `result_type` before being compared
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if the shapes of `a` and `b` are not equal
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<typename _A, typename _B, typename = enable_if_tensors<_A, _B>>
+  [[nodiscard]] array<type::bool8> equal(const _A &a, const _B &b);
+  template<typename _A, typename _B, typename = enable_if_tensors<_A, _B>>
+  [[nodiscard]] array<type::bool8> not_equal(const _A &a, const _B &b);
+  template<typename _A, typename _B, typename = enable_if_tensors<_A, _B>>
+  [[nodiscard]] array<type::bool8> less(const _A &a, const _B &b);
+  template<typename _A, typename _B, typename = enable_if_tensors<_A, _B>>
+  [[nodiscard]] array<type::bool8> less_equal(const _A &a, const _B &b);
+  template<typename _A, typename _B, typename = enable_if_tensors<_A, _B>>
+  [[nodiscard]] array<type::bool8> greater(const _A &a, const _B &b);
+  template<typename _A, typename _B, typename = enable_if_tensors<_A, _B>>
+  [[nodiscard]] array<type::bool8> greater_equal(const _A &a, const _B &b);
+
+  /* Returns true if the `n` contiguous elements at `a` and `b` are all equal after
+   * conversion to `_Compute` (the kernel behind `array_equal` and `array::operator==`)
+   */
+  template<typename _Compute, typename _A, typename _B>
+  [[nodiscard]] bool equal_n(const _A *const a, const _B *const b,
+    const std::size_t n) noexcept;
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    // number of elements checked between two looks at the early exit flag
+    constexpr std::size_t compare_block { 1UL << 14 };
+
+    /* Returns true if `check(begin, end)` returns true for every block of [0, n), which
+     * are checked in parallel until any one of them fails (or serially if the thread
+     * pool cannot be used, e.g. when it fails to allocate or to spawn its threads)
+     */
+    template<typename _Check>
+    bool all_blocks(const std::size_t n, const _Check &check) noexcept
+    {
+      std::atomic<bool> ok { true };
+      try {
+        parallel_for(n, [&](const std::size_t begin, const std::size_t end) {
+          for (auto i { begin }; i < end && ok.load(std::memory_order_relaxed);
+               i += compare_block)
+            if (!check(i, std::min(end, i + compare_block)))
+              ok.store(false, std::memory_order_relaxed);
+        }, 4 * compare_block);
+      }
+      catch (...) {
+        // (the pool waits for all its tasks before rethrowing, so none is still running)
+        ok.store(true, std::memory_order_relaxed);
+        for (std::size_t i { 0 }; i < n && ok.load(std::memory_order_relaxed);
+             i += compare_block)
+          ok.store(check(i, std::min(n, i + compare_block)), std::memory_order_relaxed);
+      }
+      return ok.load(std::memory_order_relaxed);
+    }
+
+    // Datatype in which the elements of `_A` and `_B` are compared
+    template<typename _A, typename _B>
+    using compare_type = compute_type<typename native_type<promote_types(
+      tensor_type<_A>::value, tensor_type<_B>::value)>::type>;
+
+    template<typename _A, typename _B>
+    void throw_if_shapes_mismatch(const _A &a, const _B &b)
+    {
+      if (a.shape() != b.shape())
+        throw std::invalid_argument { "Comparison: operand shapes must be equal" };
+    }
+
+    // Returns the mask of `pred(a[i], b[i])`, with both elements converted to `_Compute`
+    template<typename _Compute, typename _A, typename _B, typename _Pred>
+    array<type::bool8> compare_mask(const _A &a, const _B &b, const _Pred pred)
+    {
+      throw_if_shapes_mismatch(a, b);
+      const paired_runs runs { a.shape(), a.stride(), b.stride() };
+      const auto sa { runs.step_a() }, sb { runs.step_b() };
+      const auto *const pa { a.data() };
+      const auto *const pb { b.data() };
+
+      array<type::bool8> ret { a.shape() };
+      auto *const out { ret.data() };
+      parallel_for(runs.size(), [&](const std::size_t begin, const std::size_t end) {
+        runs.for_each(begin, end, [&](const std::size_t index, const std::size_t oa,
+                                    const std::size_t ob, const std::size_t n) {
+          for (std::size_t j { 0 }; j < n; ++j)
+            out[index + j] = pred(_Compute(pa[oa + j * sa]), _Compute(pb[ob + j * sb]));
+        });
+      }, 1UL << 15);
+      return ret;
+    }
+
+    /* Returns true if `pred(a[i], b[i])` holds for every element, with both elements
+     * converted to `_Compute`
+     */
+    template<typename _Compute, typename _A, typename _B, typename _Pred>
+    bool compare_all(const _A &a, const _B &b, const _Pred pred)
+    {
+      const paired_runs runs { a.shape(), a.stride(), b.stride() };
+      const auto sa { runs.step_a() }, sb { runs.step_b() };
+      const auto *const pa { a.data() };
+      const auto *const pb { b.data() };
+
+      return all_blocks(runs.size(), [&](const std::size_t begin, const std::size_t end) {
+        unsigned failures { 0 };
+        runs.for_each(begin, end, [&](std::size_t, const std::size_t oa,
+                                    const std::size_t ob, const std::size_t n) {
+          const auto *const x { pa + oa };
+          const auto *const y { pb + ob };
+          for (std::size_t j { 0 }; j < n; ++j)
+            failures += !pred(_Compute(x[j * sa]), _Compute(y[j * sb]));
+        });
+        return failures == 0;
+      });
+    }
+
+    // Datatype in which closeness is decided (float32 stays float32, all else is float64)
+    template<typename _A, typename _B>
+    using close_type =
+      std::conditional_t<std::is_same_v<compare_type<_A, _B>, float>, float, double>;
+
+    template<typename _Type>
+    struct closeness {
+      _Type m_rtol, m_atol;
+      bool m_equal_nan;
+
+      // branchless (NaNs fail every comparison), so that it can be vectorized
+      bool operator()(const _Type x, const _Type y) const noexcept
+      {
+        constexpr auto max { std::numeric_limits<_Type>::max() };
+        const auto finite { (std::fabs(x) <= max) & (std::fabs(y) <= max) };
+        const auto nans { m_equal_nan & (x != x) & (y != y) };
+        const bool near { std::fabs(x - y) <= m_atol + m_rtol * std::fabs(y) };
+        return (x == y) | nans | (finite & near);
+      }
+    };
+  }
+
+  template<typename _Compute, typename _A, typename _B>
+  bool equal_n(const _A *const a, const _B *const b, const std::size_t n) noexcept
+  {
+    if constexpr (std::is_same_v<_A, _B> && std::is_integral_v<_A>)
+      return all_blocks(n, [&](const std::size_t begin, const std::size_t end) {
+        return std::memcmp(a + begin, b + begin, (end - begin) * sizeof(_A)) == 0;
+      });
+    else
+      return all_blocks(n, [&](const std::size_t begin, const std::size_t end) {
+        // branchless, so that every block is compared with vector instructions
+        const auto *const x { a + begin };
+        const auto *const y { b + begin };
+        unsigned mismatches { 0 };
+        for (std::size_t i { 0 }; i < end - begin; ++i)
+          mismatches += _Compute(x[i]) != _Compute(y[i]);
+        return mismatches == 0;
+      });
+  }
+
+  template<typename _A, typename _B, typename>
+  bool array_equal(const _A &a, const _B &b)
+  {
+    DEVI_PROFILE_SCOPE("core::array_equal");
+    using compute = compare_type<_A, _B>;
+    if (a.shape() != b.shape()) return false;
+
+    const paired_runs runs { a.shape(), a.stride(), b.stride() };
+    if (runs.contiguous()) return equal_n<compute>(a.data(), b.data(), runs.size());
+    return compare_all<compute>(a, b, std::equal_to<> {});
+  }
+
+  template<typename _A, typename _B, typename>
+  array<type::bool8> isclose(const _A &a, const _B &b, const double rtol,
+    const double atol, const bool equal_nan)
+  {
+    using close = close_type<_A, _B>;
+    const closeness<close> pred { close(rtol), close(atol), equal_nan };
+    return compare_mask<close>(a, b, pred);
+  }
+
+  template<typename _A, typename _B, typename>
+  bool allclose(const _A &a, const _B &b, const double rtol, const double atol,
+    const bool equal_nan)
+  {
+    DEVI_PROFILE_SCOPE("core::allclose");
+    using close = close_type<_A, _B>;
+    throw_if_shapes_mismatch(a, b);
+    const closeness<close> pred { close(rtol), close(atol), equal_nan };
+    return compare_all<close>(a, b, pred);
+  }
+
+  template<typename _A, typename _B, typename>
+  array<type::bool8> equal(const _A &a, const _B &b)
+  {
+    return compare_mask<compare_type<_A, _B>>(a, b, std::equal_to<> {});
+  }
+
+  template<typename _A, typename _B, typename>
+  array<type::bool8> not_equal(const _A &a, const _B &b)
+  {
+    return compare_mask<compare_type<_A, _B>>(a, b, std::not_equal_to<> {});
+  }
+
+  template<typename _A, typename _B, typename>
+  array<type::bool8> less(const _A &a, const _B &b)
+  {
+    return compare_mask<compare_type<_A, _B>>(a, b, std::less<> {});
+  }
+
+  template<typename _A, typename _B, typename>
+  array<type::bool8> less_equal(const _A &a, const _B &b)
+  {
+    return compare_mask<compare_type<_A, _B>>(a, b, std::less_equal<> {});
+  }
+
+  template<typename _A, typename _B, typename>
+  array<type::bool8> greater(const _A &a, const _B &b)
+  {
+    return compare_mask<compare_type<_A, _B>>(a, b, std::greater<> {});
+  }
+
+  template<typename _A, typename _B, typename>
+  array<type::bool8> greater_equal(const _A &a, const _B &b)
+  {
+    return compare_mask<compare_type<_A, _B>>(a, b, std::greater_equal<> {});
+  }
+
+}  // namespace devi::core::internal
+
+#endif
@@ -18,6 +18,7 @@
 #define _HEADER_GUARD__DEVI_SRC_CORE_DIMENSION_BASE_HH_
 
 #include "../__header_check__"
+#include "../profile.hh"
 
 #include <memory>
 
@@ -90,6 +91,7 @@ namespace devi::core::internal
   base_dimension::base_dimension(const _Args... args)
     : p_data { new std::size_t[MAX_SIZE] {} }, m_size { 0 }
   {
+    DEVI_PROFILE_ALLOCATION(dimension, MAX_SIZE * sizeof(std::size_t));
     static_assert(sizeof...(args) <= MAX_SIZE,
       "No. of arguments to `devi::core::base_dimension` must be atmost 10");
 
@@ -101,6 +103,7 @@ namespace devi::core::internal
   inline base_dimension::base_dimension(const base_dimension &copy)
     : p_data { new std::size_t[MAX_SIZE] }, m_size { copy.m_size }
   {
+    DEVI_PROFILE_ALLOCATION(dimension, MAX_SIZE * sizeof(std::size_t));
     std::copy_n(copy.p_data.get(), m_size, p_data.get());
   }
 
@@ -36,6 +36,15 @@ namespace devi::core::internal
     template<typename... _Args>
     shape(const _Args... args);
 
+    /* Static constructor for a `shape` of the first `ndims` values of `dims`, for shapes
+     * whose dimensionality is only known at runtime
+     *
+     * Errors:
+     * 1) `std::invalid_argument` if `ndims` is not in [1, 10]
+     * 2) `new` can throw an `std::bad_alloc` exception
+     */
+    static shape from_dims(const std::size_t *const dims, const unsigned ndims);
+
     //////////////////////// COPY-MOVE SEMANTICS /////////////////////////
 
     // Copy constructor
@@ -85,6 +94,9 @@ namespace devi::core::internal
 ///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
 
 #include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <string>
 
 namespace devi::core::internal
 {
@@ -96,6 +108,17 @@ namespace devi::core::internal
     static_assert(sizeof...(args) > 0, "`devi::core::shape` cannot be empty");
   }
 
+  inline shape shape::from_dims(const std::size_t *const dims, const unsigned ndims)
+  {
+    if (ndims == 0 || ndims > MAX_SIZE)
+      throw std::invalid_argument { "Shape: dimensionality must be in [1, 10]" };
+
+    shape ret { 0 };
+    std::copy_n(dims, ndims, ret.p_data.get());
+    ret.m_size = ndims;
+    return ret;
+  }
+
   //////////////////////// COPY-MOVE SEMANTICS /////////////////////////
 
   inline shape::shape(const shape &copy) : base_dimension { copy } { }
@@ -102,6 +102,8 @@ namespace devi::core::internal
 //////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
 
+#include <stdexcept>
+
 ////////////////////////////////// SLICE_DATA //////////////////////////////////
 
 namespace devi::core::internal
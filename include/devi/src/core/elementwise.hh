@@ -0,0 +1,208 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_ELEMENTWISE_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_ELEMENTWISE_HH_
+
+#include "__header_check__"
+#include "array.hh"
+#include "parallel.hh"
+
+namespace devi::core::internal
+{
+  /* Element-wise addition, subtraction, multiplication and division of two arrays of
+   * (possibly) different datatypes
+   *
+   * The result has the datatype `result_type<_A, _B>`. Elements are converted to it
+   * inside the kernel, block by block, so no converted copy of either operand is ever
+   * allocated. Integer division truncates towards zero (dividing by zero is undefined)
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if the shapes of `a` and `b` are not equal
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _A, type _B>
+  [[nodiscard]] array<result_type<_A, _B>> operator+(const array<_A> &a,
+    const array<_B> &b);
+  template<type _A, type _B>
+  [[nodiscard]] array<result_type<_A, _B>> operator-(const array<_A> &a,
+    const array<_B> &b);
+  template<type _A, type _B>
+  [[nodiscard]] array<result_type<_A, _B>> operator*(const array<_A> &a,
+    const array<_B> &b);
+  template<type _A, type _B>
+  [[nodiscard]] array<result_type<_A, _B>> operator/(const array<_A> &a,
+    const array<_B> &b);
+
+  /* In-place element-wise arithmetic, which is carried out in `result_type<_A, _B>` and
+   * converted back to the datatype of `a` (like `astype`)
+   *
+   * Errors:
+   * `std::invalid_argument` if the shapes of `a` and `b` are not equal
+   */
+  template<type _A, type _B>
+  array<_A> &operator+=(array<_A> &a, const array<_B> &b);
+  template<type _A, type _B>
+  array<_A> &operator-=(array<_A> &a, const array<_B> &b);
+  template<type _A, type _B>
+  array<_A> &operator*=(array<_A> &a, const array<_B> &b);
+  template<type _A, type _B>
+  array<_A> &operator/=(array<_A> &a, const array<_B> &b);
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <functional>
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    // number of elements converted at a time, small enough for the blocks to stay in L1
+    constexpr std::size_t elementwise_block { 256 };
+
+    /* Returns `src` if it already holds `_Compute` values, otherwise converts `n`
+     * elements into `buffer` and returns it
+     */
+    template<typename _Compute, typename _Type>
+    const _Compute *load_block(
+      const _Type *const src, _Compute *const buffer, const std::size_t n)
+    {
+      if constexpr (std::is_same_v<_Type, _Compute>)
+        return src;
+      else {
+        convert(src, buffer, n);
+        return buffer;
+      }
+    }
+
+    /* Computes `out[i] = op(a[i], b[i])` for `n` elements in parallel, with both
+     * operands converted to `_Compute` on the fly and the results converted to the
+     * datatype of `out`
+     */
+    template<typename _Compute, typename _A, typename _B, typename _Out, typename _Op>
+    void elementwise(const _A *const a, const _B *const b, _Out *const out,
+      const std::size_t n, const _Op op)
+    {
+      parallel_for(n, [&](const std::size_t begin, const std::size_t end) {
+        _Compute x[elementwise_block], y[elementwise_block];
+
+        for (auto i { begin }; i < end; i += elementwise_block) {
+          const auto m { std::min(elementwise_block, end - i) };
+          const auto *const pa { load_block(a + i, x, m) };
+          const auto *const pb { load_block(b + i, y, m) };
+
+          if constexpr (std::is_same_v<_Out, _Compute>)
+            for (std::size_t j { 0 }; j < m; ++j) out[i + j] = _Compute(op(pa[j], pb[j]));
+          else {
+            for (std::size_t j { 0 }; j < m; ++j) x[j] = _Compute(op(pa[j], pb[j]));
+            convert(x, out + i, m);
+          }
+        }
+      }, 1UL << 15);
+    }
+
+    template<type _A, type _B>
+    void throw_if_shapes_differ(const array<_A> &a, const array<_B> &b)
+    {
+      if (a.shape() != b.shape())
+        throw std::invalid_argument {
+          "Element-wise operation: shapes of the operands must be equal"
+        };
+    }
+
+    // Out-of-place operation, carried out in the promoted datatype
+    template<type _A, type _B, typename _Op>
+    array<result_type<_A, _B>> binary_op(
+      const array<_A> &a, const array<_B> &b, const _Op op)
+    {
+      constexpr auto R { result_type<_A, _B> };
+      using compute = compute_type<typename native_type<R>::type>;
+
+      DEVI_PROFILE_SCOPE("core::elementwise");
+      throw_if_shapes_differ(a, b);
+      array<R> ret { a.shape() };
+      elementwise<compute>(a.data(), b.data(), ret.data(), a.size(), op);
+      return ret;
+    }
+
+    // In-place operation, carried out in the promoted datatype
+    template<type _A, type _B, typename _Op>
+    array<_A> &binary_op_inplace(array<_A> &a, const array<_B> &b, const _Op op)
+    {
+      using compute = compute_type<typename native_type<result_type<_A, _B>>::type>;
+
+      DEVI_PROFILE_SCOPE("core::elementwise");
+      throw_if_shapes_differ(a, b);
+      elementwise<compute>(a.data(), b.data(), a.data(), a.size(), op);
+      return a;
+    }
+  }
+
+  template<type _A, type _B>
+  array<result_type<_A, _B>> operator+(const array<_A> &a, const array<_B> &b)
+  {
+    return binary_op(a, b, std::plus<> {});
+  }
+
+  template<type _A, type _B>
+  array<result_type<_A, _B>> operator-(const array<_A> &a, const array<_B> &b)
+  {
+    return binary_op(a, b, std::minus<> {});
+  }
+
+  template<type _A, type _B>
+  array<result_type<_A, _B>> operator*(const array<_A> &a, const array<_B> &b)
+  {
+    return binary_op(a, b, std::multiplies<> {});
+  }
+
+  template<type _A, type _B>
+  array<result_type<_A, _B>> operator/(const array<_A> &a, const array<_B> &b)
+  {
+    return binary_op(a, b, std::divides<> {});
+  }
+
+  template<type _A, type _B>
+  array<_A> &operator+=(array<_A> &a, const array<_B> &b)
+  {
+    return binary_op_inplace(a, b, std::plus<> {});
+  }
+
+  template<type _A, type _B>
+  array<_A> &operator-=(array<_A> &a, const array<_B> &b)
+  {
+    return binary_op_inplace(a, b, std::minus<> {});
+  }
+
+  template<type _A, type _B>
+  array<_A> &operator*=(array<_A> &a, const array<_B> &b)
+  {
+    return binary_op_inplace(a, b, std::multiplies<> {});
+  }
+
+  template<type _A, type _B>
+  array<_A> &operator/=(array<_A> &a, const array<_B> &b)
+  {
+    return binary_op_inplace(a, b, std::divides<> {});
+  }
+
+}  // namespace devi::core::internal
+
+#endif
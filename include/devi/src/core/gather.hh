@@ -0,0 +1,458 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_GATHER_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_GATHER_HH_
+
+#include "__header_check__"
+#include "array.hh"
+
+namespace devi::core::internal
+{
+  /* Returns the sub-arrays of `src` at the positions `indices` along `axis`, i.e. the
+   * result has the shape of `src` with the dimension `axis` replaced by the shape of
+   * `indices` (negative indices count back from the end of the axis)
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `axis` is out of bounds of the shape of `src`, or if
+   *    the result would have more than 10 dimensions
+   * 2) `std::out_of_range` if any index is out of bounds of the axis
+   * 3) `new` can throw an `std::bad_alloc` exception
+   * 4) compile-time error if `_IType` is not an integer datatype
+   */
+  template<type _DType, type _IType>
+  [[nodiscard]] array<_DType> take(
+    const array<_DType> &src, const array<_IType> &indices, const unsigned axis = 0);
+
+  /* Writes the sub-arrays of `values` into `dst` at the positions `indices` along `axis`,
+   * the inverse of `take` (where the same position appears more than once in `indices`,
+   * the last of its sub-arrays is written)
+   *
+   * Errors:
+   * 1) `std::invalid_argument` for the `indices` and `axis` described by `take`, or if
+   *    the shape of `values` is not the shape of `take(dst, indices, axis)`
+   * 2) `std::out_of_range` if any index is out of bounds of the axis
+   */
+  template<type _DType, type _IType>
+  void scatter(array<_DType> &dst, const array<_IType> &indices,
+    const array<_DType> &values, const unsigned axis = 0);
+
+  /* Returns the sub-arrays of `src` where `mask` is true, stacked along the first
+   * dimension, where the shape of `mask` must match the first dimensions of `src` (e.g. a
+   * mask of rows selects whole rows, and a mask of the same shape selects elements)
+   *
+   * Selection is a stream compaction split between threads, whose output offsets come
+   * from a prefix sum of the number of selected sub-arrays in every part, and elements
+   * are compacted with AVX-512 compress instructions where available
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if the shape of `mask` does not match the first
+   *    dimensions of `src`
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<_DType> masked_select(
+    const array<_DType> &src, const array<type::bool8> &mask);
+
+  /* Writes the consecutive sub-arrays of `values` into `dst` where `mask` is true, the
+   * inverse of `masked_select`
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if the shape of `mask` does not match the first
+   *    dimensions of `dst`, or if the shape of `values` is not the shape of
+   *    `masked_select(dst, mask)`
+   */
+  template<type _DType>
+  void masked_scatter(
+    array<_DType> &dst, const array<type::bool8> &mask, const array<_DType> &values);
+
+  /* Sets the sub-arrays of `dst` where `mask` is true to `value`
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if the shape of `mask` does not match the first
+   *    dimensions of `dst`
+   */
+  template<type _DType>
+  void masked_fill(array<_DType> &dst, const array<type::bool8> &mask,
+    const typename native_type<_DType>::type value);
+
+  /* Returns the positions (in row-major order) of the true elements of `mask`
+   *
+   * Errors:
+   * `new` can throw an `std::bad_alloc` exception
+   */
+  [[nodiscard]] array<type::int64> flatnonzero(const array<type::bool8> &mask);
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <bitset>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    // Layout of an array around `axis` (all the dimensions before, at and after it)
+    struct axis_layout {
+      std::size_t m_outer, m_length, m_inner;
+    };
+
+    inline axis_layout layout_around(const shape &s, const unsigned axis) noexcept
+    {
+      axis_layout ret { 1, s[axis], 1 };
+      for (unsigned d { 0 }; d < axis; ++d) ret.m_outer *= s[d];
+      for (unsigned d { axis + 1 }; d < s.ndims(); ++d) ret.m_inner *= s[d];
+      return ret;
+    }
+
+    // Returns the shape of `s` with the dimension `axis` replaced by `indices`
+    inline shape taken_shape(
+      const shape &s, const shape &indices, const unsigned axis, const char *const error)
+    {
+      if (axis >= s.ndims()) throw std::invalid_argument { error };
+      const auto ndims { s.ndims() - 1 + indices.ndims() };
+      if (ndims > 10) throw std::invalid_argument { error };
+
+      std::size_t dims[10];
+      unsigned d { 0 };
+      for (unsigned i { 0 }; i < axis; ++i) dims[d++] = s[i];
+      for (unsigned i { 0 }; i < indices.ndims(); ++i) dims[d++] = indices[i];
+      for (unsigned i { axis + 1 }; i < s.ndims(); ++i) dims[d++] = s[i];
+      return shape::from_dims(dims, ndims);
+    }
+
+    // Returns `indices` as non-negative positions along an axis of the specified length
+    template<type _IType>
+    std::vector<std::size_t> positions(
+      const array<_IType> &indices, const std::size_t length, const char *const error)
+    {
+      using index_type = typename native_type<_IType>::type;
+      static_assert(std::is_integral_v<index_type> && !std::is_same_v<index_type, bool>,
+        "Indices must be of an integer datatype");
+
+      std::vector<std::size_t> ret(indices.size());
+      DEVI_PROFILE_ALLOCATION(workspace, ret.size() * sizeof(std::size_t));
+      const auto *const idx { indices.data() };
+      const auto signed_length { std::int64_t(length) };
+      for (std::size_t j { 0 }; j < ret.size(); ++j) {
+        auto i { std::int64_t(idx[j]) };
+        if constexpr (std::is_signed_v<index_type>) i += i < 0 ? signed_length : 0;
+        if (i < 0 || i >= signed_length) throw std::out_of_range { error };
+        ret[j] = std::size_t(i);
+      }
+      return ret;
+    }
+
+    // Throws if the shape of `mask` does not match the first dimensions of `s`
+    inline void throw_if_mask_mismatch(
+      const shape &s, const shape &mask, const char *const error)
+    {
+      if (mask.ndims() > s.ndims()) throw std::invalid_argument { error };
+      for (unsigned d { 0 }; d < mask.ndims(); ++d)
+        if (mask[d] != s[d]) throw std::invalid_argument { error };
+    }
+
+    // Returns the shape of the sub-arrays of `s` selected by `count` true mask elements
+    inline shape selected_shape(
+      const shape &s, const shape &mask, const std::size_t count)
+    {
+      std::size_t dims[10] { count };
+      for (unsigned d { mask.ndims() }; d < s.ndims(); ++d)
+        dims[d - mask.ndims() + 1] = s[d];
+      return shape::from_dims(dims, s.ndims() - mask.ndims() + 1);
+    }
+
+    /* Partitioning of a mask between threads, along with the number of true elements
+     * before every part (i.e. the exclusive prefix sum of the counts of all the parts)
+     */
+    class mask_parts {
+    public:
+      explicit mask_parts(const array<type::bool8> &mask)
+        : p_mask { mask.data() }, m_size { mask.size() },
+          m_parts { partition_count(m_size, 1UL << 15) }, m_offsets(m_parts + 1)
+      {
+        const auto *const m { p_mask };
+        auto *const offsets { m_offsets.data() };
+        thread_pool::instance().run(m_parts, [&](const unsigned p) {
+          const auto [begin, end] { partition(m_size, m_parts, p) };
+          std::size_t count { 0 };
+          for (auto i { begin }; i < end; ++i) count += m[i];
+          offsets[p + 1] = count;
+        });
+        for (unsigned p { 0 }; p < m_parts; ++p) m_offsets[p + 1] += m_offsets[p];
+      }
+
+      // Returns the number of true elements in the whole mask
+      std::size_t count() const noexcept
+      {
+        return m_offsets.back();
+      }
+
+      /* Calls `body(begin, end, offset, count)` for every part in parallel, where
+       * [begin, end) is the range of the part, `offset` is the number of true elements
+       * before it and `count` is the number of true elements in it
+       */
+      template<typename _Body>
+      void for_each(_Body &&body) const
+      {
+        thread_pool::instance().run(m_parts, [&](const unsigned p) {
+          const auto [begin, end] { partition(m_size, m_parts, p) };
+          body(begin, end, m_offsets[p], m_offsets[p + 1] - m_offsets[p]);
+        });
+      }
+
+    private:
+      const bool *p_mask;
+      std::size_t m_size;
+      unsigned m_parts;
+      std::vector<std::size_t> m_offsets;
+    };
+
+    /* Copies the `kept` elements `src[i]` for which `mask[i]` is true, for all `i` in
+     * [0, n), to consecutive elements of `out`
+     *
+     * Without data-dependent branches (every element is written, but only kept ones
+     * advance the output), and with AVX-512 compress stores for 32-bit and 64-bit types
+     */
+    template<typename _Native>
+    void compact(const _Native *const src, const bool *const mask, const std::size_t n,
+      _Native *const out, const std::size_t kept) noexcept
+    {
+      std::size_t i { 0 }, k { 0 };
+#if defined(__AVX512F__)
+      if constexpr (sizeof(_Native) == 4) {
+        for (; i + 16 <= n; i += 16) {
+          const auto *const bits { reinterpret_cast<const __m128i *>(mask + i) };
+          const auto bytes { _mm_loadu_si128(bits) };
+          const auto wide { _mm512_maskz_cvtepu8_epi32(0xFFFF, bytes) };
+          const auto keep { _mm512_test_epi32_mask(wide, wide) };
+          _mm512_mask_compressstoreu_epi32(out + k, keep, _mm512_loadu_si512(src + i));
+          k += std::bitset<16>(keep).count();
+        }
+      } else if constexpr (sizeof(_Native) == 8) {
+        for (; i + 8 <= n; i += 8) {
+          const auto *const bits { reinterpret_cast<const __m128i *>(mask + i) };
+          const auto bytes { _mm_loadl_epi64(bits) };
+          const auto wide { _mm512_maskz_cvtepu8_epi64(0xFF, bytes) };
+          const auto keep { _mm512_test_epi64_mask(wide, wide) };
+          _mm512_mask_compressstoreu_epi64(out + k, keep, _mm512_loadu_si512(src + i));
+          k += std::bitset<8>(keep).count();
+        }
+      }
+#endif
+      // elements after the last kept one must not be written past the end of the output
+      for (; i < n; ++i) {
+        if (k < kept) out[k] = src[i];
+        k += mask[i];
+      }
+    }
+
+    /* Copies the sub-arrays of `inner` elements `src[i]` for which `mask[i]` is true, for
+     * all `i` in [begin, end), to consecutive sub-arrays of `out`
+     */
+    template<typename _Native>
+    void compact_rows(const _Native *const src, const bool *const mask,
+      const std::size_t begin, const std::size_t end, const std::size_t inner,
+      _Native *out) noexcept
+    {
+      for (auto i { begin }; i < end; ++i)
+        if (mask[i]) out = std::copy_n(src + i * inner, inner, out);
+    }
+  }
+
+  template<type _DType, type _IType>
+  array<_DType> take(
+    const array<_DType> &src, const array<_IType> &indices, const unsigned axis)
+  {
+    DEVI_PROFILE_SCOPE("core::take");
+    const auto error {
+      "Take: axis is out of bounds of the shape, or too many dimensions"
+    };
+    array<_DType> ret { taken_shape(src.shape(), indices.shape(), axis, error) };
+    const auto [outer, length, inner] { layout_around(src.shape(), axis) };
+    const auto pos {
+      positions(indices, length, "Take: index is out of bounds of the axis")
+    };
+
+    // every row of the result (one index of one outer sub-array) is copied independently
+    const auto count { pos.size() };
+    const auto *const in { src.data() };
+    auto *const out { ret.data() };
+    parallel_for(
+      outer * count,
+      [&](const std::size_t begin, const std::size_t end) {
+        auto o { begin / count }, j { begin % count };
+        for (auto r { begin }; r < end; ++r) {
+          std::copy_n(in + (o * length + pos[j]) * inner, inner, out + r * inner);
+          if (++j == count) j = 0, ++o;
+        }
+      },
+      std::max<std::size_t>(1, (1UL << 15) / std::max<std::size_t>(inner, 1)));
+    return ret;
+  }
+
+  template<type _DType, type _IType>
+  void scatter(array<_DType> &dst, const array<_IType> &indices,
+    const array<_DType> &values, const unsigned axis)
+  {
+    DEVI_PROFILE_SCOPE("core::scatter");
+    const auto error {
+      "Scatter: axis is out of bounds of the shape, or too many dimensions"
+    };
+    if (values.shape() != taken_shape(dst.shape(), indices.shape(), axis, error))
+      throw std::invalid_argument {
+        "Scatter: shape of the values must be the shape of `take` with the same indices"
+      };
+    const auto [outer, length, inner] { layout_around(dst.shape(), axis) };
+    const auto pos {
+      positions(indices, length, "Scatter: index is out of bounds of the axis")
+    };
+
+    /* every thread writes all the indices in order to the positions it owns (so the last
+     * of any repeated index wins), which are either whole outer sub-arrays, or ranges of
+     * the axis when there are not enough of those
+     */
+    const auto count { pos.size() };
+    const auto *const in { values.data() };
+    auto *const out { dst.data() };
+    const auto copy_row { [&](const std::size_t o, const std::size_t j) {
+      const auto *const row { in + (o * count + j) * inner };
+      std::copy_n(row, inner, out + (o * length + pos[j]) * inner);
+    } };
+
+    const auto work { outer * count * inner };
+    if (outer >= partition_count(work, 1UL << 15))
+      parallel_for(
+        outer,
+        [&](const std::size_t begin, const std::size_t end) {
+          for (auto o { begin }; o < end; ++o)
+            for (std::size_t j { 0 }; j < count; ++j) copy_row(o, j);
+        },
+        std::max<std::size_t>(1, (1UL << 15) / (count * inner + 1)));
+    else
+      parallel_for(
+        length,
+        [&](const std::size_t begin, const std::size_t end) {
+          for (std::size_t o { 0 }; o < outer; ++o)
+            for (std::size_t j { 0 }; j < count; ++j)
+              if (pos[j] >= begin && pos[j] < end) copy_row(o, j);
+        },
+        std::max<std::size_t>(1, length * (1UL << 15) / (work + 1)));
+  }
+
+  template<type _DType>
+  array<_DType> masked_select(const array<_DType> &src, const array<type::bool8> &mask)
+  {
+    DEVI_PROFILE_SCOPE("core::masked_select");
+    throw_if_mask_mismatch(src.shape(), mask.shape(),
+      "Masked select: shape of the mask must match the first dimensions of the array");
+
+    const mask_parts parts { mask };
+    array<_DType> ret { selected_shape(src.shape(), mask.shape(), parts.count()) };
+    const auto inner { src.size() / std::max<std::size_t>(mask.size(), 1) };
+    const auto *const in { src.data() };
+    const auto *const m { mask.data() };
+    auto *const out { ret.data() };
+    parts.for_each([&](const std::size_t begin, const std::size_t end,
+                     const std::size_t offset, const std::size_t count) {
+      if (inner == 1)
+        compact(in + begin, m + begin, end - begin, out + offset, count);
+      else
+        compact_rows(in, m, begin, end, inner, out + offset * inner);
+    });
+    return ret;
+  }
+
+  template<type _DType>
+  void masked_scatter(
+    array<_DType> &dst, const array<type::bool8> &mask, const array<_DType> &values)
+  {
+    DEVI_PROFILE_SCOPE("core::masked_scatter");
+    throw_if_mask_mismatch(dst.shape(), mask.shape(),
+      "Masked scatter: shape of the mask must match the first dimensions of the array");
+
+    const mask_parts parts { mask };
+    if (values.shape() != selected_shape(dst.shape(), mask.shape(), parts.count()))
+      throw std::invalid_argument {
+        "Masked scatter: shape of the values must be the shape of the selection"
+      };
+
+    const auto inner { dst.size() / std::max<std::size_t>(mask.size(), 1) };
+    const auto *const m { mask.data() };
+    const auto *in { values.data() };
+    auto *const out { dst.data() };
+    parts.for_each([&](const std::size_t begin, const std::size_t end,
+                     const std::size_t offset, std::size_t) {
+      const auto *next { in + offset * inner };
+      for (auto i { begin }; i < end; ++i)
+        if (m[i]) std::copy_n(next, inner, out + i * inner), next += inner;
+    });
+  }
+
+  template<type _DType>
+  void masked_fill(array<_DType> &dst, const array<type::bool8> &mask,
+    const typename native_type<_DType>::type value)
+  {
+    DEVI_PROFILE_SCOPE("core::masked_fill");
+    throw_if_mask_mismatch(dst.shape(), mask.shape(),
+      "Masked fill: shape of the mask must match the first dimensions of the array");
+
+    const auto inner { dst.size() / std::max<std::size_t>(mask.size(), 1) };
+    const auto *const m { mask.data() };
+    auto *const out { dst.data() };
+    parallel_for(
+      mask.size(),
+      [&](const std::size_t begin, const std::size_t end) {
+        if (inner == 1)  // a blend, which vectorizes
+          for (auto i { begin }; i < end; ++i) out[i] = m[i] ? value : out[i];
+        else
+          for (auto i { begin }; i < end; ++i)
+            if (m[i]) std::fill_n(out + i * inner, inner, value);
+      },
+      std::max<std::size_t>(1, (1UL << 15) / std::max<std::size_t>(inner, 1)));
+  }
+
+  inline array<type::int64> flatnonzero(const array<type::bool8> &mask)
+  {
+    DEVI_PROFILE_SCOPE("core::flatnonzero");
+    const mask_parts parts { mask };
+    array<type::int64> ret { shape(parts.count()) };
+    const auto *const m { mask.data() };
+    auto *const out { ret.data() };
+    parts.for_each([&](const std::size_t begin, const std::size_t end,
+                     const std::size_t offset, const std::size_t count) {
+      // without data-dependent branches, like `compact`
+      std::size_t k { 0 };
+      for (auto i { begin }; i < end; ++i) {
+        if (k < count) out[offset + k] = std::int64_t(i);
+        k += m[i];
+      }
+    });
+    return ret;
+  }
+
+}  // namespace devi::core::internal
+
+#endif
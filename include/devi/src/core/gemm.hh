@@ -0,0 +1,312 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_GEMM_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_GEMM_HH_
+
+#include "__header_check__"
+#include "profile.hh"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace devi::core::internal
+{
+  /* Computes `C = A * B` (or `C += A * B` if `accumulate` is set) on a single thread,
+   * where `A` is an (M x K), `B` a (K x N) and `C` an (M x N) row-major matrix, and
+   * `lda`, `ldb` and `ldc` are the distances (in elements) between consecutive rows of
+   * each matrix
+   *
+   * Elements of `A` and `B` are converted to float32 while being packed into cache-sized
+   * blocks, and all the products are accumulated in float32
+   */
+  template<typename _TypeA, typename _TypeB>
+  void gemm(const std::size_t M, const std::size_t N, const std::size_t K,
+    const _TypeA *const A, const std::size_t lda, const _TypeB *const B,
+    const std::size_t ldb, float *const C, const std::size_t ldc,
+    const bool accumulate = false);
+
+  /* Computes `C = (A - a_zero) * (B - b_zero)` on a single thread, for (M x K) and
+   * (K x N) row-major integer matrices `A` and `B` of atmost 16 bits, with all the
+   * products accumulated exactly in int32
+   *
+   * Elements are offset by their zero points and widened to int16 while being packed,
+   * after which pairs of products along `K` are computed with a single multiply-add
+   * (`vpdpwssd` with AVX512-VNNI, `vpmaddwd` with AVX2, and portable code otherwise)
+   *
+   * Precondition: every `A - a_zero` and `B - b_zero` must fit in int16
+   */
+  template<typename _TypeA, typename _TypeB>
+  void gemm(const std::size_t M, const std::size_t N, const std::size_t K,
+    const _TypeA *const A, const std::size_t lda, const std::int32_t a_zero,
+    const _TypeB *const B, const std::size_t ldb, const std::int32_t b_zero,
+    std::int32_t *const C, const std::size_t ldc);
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    // Register block (micro-tile) and cache block dimensions
+    constexpr std::size_t GEMM_MR { 4 }, GEMM_NR { 16 };
+    constexpr std::size_t GEMM_MC { 128 }, GEMM_KC { 256 }, GEMM_NC { 2048 };
+
+    // Packs an (mc x kc) block of `A` into zero-padded panels of `GEMM_MR` rows
+    template<typename _Type>
+    void pack_a(const _Type *const A, const std::size_t lda, const std::size_t mc,
+      const std::size_t kc, float *dst) noexcept
+    {
+      for (std::size_t i { 0 }; i < mc; i += GEMM_MR, dst += GEMM_MR * kc) {
+        const auto mr { std::min(GEMM_MR, mc - i) };
+        for (std::size_t k { 0 }; k < kc; ++k)
+          for (std::size_t r { 0 }; r < GEMM_MR; ++r)
+            dst[k * GEMM_MR + r]
+              = r < mr ? static_cast<float>(A[(i + r) * lda + k]) : 0.0F;
+      }
+    }
+
+    // Packs a (kc x nc) block of `B` into zero-padded panels of `GEMM_NR` columns
+    template<typename _Type>
+    void pack_b(const _Type *const B, const std::size_t ldb, const std::size_t kc,
+      const std::size_t nc, float *dst) noexcept
+    {
+      for (std::size_t j { 0 }; j < nc; j += GEMM_NR, dst += GEMM_NR * kc) {
+        const auto nr { std::min(GEMM_NR, nc - j) };
+        for (std::size_t k { 0 }; k < kc; ++k) {
+          const _Type *const row { B + k * ldb + j };
+          float *const out { dst + k * GEMM_NR };
+          if (nr == GEMM_NR)
+            for (std::size_t c { 0 }; c < GEMM_NR; ++c)
+              out[c] = static_cast<float>(row[c]);
+          else
+            for (std::size_t c { 0 }; c < GEMM_NR; ++c)
+              out[c] = c < nr ? static_cast<float>(row[c]) : 0.0F;
+        }
+      }
+    }
+
+    // Multiplies a packed A panel with a packed B panel into an (mr x nr) tile of `C`
+    inline void micro_kernel(const std::size_t kc, const float *const a,
+      const float *const b, float *const C, const std::size_t ldc, const std::size_t mr,
+      const std::size_t nr, const bool accumulate) noexcept
+    {
+      // the accumulator tile is small enough to stay in vector registers
+      float c[GEMM_MR][GEMM_NR] {};
+      for (std::size_t k { 0 }; k < kc; ++k) {
+        const float *const ak { a + k * GEMM_MR }, *const bk { b + k * GEMM_NR };
+        for (std::size_t j { 0 }; j < GEMM_NR; ++j)
+          for (std::size_t r { 0 }; r < GEMM_MR; ++r) c[r][j] += ak[r] * bk[j];
+      }
+
+      for (std::size_t r { 0 }; r < mr; ++r)
+        for (std::size_t j { 0 }; j < nr; ++j)
+          C[r * ldc + j] = accumulate ? C[r * ldc + j] + c[r][j] : c[r][j];
+    }
+
+    // Register block and cache block dimensions of the integer kernel (`K` is in pairs)
+    constexpr std::size_t IGEMM_MR { 4 }, IGEMM_NR { 16 };
+    constexpr std::size_t IGEMM_MC { 128 }, IGEMM_KC { 256 }, IGEMM_NC { 2048 };
+
+    /* Packs an (mc x kc) block of `A - zero` into zero-padded panels of `IGEMM_MR` rows,
+     * where every row of a panel holds consecutive pairs of int16 along `K`
+     */
+    template<typename _Type>
+    void pack_a(const _Type *const A, const std::size_t lda, const std::int32_t zero,
+      const std::size_t mc, const std::size_t kc, std::int16_t *dst) noexcept
+    {
+      const std::size_t pairs { (kc + 1) / 2 };
+      for (std::size_t i { 0 }; i < mc; i += IGEMM_MR, dst += 2 * IGEMM_MR * pairs)
+        for (std::size_t r { 0 }; r < IGEMM_MR; ++r) {
+          std::int16_t *const out { dst + 2 * r };
+          if (i + r >= mc) {
+            for (std::size_t k { 0 }; k < pairs; ++k) out[k * 2 * IGEMM_MR] = 0;
+            for (std::size_t k { 0 }; k < pairs; ++k) out[k * 2 * IGEMM_MR + 1] = 0;
+            continue;
+          }
+          const _Type *const row { A + (i + r) * lda };
+          for (std::size_t k { 0 }; k < kc; ++k)
+            out[k / 2 * 2 * IGEMM_MR + k % 2] = std::int16_t(std::int32_t(row[k]) - zero);
+          if (kc % 2) out[kc / 2 * 2 * IGEMM_MR + 1] = 0;
+        }
+    }
+
+    /* Packs a (kc x nc) block of `B - zero` into zero-padded panels of `IGEMM_NR`
+     * columns, where every column of a panel holds consecutive pairs of int16 along `K`
+     */
+    template<typename _Type>
+    void pack_b(const _Type *const B, const std::size_t ldb, const std::int32_t zero,
+      const std::size_t kc, const std::size_t nc, std::int16_t *dst) noexcept
+    {
+      const std::size_t pairs { (kc + 1) / 2 };
+      for (std::size_t j { 0 }; j < nc; j += IGEMM_NR, dst += 2 * IGEMM_NR * pairs) {
+        const auto nr { std::min(IGEMM_NR, nc - j) };
+        for (std::size_t k { 0 }; k < pairs; ++k) {
+          // rows past the end of the block are read as zero points
+          const _Type *const r0 { B + 2 * k * ldb + j };
+          const _Type *const r1 { 2 * k + 1 < kc ? r0 + ldb : nullptr };
+          std::int16_t *const out { dst + 2 * k * IGEMM_NR };
+          if (nr == IGEMM_NR && r1)
+            for (std::size_t c { 0 }; c < IGEMM_NR; ++c) {
+              out[2 * c]     = std::int16_t(std::int32_t(r0[c]) - zero);
+              out[2 * c + 1] = std::int16_t(std::int32_t(r1[c]) - zero);
+            }
+          else
+            for (std::size_t c { 0 }; c < IGEMM_NR; ++c) {
+              out[2 * c]     = c < nr ? std::int16_t(std::int32_t(r0[c]) - zero) : 0;
+              out[2 * c + 1]
+                = c < nr && r1 ? std::int16_t(std::int32_t(r1[c]) - zero) : 0;
+            }
+        }
+      }
+    }
+
+    // Multiplies a packed integer A panel with a packed B panel into an (mr x nr) tile
+    inline void micro_kernel(const std::size_t pairs, const std::int16_t *const a,
+      const std::int16_t *const b, std::int32_t *const C, const std::size_t ldc,
+      const std::size_t mr, const std::size_t nr, const bool accumulate) noexcept
+    {
+      std::int32_t c[IGEMM_MR][IGEMM_NR] {};
+#if defined(__AVX2__)
+      __m256i acc[IGEMM_MR][2] {};
+      for (std::size_t k { 0 }; k < pairs; ++k) {
+        const std::int16_t *const bk { b + 2 * k * IGEMM_NR };
+        const auto b0 { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bk)) };
+        const auto b1 { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bk + 16)) };
+        for (std::size_t r { 0 }; r < IGEMM_MR; ++r) {
+          std::int32_t pair;
+          std::memcpy(&pair, a + 2 * (k * IGEMM_MR + r), sizeof pair);
+          const auto ar { _mm256_set1_epi32(pair) };
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+          acc[r][0] = _mm256_dpwssd_epi32(acc[r][0], ar, b0);
+          acc[r][1] = _mm256_dpwssd_epi32(acc[r][1], ar, b1);
+#else
+          acc[r][0] = _mm256_add_epi32(acc[r][0], _mm256_madd_epi16(ar, b0));
+          acc[r][1] = _mm256_add_epi32(acc[r][1], _mm256_madd_epi16(ar, b1));
+#endif
+        }
+      }
+      for (std::size_t r { 0 }; r < IGEMM_MR; ++r) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(c[r]), acc[r][0]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(c[r] + 8), acc[r][1]);
+      }
+#else
+      for (std::size_t k { 0 }; k < pairs; ++k) {
+        const std::int16_t *const ak { a + 2 * k * IGEMM_MR };
+        const std::int16_t *const bk { b + 2 * k * IGEMM_NR };
+        for (std::size_t j { 0 }; j < IGEMM_NR; ++j)
+          for (std::size_t r { 0 }; r < IGEMM_MR; ++r)
+            c[r][j] += std::int32_t(ak[2 * r]) * bk[2 * j]
+                     + std::int32_t(ak[2 * r + 1]) * bk[2 * j + 1];
+      }
+#endif
+
+      for (std::size_t r { 0 }; r < mr; ++r)
+        for (std::size_t j { 0 }; j < nr; ++j)
+          C[r * ldc + j] = accumulate ? C[r * ldc + j] + c[r][j] : c[r][j];
+    }
+  }
+
+  template<typename _TypeA, typename _TypeB>
+  void gemm(const std::size_t M, const std::size_t N, const std::size_t K,
+    const _TypeA *const A, const std::size_t lda, const _TypeB *const B,
+    const std::size_t ldb, float *const C, const std::size_t ldc, const bool accumulate)
+  {
+    DEVI_PROFILE_SCOPE("core::gemm");
+    if (K == 0) {
+      if (!accumulate)
+        for (std::size_t i { 0 }; i < M; ++i) std::fill_n(C + i * ldc, N, 0.0F);
+      return;
+    }
+
+    // packing buffers are reused across calls on the same thread
+    thread_local std::vector<float> packed_a, packed_b;
+    packed_a.resize(GEMM_MC * GEMM_KC);
+    packed_b.resize(GEMM_KC * (GEMM_NC + GEMM_NR));
+
+    for (std::size_t jc { 0 }; jc < N; jc += GEMM_NC) {
+      const auto nc { std::min(GEMM_NC, N - jc) };
+      for (std::size_t pc { 0 }; pc < K; pc += GEMM_KC) {
+        const auto kc { std::min(GEMM_KC, K - pc) };
+        const bool acc { accumulate || pc > 0 };
+        pack_b(B + pc * ldb + jc, ldb, kc, nc, packed_b.data());
+
+        for (std::size_t ic { 0 }; ic < M; ic += GEMM_MC) {
+          const auto mc { std::min(GEMM_MC, M - ic) };
+          pack_a(A + ic * lda + pc, lda, mc, kc, packed_a.data());
+
+          for (std::size_t jr { 0 }; jr < nc; jr += GEMM_NR)
+            for (std::size_t ir { 0 }; ir < mc; ir += GEMM_MR)
+              micro_kernel(kc, packed_a.data() + ir * kc, packed_b.data() + jr * kc,
+                C + (ic + ir) * ldc + jc + jr, ldc, std::min(GEMM_MR, mc - ir),
+                std::min(GEMM_NR, nc - jr), acc);
+        }
+      }
+    }
+  }
+
+  template<typename _TypeA, typename _TypeB>
+  void gemm(const std::size_t M, const std::size_t N, const std::size_t K,
+    const _TypeA *const A, const std::size_t lda, const std::int32_t a_zero,
+    const _TypeB *const B, const std::size_t ldb, const std::int32_t b_zero,
+    std::int32_t *const C, const std::size_t ldc)
+  {
+    DEVI_PROFILE_SCOPE("core::gemm (int)");
+    if (K == 0) {
+      for (std::size_t i { 0 }; i < M; ++i) std::fill_n(C + i * ldc, N, 0);
+      return;
+    }
+
+    // packing buffers are reused across calls on the same thread
+    constexpr std::size_t KC { 2 * IGEMM_KC };
+    thread_local std::vector<std::int16_t> packed_a, packed_b;
+    packed_a.resize(IGEMM_MC * KC);
+    packed_b.resize(KC * (IGEMM_NC + IGEMM_NR));
+
+    for (std::size_t jc { 0 }; jc < N; jc += IGEMM_NC) {
+      const auto nc { std::min(IGEMM_NC, N - jc) };
+      for (std::size_t pc { 0 }; pc < K; pc += KC) {
+        const auto kc { std::min(KC, K - pc) }, pairs { (kc + 1) / 2 };
+        pack_b(B + pc * ldb + jc, ldb, b_zero, kc, nc, packed_b.data());
+
+        for (std::size_t ic { 0 }; ic < M; ic += IGEMM_MC) {
+          const auto mc { std::min(IGEMM_MC, M - ic) };
+          pack_a(A + ic * lda + pc, lda, a_zero, mc, kc, packed_a.data());
+
+          for (std::size_t jr { 0 }; jr < nc; jr += IGEMM_NR)
+            for (std::size_t ir { 0 }; ir < mc; ir += IGEMM_MR)
+              micro_kernel(pairs, packed_a.data() + 2 * ir * pairs,
+                packed_b.data() + 2 * jr * pairs, C + (ic + ir) * ldc + jc + jr, ldc,
+                std::min(IGEMM_MR, mc - ir), std::min(IGEMM_NR, nc - jr), pc > 0);
+        }
+      }
+    }
+  }
+
+}  // namespace devi::core::internal
+
+#endif
@@ -0,0 +1,469 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_GRAPH_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_GRAPH_HH_
+
+#include "__header_check__"
+#include "array.hh"
+#include "elementwise.hh"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace devi::core::internal
+{
+  class graph;
+
+  // Handle to the (deferred) array computed by a node of a `graph`
+  template<type _DType>
+  class lazy {
+  public:
+    // Returns the graph which the node belongs to
+    [[nodiscard]] graph &owner() const noexcept;
+
+    // Returns the index of the node in its graph, in recording order
+    [[nodiscard]] std::size_t node() const noexcept;
+
+  private:
+    lazy(graph *const owner, const std::size_t node) noexcept;
+
+    graph *p_graph;
+    std::size_t m_node;
+
+    friend class graph;
+
+  };  // class lazy
+
+  /* Deferred execution of array operations, which are recorded as the nodes of a task
+   * graph and run later (as many times as needed, e.g. once every frame)
+   *
+   * Independent nodes run concurrently on the threads of `thread_pool`, each with its own
+   * kernels running serially, while a node which has to run alone (like every node of a
+   * chain) runs with its kernels parallel instead. Every intermediate array is released
+   * right after its last consumer runs, and nodes can allocate their results from the
+   * pool of the graph, so that the released buffers are recycled by the nodes after them.
+   */
+  class graph {
+  public:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    // Constructs an empty graph
+    graph() = default;
+
+    graph(const graph &)            = delete;
+    graph &operator=(const graph &) = delete;
+
+    ////////////////////////////// GENERAL ///////////////////////////////
+
+    /* Records a node reading `source` (without copying it) every time the graph runs, so
+     * that `source` must outlive every run, and can be updated between runs
+     *
+     * Errors:
+     * `new` can throw an `std::bad_alloc` exception
+     */
+    template<type _DType>
+    [[nodiscard]] lazy<_DType> input(const array<_DType> &source);
+
+    /* Records a node computing `op(pool(), inputs...)`, or `op(inputs...)` if `op` does
+     * not accept the pool, with the arrays computed by the nodes of `inputs`
+     *
+     * `op` must be copyable and return an `array`, which becomes the result of the node.
+     * Results allocated from the pool (with `array(shape, pool)`) reuse the buffers of
+     * the intermediate arrays released before them.
+     *
+     * Errors:
+     * 1) `std::invalid_argument` if a handle of `inputs` belongs to another graph
+     * 2) `new` can throw an `std::bad_alloc` exception
+     */
+    template<typename _Op, type... _In>
+    [[nodiscard]] auto call(_Op &&op, const lazy<_In> &...inputs);
+
+    /* Keeps the result of `value` after it is last used, like the results of the nodes
+     * which nothing consumes (the outputs of the graph)
+     *
+     * Errors:
+     * `std::invalid_argument` if `value` belongs to another graph
+     */
+    template<type _DType>
+    void keep(const lazy<_DType> &value);
+
+    /* Runs every node of the graph, replacing the results of the previous run
+     *
+     * Errors:
+     * the first exception thrown by any node is rethrown (after the nodes running
+     * concurrently with it return)
+     */
+    void run();
+
+    /* Returns the array computed by `value` in the last run
+     *
+     * Errors:
+     * `std::invalid_argument` if `value` belongs to another graph, or if its result is
+     * not available (the graph has not run yet, or it was released after its last use)
+     */
+    template<type _DType>
+    [[nodiscard]] const array<_DType> &result(const lazy<_DType> &value) const;
+
+    // Returns the number of nodes of the graph
+    [[nodiscard]] std::size_t size() const noexcept;
+
+    // Returns the largest number of bytes of results alive at once during the last run
+    [[nodiscard]] std::size_t peak_bytes() const noexcept;
+
+    // Returns the pool which the nodes allocate their results from
+    [[nodiscard]] buffer_pool &pool() noexcept;
+
+  private:
+    // Operation, edges and result of a node
+    struct node {
+      std::function<void(node &)> m_compute;  // sets `m_value` and `m_bytes`
+      std::vector<std::size_t> m_inputs, m_consumers;
+      std::shared_ptr<void> m_value;
+      std::size_t m_bytes;
+      bool m_keep, m_borrowed;
+    };
+
+    // Appends a node, and returns its index
+    std::size_t record(std::vector<std::size_t> &&inputs,
+      std::function<void(node &)> &&compute, const bool borrowed);
+
+    template<type _DType>
+    void throw_if_foreign(const lazy<_DType> &value) const;
+
+    // Returns the result of node `i`, which has datatype `_DType`
+    template<type _DType>
+    [[nodiscard]] const array<_DType> &value(const std::size_t i) const noexcept;
+
+    // Accounts for the result of node `i`, releases its dead inputs and schedules its
+    // consumers (with `m_mutex` held, if other threads are running nodes)
+    void complete(const std::size_t i);
+
+    // Runs ready nodes on a thread of the pool, until atmost one of them is left
+    void work();
+
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    std::vector<node> m_nodes;
+    buffer_pool m_pool;
+
+    // state of the current run
+    std::vector<std::size_t> m_pending, m_uses, m_ready;  // `m_ready` is a stack
+    std::size_t m_running { 0 }, m_done { 0 }, m_live { 0 }, m_peak { 0 };
+    std::exception_ptr m_error;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+
+  };  // class graph
+
+  /* Records the element-wise addition, subtraction, multiplication and division of the
+   * results of `a` and `b` (see `operator+` of `array`), allocated from the pool
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `a` and `b` belong to different graphs (and, when the
+   *    graph runs, if their shapes are not equal)
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _A, type _B>
+  [[nodiscard]] lazy<result_type<_A, _B>> operator+(const lazy<_A> &a, const lazy<_B> &b);
+  template<type _A, type _B>
+  [[nodiscard]] lazy<result_type<_A, _B>> operator-(const lazy<_A> &a, const lazy<_B> &b);
+  template<type _A, type _B>
+  [[nodiscard]] lazy<result_type<_A, _B>> operator*(const lazy<_A> &a, const lazy<_B> &b);
+  template<type _A, type _B>
+  [[nodiscard]] lazy<result_type<_A, _B>> operator/(const lazy<_A> &a, const lazy<_B> &b);
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    // Datatype of an `array` type
+    template<typename _Array>
+    struct array_dtype;
+    template<type _DType>
+    struct array_dtype<array<_DType>> {
+      static constexpr type value { _DType };
+    };
+
+    // Calls `op` with `pool` if it accepts the pool, and without it otherwise
+    template<typename _Op, type... _In>
+    auto invoke_node(_Op &op, buffer_pool &pool, const array<_In> &...inputs)
+    {
+      if constexpr (std::is_invocable_v<_Op &, buffer_pool &, const array<_In> &...>)
+        return op(pool, inputs...);
+      else
+        return op(inputs...);
+    }
+
+    // Records the element-wise operation `op` of the results of `a` and `b`
+    template<type _A, type _B, typename _Op>
+    lazy<result_type<_A, _B>> lazy_binary_op(const lazy<_A> &a, const lazy<_B> &b, _Op op)
+    {
+      if (&a.owner() != &b.owner())
+        throw std::invalid_argument { "Graph: operands belong to different graphs" };
+
+      return a.owner().call(
+        [op](buffer_pool &pool, const array<_A> &x, const array<_B> &y) {
+          constexpr auto R { result_type<_A, _B> };
+          using compute = compute_type<typename native_type<R>::type>;
+
+          DEVI_PROFILE_SCOPE("core::elementwise");
+          throw_if_shapes_differ(x, y);
+          array<R> ret { x.shape(), pool };
+          elementwise<compute>(x.data(), y.data(), ret.data(), x.size(), op);
+          return ret;
+        },
+        a, b);
+    }
+  }
+
+  //////////////////////////////// LAZY ////////////////////////////////
+
+  template<type _DType>
+  lazy<_DType>::lazy(graph *const owner, const std::size_t node) noexcept
+    : p_graph { owner }, m_node { node }
+  {
+  }
+
+  template<type _DType>
+  graph &lazy<_DType>::owner() const noexcept
+  {
+    return *p_graph;
+  }
+
+  template<type _DType>
+  std::size_t lazy<_DType>::node() const noexcept
+  {
+    return m_node;
+  }
+
+  /////////////////////////////// GRAPH ////////////////////////////////
+
+  template<type _DType>
+  lazy<_DType> graph::input(const array<_DType> &source)
+  {
+    auto *const data { const_cast<array<_DType> *>(&source) };
+    return { this, record({}, [data](node &self) {
+                // aliases `source`, which is never owned (nor counted) by the graph
+                self.m_value = std::shared_ptr<void> { std::shared_ptr<void> {}, data };
+                self.m_bytes = 0;
+              }, true) };
+  }
+
+  template<typename _Op, type... _In>
+  auto graph::call(_Op &&op, const lazy<_In> &...inputs)
+  {
+    using result = decltype(
+      invoke_node(op, m_pool, std::declval<const array<_In> &>()...));
+    constexpr type R { array_dtype<result>::value };
+    (throw_if_foreign(inputs), ...);
+
+    auto compute { [this, op { std::forward<_Op>(op) },
+                     ids { std::make_tuple(inputs.m_node...) }](node &self) mutable {
+      auto ret { std::make_shared<result>(std::apply(
+        [&](const auto... id) {
+          return invoke_node(op, m_pool, this->template value<_In>(id)...);
+        },
+        ids)) };
+      self.m_bytes = ret->size() * sizeof(typename native_type<R>::type);
+      self.m_value = std::move(ret);
+    } };
+    return lazy<R> { this, record({ inputs.m_node... }, std::move(compute), false) };
+  }
+
+  template<type _DType>
+  void graph::keep(const lazy<_DType> &value)
+  {
+    throw_if_foreign(value);
+    m_nodes[value.m_node].m_keep = true;
+  }
+
+  inline void graph::run()
+  {
+    DEVI_PROFILE_SCOPE("core::graph");
+    const auto n { m_nodes.size() };
+    m_pending.assign(n, 0);
+    m_uses.assign(n, 0);
+    m_ready.clear();
+    m_running = m_done = m_live = m_peak = 0;
+    m_error   = nullptr;
+    for (std::size_t i { 0 }; i < n; ++i) {
+      m_nodes[i].m_value.reset();
+      m_pending[i] = m_nodes[i].m_inputs.size();
+      m_uses[i]    = m_nodes[i].m_consumers.size();
+    }
+
+    // sources are popped in recording order, after the inputs (which cost nothing)
+    for (auto i { n }; i-- > 0;)
+      if (m_pending[i] == 0 && !m_nodes[i].m_borrowed) m_ready.push_back(i);
+    for (std::size_t i { 0 }; i < n; ++i)
+      if (m_nodes[i].m_borrowed) {
+        m_nodes[i].m_compute(m_nodes[i]);
+        complete(i);
+      }
+
+    auto &threads { thread_pool::instance() };
+    while (m_done < n) {
+      // a node which is ready alone runs right away, with its kernels parallel
+      if (m_ready.size() == 1 || threads.concurrency() == 1) {
+        const auto i { m_ready.back() };
+        m_ready.pop_back();
+        m_nodes[i].m_compute(m_nodes[i]);
+        complete(i);
+        continue;
+      }
+
+      threads.run(threads.concurrency(), [this](unsigned) { work(); });
+      if (m_error) std::rethrow_exception(std::exchange(m_error, nullptr));
+    }
+  }
+
+  template<type _DType>
+  const array<_DType> &graph::result(const lazy<_DType> &value) const
+  {
+    throw_if_foreign(value);
+    if (!m_nodes[value.m_node].m_value)
+      throw std::invalid_argument { "Graph: result is not available" };
+    return this->value<_DType>(value.m_node);
+  }
+
+  inline std::size_t graph::size() const noexcept
+  {
+    return m_nodes.size();
+  }
+
+  inline std::size_t graph::peak_bytes() const noexcept
+  {
+    return m_peak;
+  }
+
+  inline buffer_pool &graph::pool() noexcept
+  {
+    return m_pool;
+  }
+
+  inline std::size_t graph::record(std::vector<std::size_t> &&inputs,
+    std::function<void(node &)> &&compute, const bool borrowed)
+  {
+    const auto id { m_nodes.size() };
+    m_nodes.push_back({ std::move(compute), std::move(inputs), {}, nullptr, 0, false,
+      borrowed });
+    for (const auto i : m_nodes.back().m_inputs) m_nodes[i].m_consumers.push_back(id);
+    return id;
+  }
+
+  template<type _DType>
+  void graph::throw_if_foreign(const lazy<_DType> &value) const
+  {
+    if (value.p_graph != this)
+      throw std::invalid_argument { "Graph: node belongs to another graph" };
+  }
+
+  template<type _DType>
+  const array<_DType> &graph::value(const std::size_t i) const noexcept
+  {
+    return *static_cast<const array<_DType> *>(m_nodes[i].m_value.get());
+  }
+
+  inline void graph::complete(const std::size_t i)
+  {
+    auto &done { m_nodes[i] };
+    m_live += done.m_bytes;
+    m_peak = std::max(m_peak, m_live);
+    ++m_done;
+
+    for (const auto j : done.m_inputs) {
+      auto &input { m_nodes[j] };
+      if (--m_uses[j] || input.m_keep) continue;
+      input.m_value.reset();
+      m_live -= input.m_bytes;
+    }
+    for (const auto j : done.m_consumers)
+      if (--m_pending[j] == 0) m_ready.push_back(j);
+  }
+
+  inline void graph::work()
+  {
+    std::unique_lock lock { m_mutex };
+    while (true) {
+      m_wake.wait(lock, [this] { return !m_ready.empty() || m_running == 0 || m_error; });
+      // a node left ready alone is run by `run`, with its kernels parallel
+      if (m_error || (m_running == 0 && m_ready.size() <= 1)) return;
+
+      const auto i { m_ready.back() };
+      m_ready.pop_back();
+      ++m_running;
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        m_nodes[i].m_compute(m_nodes[i]);
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+
+      --m_running;
+      if (error) {
+        if (!m_error) m_error = error;
+      }
+      else
+        complete(i);
+      m_wake.notify_all();
+    }
+  }
+
+  template<type _A, type _B>
+  lazy<result_type<_A, _B>> operator+(const lazy<_A> &a, const lazy<_B> &b)
+  {
+    return lazy_binary_op(a, b, std::plus<> {});
+  }
+
+  template<type _A, type _B>
+  lazy<result_type<_A, _B>> operator-(const lazy<_A> &a, const lazy<_B> &b)
+  {
+    return lazy_binary_op(a, b, std::minus<> {});
+  }
+
+  template<type _A, type _B>
+  lazy<result_type<_A, _B>> operator*(const lazy<_A> &a, const lazy<_B> &b)
+  {
+    return lazy_binary_op(a, b, std::multiplies<> {});
+  }
+
+  template<type _A, type _B>
+  lazy<result_type<_A, _B>> operator/(const lazy<_A> &a, const lazy<_B> &b)
+  {
+    return lazy_binary_op(a, b, std::divides<> {});
+  }
+
+}  // namespace devi::core::internal
+
+#endif
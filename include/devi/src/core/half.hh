@@ -0,0 +1,218 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_HALF_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_HALF_HH_
+
+#include "__header_check__"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace devi::core::internal
+{
+  /* IEEE 754 half precision (binary16) floating point number, stored as its bit pattern
+   *
+   * Values convert implicitly to and from float32 (rounding to the nearest even), and all
+   * arithmetic is carried out in float32
+   */
+  struct float16_t {
+    std::uint16_t m_bits;
+
+    // Zero-initialization constructor
+    constexpr float16_t() noexcept;
+    // Converts an arithmetic `value` to the nearest representable half
+    template<typename _Type, typename = std::enable_if_t<std::is_arithmetic_v<_Type>>>
+    float16_t(const _Type value) noexcept;
+
+    // Converts to float32 (exactly)
+    operator float() const noexcept;
+  };
+
+  /* Brain floating point number (the upper half of a float32), stored as its bit pattern
+   *
+   * Values convert implicitly to and from float32 (rounding to the nearest even), and all
+   * arithmetic is carried out in float32
+   */
+  struct bfloat16_t {
+    std::uint16_t m_bits;
+
+    // Zero-initialization constructor
+    constexpr bfloat16_t() noexcept;
+    // Converts an arithmetic `value` to the nearest representable bfloat16
+    template<typename _Type, typename = std::enable_if_t<std::is_arithmetic_v<_Type>>>
+    bfloat16_t(const _Type value) noexcept;
+
+    // Converts to float32 (exactly)
+    operator float() const noexcept;
+  };
+
+  // Returns true if `_Type` is one of the 16-bit floating point storage types
+  template<typename _Type>
+  inline constexpr bool is_half_v {
+    std::is_same_v<_Type, float16_t> || std::is_same_v<_Type, bfloat16_t>
+  };
+
+  /* Converts `n` elements from `src` into `dst`, going through float32 if either of the
+   * datatypes is a 16-bit floating point type
+   *
+   * Conversions between float32 and the 16-bit types are vectorized (using F16C for
+   * float16 where available)
+   */
+  template<typename _From, typename _To>
+  void convert(const _From *const src, _To *const dst, const std::size_t n) noexcept;
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <cstring>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    inline std::uint32_t bits_of(const float value) noexcept
+    {
+      std::uint32_t bits;
+      std::memcpy(&bits, &value, sizeof bits);
+      return bits;
+    }
+
+    inline float float_of(const std::uint32_t bits) noexcept
+    {
+      float value;
+      std::memcpy(&value, &bits, sizeof value);
+      return value;
+    }
+
+    /* Rounds a float32 to the nearest binary16, handling overflow to infinity, NaNs
+     * (which stay quiet NaNs) and subnormals (which the FPU rounds using a magic addend)
+     */
+    inline std::uint16_t half_from_float(const float value) noexcept
+    {
+      constexpr std::uint32_t infinity { 255U << 23 }, overflow { (127U + 16) << 23 };
+      constexpr std::uint32_t normal { 113U << 23 }, magic { 126U << 23 };
+
+      std::uint32_t f { bits_of(value) };
+      const std::uint32_t sign { f & 0x80000000U };
+      f ^= sign;
+
+      std::uint32_t h;
+      if (f >= overflow)
+        h = f > infinity ? 0x7E00U : 0x7C00U;
+      else if (f < normal)
+        h = bits_of(float_of(f) + float_of(magic)) - magic;
+      else {
+        const std::uint32_t odd { (f >> 13) & 1U };
+        h = (f + (std::uint32_t(15 - 127) << 23) + 0xFFFU + odd) >> 13;
+      }
+      return std::uint16_t(h | (sign >> 16));
+    }
+
+    // Widens a binary16 to float32, renormalizing subnormals with a magic subtraction
+    inline float half_to_float(const std::uint16_t h) noexcept
+    {
+      constexpr std::uint32_t exponent { 0x7C00U << 13 };
+      std::uint32_t f { std::uint32_t(h & 0x7FFFU) << 13 };
+      const std::uint32_t e { f & exponent };
+      f += std::uint32_t(127 - 15) << 23;
+
+      if (e == exponent)  // infinity or NaN
+        f += std::uint32_t(128 - 16) << 23;
+      else if (e == 0)  // zero or subnormal
+        f = bits_of(float_of(f + (1U << 23)) - float_of(113U << 23));
+      return float_of(f | (std::uint32_t(h & 0x8000U) << 16));
+    }
+
+    // Rounds a float32 to the nearest bfloat16, keeping NaNs quiet
+    inline std::uint16_t bfloat_from_float(const float value) noexcept
+    {
+      const std::uint32_t f { bits_of(value) };
+      if ((f & 0x7FFFFFFFU) > 0x7F800000U) return std::uint16_t((f >> 16) | 0x40U);
+      return std::uint16_t((f + 0x7FFFU + ((f >> 16) & 1U)) >> 16);
+    }
+
+    inline float bfloat_to_float(const std::uint16_t b) noexcept
+    {
+      return float_of(std::uint32_t(b) << 16);
+    }
+  }
+
+  //////////////////////////////////// FLOAT16 ////////////////////////////////////
+
+  constexpr float16_t::float16_t() noexcept : m_bits { 0 } { }
+
+  template<typename _Type, typename>
+  float16_t::float16_t(const _Type value) noexcept
+    : m_bits { half_from_float(static_cast<float>(value)) }
+  { }
+
+  inline float16_t::operator float() const noexcept { return half_to_float(m_bits); }
+
+  //////////////////////////////////// BFLOAT16 ////////////////////////////////////
+
+  constexpr bfloat16_t::bfloat16_t() noexcept : m_bits { 0 } { }
+
+  template<typename _Type, typename>
+  bfloat16_t::bfloat16_t(const _Type value) noexcept
+    : m_bits { bfloat_from_float(static_cast<float>(value)) }
+  { }
+
+  inline bfloat16_t::operator float() const noexcept { return bfloat_to_float(m_bits); }
+
+  ////////////////////////////////// CONVERSIONS //////////////////////////////////
+
+  template<typename _From, typename _To>
+  void convert(const _From *const src, _To *const dst, const std::size_t n) noexcept
+  {
+    std::size_t i { 0 };
+
+    if constexpr (std::is_same_v<_From, float> && std::is_same_v<_To, float16_t>) {
+#if defined(__F16C__)
+      for (; i + 8 <= n; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+          _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+      for (; i < n; ++i) dst[i].m_bits = half_from_float(src[i]);
+    }
+    else if constexpr (std::is_same_v<_From, float16_t> && std::is_same_v<_To, float>) {
+#if defined(__F16C__)
+      for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(dst + i,
+          _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i))));
+#endif
+      for (; i < n; ++i) dst[i] = half_to_float(src[i].m_bits);
+    }
+    else if constexpr (std::is_same_v<_From, float> && std::is_same_v<_To, bfloat16_t>)
+      for (; i < n; ++i) dst[i].m_bits = bfloat_from_float(src[i]);
+    else if constexpr (std::is_same_v<_From, bfloat16_t> && std::is_same_v<_To, float>)
+      for (; i < n; ++i) dst[i] = bfloat_to_float(src[i].m_bits);
+    else if constexpr (is_half_v<_From> || is_half_v<_To>)
+      for (; i < n; ++i) dst[i] = static_cast<_To>(static_cast<float>(src[i]));
+    else
+      for (; i < n; ++i) dst[i] = static_cast<_To>(src[i]);
+  }
+
+}  // namespace devi::core::internal
+
+#endif
@@ -0,0 +1,450 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_JOIN_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_JOIN_HH_
+
+#include "__header_check__"
+#include "array.hh"
+#include "compare.hh"
+
+#include <vector>
+
+namespace devi::core::internal
+{
+  // Enables an overload for a list of `array`s or `view`s
+  template<typename _Tensor>
+  using enable_if_tensor = std::enable_if_t<is_tensor_v<_Tensor>>;
+
+  /* Returns the elements of all the `inputs` joined (in order) along the existing
+   * dimension `axis`
+   *
+   * The result is allocated once, and the inputs are copied into it in parallel, with
+   * the elements which are contiguous in both an input and the result copied by `memcpy`
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `inputs` is empty, if `axis` is out of bounds of their
+   *    shapes, or if their shapes differ in any dimension other than `axis`
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<typename _Tensor, typename = enable_if_tensor<_Tensor>>
+  [[nodiscard]] array<tensor_type<_Tensor>::value> concatenate(
+    const std::vector<_Tensor> &inputs, const unsigned axis = 0);
+
+  /* Writes the elements of all the `inputs` joined along `axis` into `out` (as described
+   * by `concatenate` above), without allocating
+   *
+   * Errors:
+   * 1) `std::invalid_argument` for the `inputs` and `axis` described above, or if the
+   *    shape of `out` is not the shape of the result
+   */
+  template<typename _Tensor, typename = enable_if_tensor<_Tensor>>
+  void concatenate(const std::vector<_Tensor> &inputs, const unsigned axis,
+    array<tensor_type<_Tensor>::value> &out);
+
+  /* Returns the elements of all the `inputs` joined (in order) along a new dimension
+   * inserted before `axis` (e.g. a batch of frames for `axis = 0`), with the same copy
+   * strategy as `concatenate`
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `inputs` is empty, if their shapes are not equal, if
+   *    `axis` is greater than their dimensionality, or if the result would have more
+   *    than 10 dimensions
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<typename _Tensor, typename = enable_if_tensor<_Tensor>>
+  [[nodiscard]] array<tensor_type<_Tensor>::value> stack(
+    const std::vector<_Tensor> &inputs, const unsigned axis = 0);
+
+  /* Writes the elements of all the `inputs` joined along a new dimension inserted before
+   * `axis` into `out` (as described by `stack` above), without allocating
+   *
+   * Errors:
+   * 1) `std::invalid_argument` for the `inputs` and `axis` described above, or if the
+   *    shape of `out` is not the shape of the result
+   */
+  template<typename _Tensor, typename = enable_if_tensor<_Tensor>>
+  void stack(const std::vector<_Tensor> &inputs, const unsigned axis,
+    array<tensor_type<_Tensor>::value> &out);
+
+  /* Returns `sections` views of equal length along `axis` which together cover `src`
+   * (no elements are copied, so writes to the views modify `src`)
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `axis` is out of bounds of the shape of `src`, or if
+   *    the length of the axis is not divisible by `sections`
+   */
+  template<type _DType>
+  [[nodiscard]] std::vector<view<_DType>> split(array<_DType> &src,
+    const std::size_t sections, const unsigned axis = 0);
+  template<type _DType>
+  [[nodiscard]] std::vector<view<_DType>> split(view<_DType> &src,
+    const std::size_t sections, const unsigned axis = 0);
+
+  /* Returns the views of `src` between consecutive `indices` along `axis`, i.e. the
+   * views [0, indices[0]), [indices[0], indices[1]), ... [indices[n - 1], length)
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `axis` is out of bounds of the shape of `src`, or if
+   *    `indices` are not strictly increasing in (0, length of the axis)
+   */
+  template<type _DType>
+  [[nodiscard]] std::vector<view<_DType>> split(array<_DType> &src,
+    const std::vector<std::size_t> &indices, const unsigned axis = 0);
+  template<type _DType>
+  [[nodiscard]] std::vector<view<_DType>> split(view<_DType> &src,
+    const std::vector<std::size_t> &indices, const unsigned axis = 0);
+
+  /* Returns `sections` views along `axis` which together cover `src` (like `split`),
+   * where the length of the axis does not need to be divisible by `sections` and the
+   * first `length % sections` views are one longer than the rest
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `axis` is out of bounds of the shape of `src`, or if
+   *    `sections` is not in [1, length of the axis]
+   */
+  template<type _DType>
+  [[nodiscard]] std::vector<view<_DType>> array_split(array<_DType> &src,
+    const std::size_t sections, const unsigned axis = 0);
+  template<type _DType>
+  [[nodiscard]] std::vector<view<_DType>> array_split(view<_DType> &src,
+    const std::size_t sections, const unsigned axis = 0);
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    /* Copies of the elements of several strided layouts into other strided layouts,
+     * where piece `p` copies the layout `src_stride` of `shape` starting at `src[p]` into
+     * the layout `dst_stride` starting at `dst[p]`
+     */
+    template<typename _Native>
+    class join_pieces {
+    public:
+      // Reserves space for `n` pieces
+      explicit join_pieces(const std::size_t n)
+      {
+        m_src.reserve(n), m_dst.reserve(n), m_runs.reserve(n), m_first.reserve(n + 1);
+        m_first.push_back(0);
+      }
+
+      // Adds a piece
+      void add(const _Native *const src, const shape &shape, const slice_data &src_stride,
+        _Native *const dst, const slice_data &dst_stride)
+      {
+        m_src.push_back(src), m_dst.push_back(dst);
+        m_runs.emplace_back(shape, src_stride, dst_stride);
+        m_first.push_back(m_first.back() + shape.size());
+      }
+
+      /* Copies all the pieces, splitting their total number of elements evenly between
+       * threads (so many small pieces and a few large ones are both spread out)
+       */
+      void copy() const
+      {
+        parallel_for(
+          m_first.back(),
+          [this](const std::size_t begin, const std::size_t end) {
+            const auto after { std::upper_bound(m_first.begin(), m_first.end(), begin) };
+            auto p { std::size_t(after - m_first.begin()) - 1 };
+            for (; p < m_runs.size() && m_first[p] < end; ++p) {
+              const auto first { m_first[p] };
+              this->copy(p, std::max(begin, first) - first,
+                std::min(end, m_first[p + 1]) - first);
+            }
+          },
+          1UL << 15);
+      }
+
+    private:
+      // Copies the elements in [begin, end) of row-major order of piece `p`
+      void copy(const std::size_t p, const std::size_t begin, const std::size_t end) const
+      {
+        const auto &runs { m_runs[p] };
+        const auto step_a { runs.step_a() }, step_b { runs.step_b() };
+        const auto *const src { m_src[p] };
+        auto *const dst { m_dst[p] };
+        runs.for_each(begin, end,
+          [&](std::size_t, const std::size_t a, const std::size_t b,
+            const std::size_t n) {
+            if (step_a == 1 && step_b == 1)
+              std::memcpy(dst + b, src + a, n * sizeof(_Native));
+            else
+              for (std::size_t i { 0 }; i < n; ++i)
+                dst[b + i * step_b] = src[a + i * step_a];
+          });
+      }
+
+      std::vector<const _Native *> m_src;
+      std::vector<_Native *> m_dst;
+      std::vector<paired_runs> m_runs;
+      std::vector<std::size_t> m_first;  // position of every piece in all the elements
+    };
+
+    // Throws if `inputs` is empty, or if their shapes differ in a dimension but `skip`
+    template<typename _Tensor>
+    void throw_if_not_joinable(const std::vector<_Tensor> &inputs, const unsigned skip,
+      const char *const error)
+    {
+      if (inputs.empty()) throw std::invalid_argument { error };
+
+      const auto &first { inputs.front().shape() };
+      for (const auto &input : inputs) {
+        const auto &s { input.shape() };
+        if (s.ndims() != first.ndims()) throw std::invalid_argument { error };
+        for (unsigned d { 0 }; d < s.ndims(); ++d)
+          if (d != skip && s[d] != first[d]) throw std::invalid_argument { error };
+      }
+    }
+
+    // Returns the shape of concatenating `inputs` along `axis`
+    template<typename _Tensor>
+    shape concatenated_shape(const std::vector<_Tensor> &inputs, const unsigned axis)
+    {
+      throw_if_not_joinable(inputs, axis,
+        "Concatenate: inputs must be non-empty, with equal shapes except along the axis");
+      if (axis >= inputs.front().ndims())
+        throw std::invalid_argument { "Concatenate: axis is out of bounds of the shape" };
+
+      auto ret { inputs.front().shape() };
+      ret[axis] = 0;
+      for (const auto &input : inputs) ret[axis] += input.shape()[axis];
+      return ret;
+    }
+
+    // Returns the shape of stacking `inputs` along a new dimension before `axis`
+    template<typename _Tensor>
+    shape stacked_shape(const std::vector<_Tensor> &inputs, const unsigned axis)
+    {
+      throw_if_not_joinable(
+        inputs, -1U, "Stack: inputs must be non-empty, with equal shapes");
+      const auto &s { inputs.front().shape() };
+      if (axis > s.ndims())
+        throw std::invalid_argument { "Stack: axis is out of bounds of the shape" };
+      if (s.ndims() == 10)
+        throw std::invalid_argument { "Stack: result must have atmost 10 dimensions" };
+
+      std::size_t dims[10];
+      for (unsigned d { 0 }; d < s.ndims(); ++d) dims[d < axis ? d : d + 1] = s[d];
+      dims[axis] = inputs.size();
+      return shape::from_dims(dims, s.ndims() + 1);
+    }
+
+    template<typename _Tensor, type _DType>
+    void concatenate_into(
+      const std::vector<_Tensor> &inputs, const unsigned axis, array<_DType> &out)
+    {
+      DEVI_PROFILE_SCOPE("core::concatenate");
+      const auto stride { slice_data::get_stride(out.shape()) };
+      join_pieces<typename native_type<_DType>::type> pieces { inputs.size() };
+      std::size_t offset { 0 };
+      for (const auto &input : inputs) {
+        pieces.add(
+          input.data(), input.shape(), input.stride(), out.data() + offset, stride);
+        offset += input.shape()[axis] * stride[axis];
+      }
+      pieces.copy();
+    }
+
+    template<typename _Tensor, type _DType>
+    void stack_into(
+      const std::vector<_Tensor> &inputs, const unsigned axis, array<_DType> &out)
+    {
+      DEVI_PROFILE_SCOPE("core::stack");
+      const auto out_stride { slice_data::get_stride(out.shape()) };
+      // strides of the result for every dimension of an input (i.e. all but `axis`)
+      auto stride { slice_data::get_stride(inputs.front().shape()) };
+      for (unsigned d { 0 }; d < stride.ndims(); ++d)
+        stride[d] = out_stride[d < axis ? d : d + 1];
+
+      join_pieces<typename native_type<_DType>::type> pieces { inputs.size() };
+      for (std::size_t i { 0 }; i < inputs.size(); ++i)
+        pieces.add(inputs[i].data(), inputs[i].shape(), inputs[i].stride(),
+          out.data() + i * out_stride[axis], stride);
+      pieces.copy();
+    }
+
+    /* Returns the views of `src` along `axis` between consecutive boundaries, where
+     * `bounds` starts with 0 and ends with the length of the axis
+     */
+    template<typename _Tensor>
+    auto split_at(
+      _Tensor &src, const std::vector<std::size_t> &bounds, const unsigned axis)
+    {
+      const auto stride { slice_data(src.stride()) };
+      std::vector<view<tensor_type<_Tensor>::value>> ret;
+      ret.reserve(bounds.size() - 1);
+      auto s { src.shape() };
+      for (std::size_t i { 0 }; i + 1 < bounds.size(); ++i) {
+        s[axis] = bounds[i + 1] - bounds[i];
+        ret.push_back(view_access::window(src, s, bounds[i] * stride[axis], stride));
+      }
+      return ret;
+    }
+
+    template<typename _Tensor>
+    void throw_if_split_axis_out_of_bounds(const _Tensor &src, const unsigned axis)
+    {
+      if (axis >= src.ndims())
+        throw std::invalid_argument { "Split: axis is out of bounds of the shape" };
+    }
+
+    // Returns the boundaries of `sections` (almost) equal views of an axis
+    inline std::vector<std::size_t> even_bounds(
+      const std::size_t length, const std::size_t sections)
+    {
+      if (sections == 0 || sections > length)
+        throw std::invalid_argument {
+          "Split: number of sections must be in [1, length of the axis]"
+        };
+
+      std::vector<std::size_t> ret(sections + 1);
+      const auto quotient { length / sections }, remainder { length % sections };
+      for (std::size_t i { 0 }; i < sections; ++i)
+        ret[i + 1] = ret[i] + quotient + (i < remainder);
+      return ret;
+    }
+
+    template<typename _Tensor>
+    auto split_evenly(_Tensor &src, const std::size_t sections, const unsigned axis)
+    {
+      throw_if_split_axis_out_of_bounds(src, axis);
+      const auto length { src.shape()[axis] };
+      if (sections != 0 && length % sections != 0)
+        throw std::invalid_argument {
+          "Split: length of the axis must be divisible by the number of sections"
+        };
+      return split_at(src, even_bounds(length, sections), axis);
+    }
+
+    template<typename _Tensor>
+    auto split_indices(
+      _Tensor &src, const std::vector<std::size_t> &indices, const unsigned axis)
+    {
+      throw_if_split_axis_out_of_bounds(src, axis);
+      std::vector<std::size_t> bounds { 0 };
+      bounds.insert(bounds.end(), indices.begin(), indices.end());
+      bounds.push_back(src.shape()[axis]);
+      for (std::size_t i { 0 }; i + 1 < bounds.size(); ++i)
+        if (bounds[i] >= bounds[i + 1])
+          throw std::invalid_argument {
+            "Split: indices must be strictly increasing inside the axis"
+          };
+      return split_at(src, bounds, axis);
+    }
+
+    template<typename _Tensor>
+    auto split_unevenly(_Tensor &src, const std::size_t sections, const unsigned axis)
+    {
+      throw_if_split_axis_out_of_bounds(src, axis);
+      return split_at(src, even_bounds(src.shape()[axis], sections), axis);
+    }
+  }
+
+  template<typename _Tensor, typename>
+  array<tensor_type<_Tensor>::value> concatenate(
+    const std::vector<_Tensor> &inputs, const unsigned axis)
+  {
+    array<tensor_type<_Tensor>::value> ret { concatenated_shape(inputs, axis) };
+    concatenate_into(inputs, axis, ret);
+    return ret;
+  }
+
+  template<typename _Tensor, typename>
+  void concatenate(const std::vector<_Tensor> &inputs, const unsigned axis,
+    array<tensor_type<_Tensor>::value> &out)
+  {
+    if (out.shape() != concatenated_shape(inputs, axis))
+      throw std::invalid_argument {
+        "Concatenate: shape of the output must be the shape of the result"
+      };
+    concatenate_into(inputs, axis, out);
+  }
+
+  template<typename _Tensor, typename>
+  array<tensor_type<_Tensor>::value> stack(
+    const std::vector<_Tensor> &inputs, const unsigned axis)
+  {
+    array<tensor_type<_Tensor>::value> ret { stacked_shape(inputs, axis) };
+    stack_into(inputs, axis, ret);
+    return ret;
+  }
+
+  template<typename _Tensor, typename>
+  void stack(const std::vector<_Tensor> &inputs, const unsigned axis,
+    array<tensor_type<_Tensor>::value> &out)
+  {
+    if (out.shape() != stacked_shape(inputs, axis))
+      throw std::invalid_argument {
+        "Stack: shape of the output must be the shape of the result"
+      };
+    stack_into(inputs, axis, out);
+  }
+
+  template<type _DType>
+  std::vector<view<_DType>> split(
+    array<_DType> &src, const std::size_t sections, const unsigned axis)
+  {
+    return split_evenly(src, sections, axis);
+  }
+
+  template<type _DType>
+  std::vector<view<_DType>> split(
+    view<_DType> &src, const std::size_t sections, const unsigned axis)
+  {
+    return split_evenly(src, sections, axis);
+  }
+
+  template<type _DType>
+  std::vector<view<_DType>> split(
+    array<_DType> &src, const std::vector<std::size_t> &indices, const unsigned axis)
+  {
+    return split_indices(src, indices, axis);
+  }
+
+  template<type _DType>
+  std::vector<view<_DType>> split(
+    view<_DType> &src, const std::vector<std::size_t> &indices, const unsigned axis)
+  {
+    return split_indices(src, indices, axis);
+  }
+
+  template<type _DType>
+  std::vector<view<_DType>> array_split(
+    array<_DType> &src, const std::size_t sections, const unsigned axis)
+  {
+    return split_unevenly(src, sections, axis);
+  }
+
+  template<type _DType>
+  std::vector<view<_DType>> array_split(
+    view<_DType> &src, const std::size_t sections, const unsigned axis)
+  {
+    return split_unevenly(src, sections, axis);
+  }
+
+}  // namespace devi::core::internal
+
+#endif
@@ -0,0 +1,544 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_MEMORY_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_MEMORY_HH_
+
+#include "__header_check__"
+#include "parallel.hh"
+
+#include <cstdint>
+#include <memory>
+
+namespace devi::core::internal
+{
+  namespace numa
+  {
+    /* Placement of the pages of newly allocated arrays across the NUMA nodes
+     * local      -> every page is first touched (and hence placed) by the thread which
+     *               owns it in the static partitioning of `parallel_for`, so that kernels
+     *               partitioned the same way only read memory local to their node
+     * interleave -> pages are spread round-robin over all the nodes, for arrays which are
+     *               read by all the threads in no fixed pattern (like GEMM weights)
+     */
+    enum class policy : std::uint8_t { local, interleave };
+
+    /* Returns the placement policy of newly allocated arrays, initially read from the
+     * `DEVI_NUMA_POLICY` environment variable ("interleave", or "local" by default)
+     */
+    [[nodiscard]] policy placement() noexcept;
+
+    // Sets the placement policy of all the arrays allocated afterwards (by any thread)
+    void set_placement(const policy p) noexcept;
+
+    // Returns the number of online NUMA nodes (1 on systems without NUMA support)
+    [[nodiscard]] unsigned node_count();
+
+    /* Returns the node holding the page which contains `address`, or -1 if the page has
+     * not been touched yet or the node cannot be queried
+     */
+    [[nodiscard]] int node_of(const void *const address) noexcept;
+
+    /* Spreads the whole pages within [address, address + bytes) round-robin over all the
+     * online nodes, migrating the pages which are already in memory
+     *
+     * Returns false if the pages could not be interleaved (e.g. without NUMA support in
+     * the kernel), in which case they are left where they are
+     */
+    bool interleave(void *const address, const std::size_t bytes) noexcept;
+
+  }  // namespace numa
+
+  // Counters of a `buffer_pool`, where idle buffers are the ones cached for reuse
+  struct pool_statistics {
+    std::size_t m_requests;     // buffers requested from the pool
+    std::size_t m_hits;         // requests served by an idle buffer
+    std::size_t m_allocations;  // requests served by a new system allocation
+    std::size_t m_releases;     // buffers given back to the system (over a limit, trim)
+    std::size_t m_idle_buffers, m_idle_bytes;
+  };
+
+  struct pool_buffers;  // shared state of a `buffer_pool` and of all the arrays using it
+
+  template<typename _Type>
+  struct storage_deleter;
+
+  /* Recycling pool of array storage for loops which create arrays of the same shapes
+   * over and over (e.g. the intermediate results of every frame), so that their steady
+   * state makes no system allocation at all
+   *
+   * The storage of an `array` constructed with a pool is taken from the pool, and handed
+   * back to it when the array is destroyed instead of being deleted. Idle buffers are
+   * keyed by their size (in bytes) and alignment, and every thread caches a few of them
+   * for itself so that a buffer freed and requested again by the same thread never takes
+   * a lock. Buffers which would take the idle memory over a high-water mark are given
+   * back to the system instead.
+   *
+   * Arrays and thread caches share the ownership of the idle buffers, so both can
+   * outlive the pool object itself.
+   */
+  class buffer_pool {
+  public:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    /* Constructs an empty pool keeping atmost `max_idle_bytes` bytes in atmost
+     * `max_idle_buffers` idle buffers (unlimited by default)
+     *
+     * Errors:
+     * `new` can throw an `std::bad_alloc` exception
+     */
+    explicit buffer_pool(const std::size_t max_idle_bytes = SIZE_MAX,
+      const std::size_t max_idle_buffers = SIZE_MAX);
+
+    ////////////////////////////// GENERAL ///////////////////////////////
+
+    // Returns a snapshot of the counters of the pool
+    [[nodiscard]] pool_statistics statistics() const noexcept;
+
+    // Changes the high-water marks of the idle buffers (already idle buffers are kept)
+    void set_limits(const std::size_t max_idle_bytes,
+      const std::size_t max_idle_buffers = SIZE_MAX) noexcept;
+
+    /* Gives all the idle buffers back to the system, except the ones cached by threads
+     * other than the calling thread (which are given back when those threads exit)
+     */
+    void trim() noexcept;
+
+  private:
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    std::shared_ptr<pool_buffers> p_buffers;
+
+    ////////////////////////////// FRIENDS ///////////////////////////////
+
+    template<typename _Type>
+    friend std::unique_ptr<_Type[], storage_deleter<_Type>> allocate(
+      const std::size_t n, buffer_pool &pool);
+
+  };  // class buffer_pool
+
+  // Releases the memory returned by `allocate`, into its pool if it came from one
+  template<typename _Type>
+  struct storage_deleter {
+    std::shared_ptr<pool_buffers> p_pool;
+    std::size_t m_bytes;
+
+    void operator()(_Type *const p) const noexcept;
+  };
+
+  // Owning pointer to the elements of an `array`
+  template<typename _Type>
+  using storage = std::unique_ptr<_Type[], storage_deleter<_Type>>;
+
+  /* Returns storage for `n` elements placed according to `numa::placement()`, whose
+   * elements are copies of the `n` elements at `source` (or zero if it is null)
+   *
+   * Elements are initialized in parallel with the static partitioning of `parallel_for`,
+   * so that the first touch of every page comes from the thread which later processes
+   * it, instead of all pages being touched (and placed) by the allocating thread
+   *
+   * Errors:
+   * `new` can throw an `std::bad_alloc` exception
+   */
+  template<typename _Type>
+  [[nodiscard]] storage<_Type> allocate(
+    const std::size_t n, const _Type *const source = nullptr);
+
+  /* Returns zero-initialized storage for `n` elements taken from `pool`, to which it is
+   * handed back when released (a recycled buffer keeps the placement of its pages)
+   *
+   * Errors:
+   * `new` can throw an `std::bad_alloc` exception
+   */
+  template<typename _Type>
+  [[nodiscard]] storage<_Type> allocate(const std::size_t n, buffer_pool &pool);
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    // `mbind` and `move_pages` constants (from <linux/mempolicy.h>, which may be missing)
+    constexpr int NUMA_MPOL_INTERLEAVE { 3 };
+    constexpr unsigned NUMA_MPOL_MF_MOVE { 1U << 1 };
+
+    // elements initialized by a thread at a time, the grain of the element-wise kernels
+    constexpr std::size_t first_touch_grain { 1UL << 15 };
+
+    // alignment of all the storage, one cache line
+    constexpr std::align_val_t storage_alignment { 64 };
+
+    // Bitmask of the online nodes, parsed from a list like "0-1,3"
+    inline const std::vector<unsigned long> &online_nodes()
+    {
+      static const std::vector<unsigned long> mask { [] {
+        std::vector<unsigned long> ret;
+        std::string list;
+        std::ifstream { "/sys/devices/system/node/online" } >> list;
+        for (std::size_t i { 0 }; i < list.size();) {
+          const auto first { std::strtoul(list.c_str() + i, nullptr, 10) };
+          auto last { first };
+          i = list.find_first_of("-,", i);
+          if (i != std::string::npos && list[i] == '-') {
+            last = std::strtoul(list.c_str() + i + 1, nullptr, 10);
+            i    = list.find(',', i);
+          }
+          for (auto node { first }; node <= last && node < 4096; ++node) {
+            ret.resize(std::max<std::size_t>(ret.size(), node / 64 + 1));
+            ret[node / 64] |= 1UL << node % 64;
+          }
+          if (i != std::string::npos) ++i;
+        }
+        if (ret.empty()) ret.push_back(1);  // a single node without NUMA support
+        return ret;
+      }() };
+      return mask;
+    }
+
+    inline std::atomic<numa::policy> &placement_policy() noexcept
+    {
+      static std::atomic<numa::policy> policy { [] {
+        const char *env { std::getenv("DEVI_NUMA_POLICY") };
+        return env && std::strcmp(env, "interleave") == 0 ? numa::policy::interleave
+                                                          : numa::policy::local;
+      }() };
+      return policy;
+    }
+  }
+
+  namespace numa
+  {
+    inline policy placement() noexcept
+    {
+      return placement_policy().load(std::memory_order_relaxed);
+    }
+
+    inline void set_placement(const policy p) noexcept
+    {
+      placement_policy().store(p, std::memory_order_relaxed);
+    }
+
+    inline unsigned node_count()
+    {
+      unsigned ret { 0 };
+      for (const auto word : online_nodes()) ret += unsigned(__builtin_popcountl(word));
+      return ret;
+    }
+
+    inline int node_of(const void *const address) noexcept
+    {
+#if defined(__linux__)
+      const auto page { std::uintptr_t(::sysconf(_SC_PAGESIZE)) };
+      void *pages[] { reinterpret_cast<void *>(std::uintptr_t(address) / page * page) };
+      int status[] { -1 };
+      if (::syscall(SYS_move_pages, 0, 1, pages, nullptr, status, 0) != 0) return -1;
+      return status[0] >= 0 ? status[0] : -1;
+#else
+      (void)address;
+      return -1;
+#endif
+    }
+
+    inline bool interleave(void *const address, const std::size_t bytes) noexcept
+    {
+#if defined(__linux__)
+      // only the whole pages inside the range are moved, never memory around it
+      const auto page { std::uintptr_t(::sysconf(_SC_PAGESIZE)) };
+      const auto begin { (std::uintptr_t(address) + page - 1) / page * page };
+      const auto end { (std::uintptr_t(address) + bytes) / page * page };
+      if (begin >= end) return false;
+
+      try {
+        const auto &mask { online_nodes() };
+        return ::syscall(SYS_mbind, begin, end - begin, NUMA_MPOL_INTERLEAVE, mask.data(),
+                 mask.size() * 64 + 1, NUMA_MPOL_MF_MOVE)
+            == 0;
+      } catch (...) {
+        return false;
+      }
+#else
+      (void)address, (void)bytes;
+      return false;
+#endif
+    }
+
+  }  // namespace numa
+
+  ///////////////////////////////// BUFFER POOL /////////////////////////////////
+
+  // Idle buffers and counters of a `buffer_pool`
+  struct pool_buffers {
+    std::mutex m_mutex;  // guards `m_idle`
+    std::map<std::pair<std::size_t, std::size_t>, std::vector<void *>> m_idle;
+    std::atomic<std::size_t> m_max_bytes, m_max_buffers;
+    std::atomic<std::size_t> m_requests { 0 }, m_hits { 0 }, m_allocations { 0 },
+      m_releases { 0 }, m_idle_buffers { 0 }, m_idle_bytes { 0 };
+
+    pool_buffers(const std::size_t max_bytes, const std::size_t max_buffers) noexcept;
+    ~pool_buffers() noexcept;
+
+    // Returns an idle buffer of `bytes` bytes and `alignment`, or a new one
+    [[nodiscard]] void *acquire(const std::size_t bytes, const std::size_t alignment);
+    // Makes the buffer `p` idle (where `self` owns this state), or frees it over a limit
+    void release(const std::shared_ptr<pool_buffers> &self, void *const p,
+      const std::size_t bytes, const std::size_t alignment) noexcept;
+    // Moves the idle buffer `p` into the buffers shared by all the threads
+    void share(
+      void *const p, const std::size_t bytes, const std::size_t alignment) noexcept;
+    // Gives the buffer `p` back to the system
+    void free(void *const p, const std::size_t alignment) noexcept;
+  };
+
+  namespace  // for internal linkage
+  {
+    // Idle buffers cached by a thread, which are shared again when the thread exits
+    struct pool_cache {
+      struct entry {
+        std::shared_ptr<pool_buffers> p_pool;
+        void *p_buffer;
+        std::size_t m_bytes, m_alignment;
+      };
+      entry m_entries[8] {};
+
+      ~pool_cache() noexcept
+      {
+        for (auto &e : m_entries)
+          if (e.p_buffer) e.p_pool->share(e.p_buffer, e.m_bytes, e.m_alignment);
+      }
+    };
+
+    inline pool_cache &thread_cache() noexcept
+    {
+      static thread_local pool_cache cache;
+      return cache;
+    }
+  }
+
+  inline pool_buffers::pool_buffers(
+    const std::size_t max_bytes, const std::size_t max_buffers) noexcept
+    : m_max_bytes { max_bytes }, m_max_buffers { max_buffers }
+  { }
+
+  inline pool_buffers::~pool_buffers() noexcept
+  {
+    for (auto &[key, buffers] : m_idle)
+      for (auto *const p : buffers) ::operator delete(p, std::align_val_t { key.second });
+  }
+
+  inline void *pool_buffers::acquire(const std::size_t bytes, const std::size_t alignment)
+  {
+    ++m_requests;
+    const auto reuse { [&](void *const p) {
+      ++m_hits;
+      --m_idle_buffers;
+      m_idle_bytes -= bytes;
+      return p;
+    } };
+
+    // the buffers cached by the calling thread are checked first, without any lock
+    for (auto &e : thread_cache().m_entries)
+      if (e.p_buffer && e.p_pool.get() == this && e.m_bytes == bytes
+          && e.m_alignment == alignment) {
+        void *const p { e.p_buffer };
+        e.p_buffer = nullptr;
+        e.p_pool.reset();
+        return reuse(p);
+      }
+
+    {
+      const std::lock_guard lock { m_mutex };
+      const auto it { m_idle.find({ bytes, alignment }) };
+      if (it != m_idle.end() && !it->second.empty()) {
+        void *const p { it->second.back() };
+        it->second.pop_back();
+        return reuse(p);
+      }
+    }
+
+    ++m_allocations;
+    return ::operator new(bytes, std::align_val_t { alignment });
+  }
+
+  inline void pool_buffers::release(const std::shared_ptr<pool_buffers> &self,
+    void *const p, const std::size_t bytes, const std::size_t alignment) noexcept
+  {
+    // the room for the buffer is reserved under both limits before it is kept, so that
+    // concurrent releases cannot all see the same room and together exceed them
+    const auto reserve { [](std::atomic<std::size_t> &idle, const std::size_t n,
+                           const std::size_t limit) {
+      auto seen { idle.load() };
+      do
+        if (seen + n > limit) return false;
+      while (!idle.compare_exchange_weak(seen, seen + n));
+      return true;
+    } };
+    if (!reserve(m_idle_bytes, bytes, m_max_bytes)) return this->free(p, alignment);
+    if (!reserve(m_idle_buffers, 1, m_max_buffers)) {
+      m_idle_bytes -= bytes;
+      return this->free(p, alignment);
+    }
+
+    for (auto &e : thread_cache().m_entries)
+      if (!e.p_buffer) {
+        e = { self, p, bytes, alignment };
+        return;
+      }
+    this->share(p, bytes, alignment);
+  }
+
+  inline void pool_buffers::share(
+    void *const p, const std::size_t bytes, const std::size_t alignment) noexcept
+  {
+    try {
+      const std::lock_guard lock { m_mutex };
+      m_idle[{ bytes, alignment }].push_back(p);
+    } catch (...) {  // no memory left for the list, so the buffer is not kept
+      --m_idle_buffers;
+      m_idle_bytes -= bytes;
+      this->free(p, alignment);
+    }
+  }
+
+  inline void pool_buffers::free(void *const p, const std::size_t alignment) noexcept
+  {
+    ++m_releases;
+    ::operator delete(p, std::align_val_t { alignment });
+  }
+
+  inline buffer_pool::buffer_pool(
+    const std::size_t max_idle_bytes, const std::size_t max_idle_buffers)
+    : p_buffers { std::make_shared<pool_buffers>(max_idle_bytes, max_idle_buffers) }
+  { }
+
+  inline pool_statistics buffer_pool::statistics() const noexcept
+  {
+    const auto &b { *p_buffers };
+    return { b.m_requests, b.m_hits, b.m_allocations, b.m_releases, b.m_idle_buffers,
+      b.m_idle_bytes };
+  }
+
+  inline void buffer_pool::set_limits(
+    const std::size_t max_idle_bytes, const std::size_t max_idle_buffers) noexcept
+  {
+    p_buffers->m_max_bytes   = max_idle_bytes;
+    p_buffers->m_max_buffers = max_idle_buffers;
+  }
+
+  inline void buffer_pool::trim() noexcept
+  {
+    auto &b { *p_buffers };
+    const auto drop { [&](void *const p, const std::size_t bytes, const std::size_t a) {
+      --b.m_idle_buffers;
+      b.m_idle_bytes -= bytes;
+      b.free(p, a);
+    } };
+
+    for (auto &e : thread_cache().m_entries)
+      if (e.p_buffer && e.p_pool == p_buffers) {
+        drop(e.p_buffer, e.m_bytes, e.m_alignment);
+        e.p_buffer = nullptr;
+        e.p_pool.reset();
+      }
+
+    const std::lock_guard lock { b.m_mutex };
+    for (auto &[key, buffers] : b.m_idle) {
+      for (auto *const p : buffers) drop(p, key.first, key.second);
+      buffers.clear();
+    }
+  }
+
+  ////////////////////////////////// STORAGE //////////////////////////////////
+
+  template<typename _Type>
+  void storage_deleter<_Type>::operator()(_Type *const p) const noexcept
+  {
+    if (p_pool)
+      p_pool->release(p_pool, p, m_bytes, std::size_t(storage_alignment));
+    else
+      ::operator delete(p, storage_alignment);
+  }
+
+  template<typename _Type>
+  storage<_Type> allocate(const std::size_t n, const _Type *const source)
+  {
+    // elements are only ever overwritten, so none of them has to be destroyed
+    static_assert(std::is_trivially_destructible_v<_Type>);
+    static_assert(std::is_trivially_copyable_v<_Type>);
+
+    // untouched memory, whose pages are only placed when first written
+    storage<_Type> ret { static_cast<_Type *>(
+      ::operator new(std::max<std::size_t>(n, 1) * sizeof(_Type), storage_alignment)) };
+    if (numa::placement() == numa::policy::interleave)
+      numa::interleave(ret.get(), n * sizeof(_Type));
+
+    auto *const data { ret.get() };
+    parallel_for(
+      n,
+      [&](const std::size_t begin, const std::size_t end) {
+        if (source)
+          std::uninitialized_copy(source + begin, source + end, data + begin);
+        else
+          std::uninitialized_value_construct(data + begin, data + end);
+      },
+      first_touch_grain);
+    return ret;
+  }
+
+  template<typename _Type>
+  storage<_Type> allocate(const std::size_t n, buffer_pool &pool)
+  {
+    static_assert(std::is_trivially_destructible_v<_Type>);
+    static_assert(std::is_trivially_copyable_v<_Type>);
+
+    const auto bytes { std::max<std::size_t>(n, 1) * sizeof(_Type) };
+    storage<_Type> ret { static_cast<_Type *>(pool.p_buffers->acquire(
+                           bytes, std::size_t(storage_alignment))),
+      storage_deleter<_Type> { pool.p_buffers, bytes } };
+
+    auto *const data { ret.get() };
+    parallel_for(
+      n,
+      [&](const std::size_t begin, const std::size_t end) {
+        std::uninitialized_value_construct(data + begin, data + end);
+      },
+      first_touch_grain);
+    return ret;
+  }
+
+}  // namespace devi::core::internal
+
+#endif
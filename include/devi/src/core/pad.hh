@@ -0,0 +1,447 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_PAD_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_PAD_HH_
+
+#include "__header_check__"
+#include "array.hh"
+
+#include <cstdint>
+#include <vector>
+
+namespace devi::core::internal
+{
+  /* Values given to the positions of a padded border (for a dimension `abcd`)
+   * constant  -> vv|abcd|vv  (a fixed value)
+   * replicate -> aa|abcd|dd  (the nearest edge element)
+   * reflect   -> cb|abcd|cb  (mirrored about the edge element, which is not repeated)
+   * wrap      -> cd|abcd|ab  (periodic continuation)
+   */
+  enum class border : std::uint8_t { constant, replicate, reflect, wrap };
+
+  // Number of border positions added before and after a dimension
+  struct pad_width {
+    std::size_t m_before, m_after;
+
+    // Same width on both sides
+    pad_width(const std::size_t both);
+    // Direct value initialization constructor
+    pad_width(const std::size_t before, const std::size_t after);
+  };
+
+  /* Read-only window into the elements of an `array` or a `view` of datatype `_DType`
+   * surrounded by a virtual border, whose positions are resolved to elements of the
+   * source (or to a constant) on access instead of being stored
+   *
+   * The source occupies the interior [interior_begin(d), interior_end(d)) of every
+   * dimension, so that kernels can read the interior through `interior()` without any
+   * bounds handling and reserve the per-element resolution for the thin border around
+   * it. It does not own the elements it reads, which must outlive it.
+   */
+  template<type _DType>
+  class padded_view {
+    using native_type = typename native_type<_DType>::type;
+
+  public:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    /* Constructs a window padding every dimension `d` of `source` by `widths[d]` (or all
+     * of them by `width`) with the border `mode`, where `value` is the element of a
+     * constant border
+     *
+     * Errors:
+     * 1) `std::invalid_argument` if the number of `widths` is not equal to the
+     *    dimensionality of `source`
+     * 2) `std::invalid_argument` if a dimension of `source` is empty and is padded with a
+     *    border other than `border::constant`, which has no element to resolve to
+     * 3) `new` can throw an `std::bad_alloc` exception
+     */
+    padded_view(const view<_DType> &source, const std::vector<pad_width> &widths,
+      const border mode = border::constant, const native_type value = native_type {});
+    padded_view(const view<_DType> &source, const pad_width width,
+      const border mode = border::constant, const native_type value = native_type {});
+    padded_view(const array<_DType> &source, const std::vector<pad_width> &widths,
+      const border mode = border::constant, const native_type value = native_type {});
+    padded_view(const array<_DType> &source, const pad_width width,
+      const border mode = border::constant, const native_type value = native_type {});
+
+    ///////////////////////// OPERATOR OVERLOADS /////////////////////////
+
+    /* Multi-dimensional full indexing using integers, in the coordinates of the padded
+     * shape (the first element of the source is at `interior_begin`)
+     *
+     * Errors:
+     * 1) `std::invalid_argument` if the number of `indices` arguments is not equal to
+     *    view's dimensionality
+     * 2) `std::out_of_range` if the argument index is valid but out of bounds for atleast
+     *    one dimension in the padded shape
+     */
+    template<typename... _Indices,
+      typename = std::enable_if_t<(std::is_integral_v<_Indices> && ...)>>
+    [[nodiscard]] native_type operator()(const _Indices... indices) const;
+
+    ////////////////////////////// GETTERS ///////////////////////////////
+
+    // Returns the dimensionality of the view
+    [[nodiscard]] unsigned ndims() const noexcept;
+
+    // Returns the padded shape of the view
+    [[nodiscard]] const class shape &shape() const noexcept;
+
+    // Returns the total size of the padded view
+    [[nodiscard]] std::size_t size() const noexcept;
+
+    // Returns the `devi::core::type` of the view
+    [[nodiscard]] enum type type() const noexcept;
+
+    // Returns the border mode of the view
+    [[nodiscard]] border mode() const noexcept;
+
+    // Returns the element of a constant border
+    [[nodiscard]] native_type value() const noexcept;
+
+    // Returns the window into the unpadded elements
+    [[nodiscard]] const view<_DType> &interior() const noexcept;
+
+    // Returns the first padded coordinate of dimension `d` inside the interior
+    [[nodiscard]] std::size_t interior_begin(const unsigned d) const noexcept;
+
+    // Returns the padded coordinate of dimension `d` just after the interior
+    [[nodiscard]] std::size_t interior_end(const unsigned d) const noexcept;
+
+    ////////////////////////////// GENERAL ///////////////////////////////
+
+    /* Returns the coordinate of the source which the padded coordinate `i` of dimension
+     * `d` resolves to, or -1 if it lies in a constant border
+     *
+     * Precondition: `d` must be less than `ndims()`, and `i` less than `shape()[d]`
+     */
+    [[nodiscard]] std::ptrdiff_t resolve(
+      const unsigned d, const std::size_t i) const noexcept;
+
+    /* Returns a copy of the padded elements, in which the interior is copied row by row
+     * and only the border is resolved element by element
+     *
+     * Errors:
+     * `new` can throw an `std::bad_alloc` exception
+     */
+    [[nodiscard]] array<_DType> copy() const;
+
+  private:
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    view<_DType> m_source;
+    std::vector<pad_width> m_widths;
+    class shape m_shape;
+    border m_mode;
+    native_type m_value;
+
+  };  // class padded_view
+
+  /* Returns a copy of `source` with every dimension `d` padded by `widths[d]` (or all of
+   * them by `width`) with the border `mode`, i.e. `padded_view(...).copy()`
+   *
+   * Errors:
+   * Same as the constructor of `padded_view`
+   */
+  template<type _DType>
+  [[nodiscard]] array<_DType> pad(const view<_DType> &source,
+    const std::vector<pad_width> &widths, const border mode = border::constant,
+    const typename native_type<_DType>::type value = {});
+  template<type _DType>
+  [[nodiscard]] array<_DType> pad(const view<_DType> &source, const pad_width width,
+    const border mode = border::constant,
+    const typename native_type<_DType>::type value = {});
+  template<type _DType>
+  [[nodiscard]] array<_DType> pad(const array<_DType> &source,
+    const std::vector<pad_width> &widths, const border mode = border::constant,
+    const typename native_type<_DType>::type value = {});
+  template<type _DType>
+  [[nodiscard]] array<_DType> pad(const array<_DType> &source, const pad_width width,
+    const border mode = border::constant,
+    const typename native_type<_DType>::type value = {});
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    // Returns the source coordinate of the (possibly out of range) coordinate `c` of a
+    // dimension of length `n`, or -1 for a constant border
+    inline std::ptrdiff_t resolve_border(
+      const border mode, std::ptrdiff_t c, const std::ptrdiff_t n) noexcept
+    {
+      if (c >= 0 && c < n) return c;
+      switch (mode) {
+      case border::replicate: return c < 0 ? 0 : n - 1;
+      case border::reflect: {
+        if (n == 1) return 0;
+        const auto period { 2 * (n - 1) };
+        c = (c % period + period) % period;
+        return c < n ? c : period - c;
+      }
+      case border::wrap: return (c % n + n) % n;
+      default: return -1;
+      }
+    }
+
+    // Returns the padded shape of `s`
+    inline shape padded_shape(const shape &s, const std::vector<pad_width> &widths,
+      const border mode)
+    {
+      if (widths.size() != s.ndims())
+        throw std::invalid_argument { "Pad: number of widths must match dimensionality" };
+
+      std::size_t dims[10];
+      for (unsigned d { 0 }; d < s.ndims(); ++d) {
+        const auto [before, after] { widths[d] };
+        if (s[d] == 0 && before + after != 0 && mode != border::constant)
+          throw std::invalid_argument { "Pad: empty dimension needs a constant border" };
+        dims[d] = before + s[d] + after;
+      }
+      return shape::from_dims(dims, s.ndims());
+    }
+  }
+
+  inline pad_width::pad_width(const std::size_t both)
+    : m_before { both }, m_after { both }
+  { }
+
+  inline pad_width::pad_width(const std::size_t before, const std::size_t after)
+    : m_before { before }, m_after { after }
+  { }
+
+  //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+  template<type _DType>
+  padded_view<_DType>::padded_view(const view<_DType> &source,
+    const std::vector<pad_width> &widths, const border mode, const native_type value)
+    : m_source { source }, m_widths { widths },
+      m_shape { padded_shape(source.shape(), widths, mode) }, m_mode { mode },
+      m_value { value }
+  { }
+
+  template<type _DType>
+  padded_view<_DType>::padded_view(const view<_DType> &source, const pad_width width,
+    const border mode, const native_type value)
+    : padded_view { source, std::vector<pad_width>(source.ndims(), width), mode, value }
+  { }
+
+  // the window is read-only, so the elements are never modified through the view
+  template<type _DType>
+  padded_view<_DType>::padded_view(const array<_DType> &source,
+    const std::vector<pad_width> &widths, const border mode, const native_type value)
+    : padded_view { view_access::window(const_cast<array<_DType> &>(source),
+                      source.shape(), 0, source.stride()),
+        widths, mode, value }
+  { }
+
+  template<type _DType>
+  padded_view<_DType>::padded_view(const array<_DType> &source, const pad_width width,
+    const border mode, const native_type value)
+    : padded_view { source, std::vector<pad_width>(source.ndims(), width), mode, value }
+  { }
+
+  ///////////////////////// OPERATOR OVERLOADS /////////////////////////
+
+  template<type _DType>
+  template<typename... _Indices, typename>
+  typename padded_view<_DType>::native_type padded_view<_DType>::operator()(
+    const _Indices... indices) const
+  {
+    const index index { indices... };
+    index.throw_if_dimensionality_not_equal_to(m_shape);
+    index.throw_if_out_of_bounds_of(m_shape);
+
+    const std::size_t coordinates[] { static_cast<std::size_t>(indices)... };
+    const auto &stride { m_source.stride() };
+    std::size_t offset { 0 };
+    for (unsigned d { 0 }; d < sizeof...(indices); ++d) {
+      const auto c { this->resolve(d, coordinates[d]) };
+      if (c < 0) return m_value;
+      offset += std::size_t(c) * stride[d];
+    }
+    return m_source.data()[offset];
+  }
+
+  ////////////////////////////// GETTERS ///////////////////////////////
+
+  template<type _DType>
+  unsigned padded_view<_DType>::ndims() const noexcept
+  {
+    return m_shape.ndims();
+  }
+
+  template<type _DType>
+  const shape &padded_view<_DType>::shape() const noexcept
+  {
+    return m_shape;
+  }
+
+  template<type _DType>
+  std::size_t padded_view<_DType>::size() const noexcept
+  {
+    return m_shape.size();
+  }
+
+  template<type _DType>
+  type padded_view<_DType>::type() const noexcept
+  {
+    return _DType;
+  }
+
+  template<type _DType>
+  border padded_view<_DType>::mode() const noexcept
+  {
+    return m_mode;
+  }
+
+  template<type _DType>
+  typename padded_view<_DType>::native_type padded_view<_DType>::value() const noexcept
+  {
+    return m_value;
+  }
+
+  template<type _DType>
+  const view<_DType> &padded_view<_DType>::interior() const noexcept
+  {
+    return m_source;
+  }
+
+  template<type _DType>
+  std::size_t padded_view<_DType>::interior_begin(const unsigned d) const noexcept
+  {
+    return m_widths[d].m_before;
+  }
+
+  template<type _DType>
+  std::size_t padded_view<_DType>::interior_end(const unsigned d) const noexcept
+  {
+    return m_widths[d].m_before + m_source.shape()[d];
+  }
+
+  ////////////////////////////// GENERAL ///////////////////////////////
+
+  template<type _DType>
+  std::ptrdiff_t padded_view<_DType>::resolve(
+    const unsigned d, const std::size_t i) const noexcept
+  {
+    return resolve_border(m_mode,
+      std::ptrdiff_t(i) - std::ptrdiff_t(m_widths[d].m_before),
+      std::ptrdiff_t(m_source.shape()[d]));
+  }
+
+  template<type _DType>
+  array<_DType> padded_view<_DType>::copy() const
+  {
+    DEVI_PROFILE_SCOPE("core::padded_view::copy");
+    array<_DType> ret { m_shape };
+    if (ret.size() == 0) return ret;
+
+    // every output row is a row of the source (or constant) framed by the borders of the
+    // last dimension, whose source offsets are resolved once for all the rows
+    const auto last { m_shape.ndims() - 1 };
+    const auto &stride { m_source.stride() };
+    const auto length { m_shape[last] }, step { stride[last] };
+    const auto [before, after] { m_widths[last] };
+    const auto inner { m_source.shape()[last] };
+    std::vector<std::ptrdiff_t> frame(before + after);
+    for (std::size_t j { 0 }; j < before; ++j) frame[j] = this->resolve(last, j);
+    for (std::size_t j { 0 }; j < after; ++j)
+      frame[before + j] = this->resolve(last, before + inner + j);
+    for (auto &c : frame)
+      if (c >= 0) c *= std::ptrdiff_t(step);
+
+    const auto *const data { m_source.data() };
+    auto *const out { ret.data() };
+    parallel_for(
+      ret.size() / length,
+      [&](const std::size_t begin, const std::size_t end) {
+        for (std::size_t r { begin }; r < end; ++r) {
+          auto *const row { out + r * length };
+
+          // resolve the outer coordinates of the row, from the last to the first
+          std::size_t offset { 0 }, rest { r };
+          bool constant { false };
+          for (unsigned d { last }; d-- > 0;) {
+            const auto c { this->resolve(d, rest % m_shape[d]) };
+            rest /= m_shape[d];
+            if (c < 0) {
+              constant = true;
+              break;
+            }
+            offset += std::size_t(c) * stride[d];
+          }
+          if (constant) {
+            std::fill_n(row, length, m_value);
+            continue;
+          }
+
+          const auto *const in { data + offset };
+          for (std::size_t j { 0 }; j < before; ++j)
+            row[j] = frame[j] < 0 ? m_value : in[frame[j]];
+          if (step == 1)
+            std::memcpy(row + before, in, inner * sizeof(native_type));
+          else
+            for (std::size_t j { 0 }; j < inner; ++j) row[before + j] = in[j * step];
+          for (std::size_t j { before }; j < before + after; ++j)
+            row[inner + j] = frame[j] < 0 ? m_value : in[frame[j]];
+        }
+      },
+      std::max<std::size_t>((1UL << 15) / length, 1));
+    return ret;
+  }
+
+  template<type _DType>
+  array<_DType> pad(const view<_DType> &source, const std::vector<pad_width> &widths,
+    const border mode, const typename native_type<_DType>::type value)
+  {
+    return padded_view<_DType> { source, widths, mode, value }.copy();
+  }
+
+  template<type _DType>
+  array<_DType> pad(const view<_DType> &source, const pad_width width, const border mode,
+    const typename native_type<_DType>::type value)
+  {
+    return padded_view<_DType> { source, width, mode, value }.copy();
+  }
+
+  template<type _DType>
+  array<_DType> pad(const array<_DType> &source, const std::vector<pad_width> &widths,
+    const border mode, const typename native_type<_DType>::type value)
+  {
+    return padded_view<_DType> { source, widths, mode, value }.copy();
+  }
+
+  template<type _DType>
+  array<_DType> pad(const array<_DType> &source, const pad_width width,
+    const border mode, const typename native_type<_DType>::type value)
+  {
+    return padded_view<_DType> { source, width, mode, value }.copy();
+  }
+
+}  // namespace devi::core::internal
+
+#endif
@@ -0,0 +1,254 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_PARALLEL_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_PARALLEL_HH_
+
+#include "__header_check__"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace devi::core::internal
+{
+  // Fixed-size pool of worker threads shared by all the parallel kernels of the library
+  class thread_pool {
+  public:
+    /* Returns the process-wide thread pool
+     *
+     * The number of threads is read once from the `DEVI_NUM_THREADS` environment variable
+     * and defaults to the hardware concurrency
+     */
+    [[nodiscard]] static thread_pool &instance();
+
+    // Joins all the worker threads
+    ~thread_pool() noexcept;
+
+    thread_pool(const thread_pool &)            = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    ////////////////////////////// GENERAL ///////////////////////////////
+
+    // Returns the number of threads taking part in a parallel region (including caller)
+    [[nodiscard]] unsigned concurrency() const noexcept;
+
+    /* Calls `task(i)` for every `i` in [0, n) and blocks until all calls return
+     * Task `i` always runs on the `i`th thread of the pool, the caller being thread 0
+     *
+     * Nested calls from inside a task, and calls made while another thread is running a
+     * parallel region, execute all tasks serially on the calling thread
+     *
+     * Precondition: `n` must be atmost `concurrency()`
+     *
+     * Errors:
+     * the first exception thrown by any task is rethrown on the calling thread
+     */
+    void run(const unsigned n, const std::function<void(unsigned)> &task);
+
+  private:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    // Spawns `size - 1` worker threads
+    explicit thread_pool(const unsigned size);
+
+    // Main loop of the worker thread with the specified `id`
+    void work(const unsigned id);
+
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_region;  // held by the thread currently running a parallel region
+    std::mutex m_mutex;   // guards all the state below
+    std::condition_variable m_wake, m_done;
+    const std::function<void(unsigned)> *p_task;
+    std::exception_ptr m_error;
+    std::size_t m_generation;
+    unsigned m_tasks, m_pending;
+    bool m_stop;
+
+    static inline thread_local bool s_inside { false };  // true within pool tasks
+
+  };  // class thread_pool
+
+  /* Returns the [begin, end) range owned by part `i` when [0, n) is split into `parts`
+   * contiguous parts of (almost) equal size
+   */
+  [[nodiscard]] std::pair<std::size_t, std::size_t> partition(
+    const std::size_t n, const unsigned parts, const unsigned i) noexcept;
+
+  /* Returns the number of parts [0, n) is split into, such that every part has atleast
+   * `grain` elements and every thread of the pool gets atmost one part
+   */
+  [[nodiscard]] unsigned partition_count(const std::size_t n, const std::size_t grain);
+
+  /* Splits [0, n) into atmost `thread_pool::concurrency()` contiguous chunks of atleast
+   * `grain` elements each, and calls `body(begin, end)` for every chunk in parallel
+   *
+   * The partitioning is static, i.e. the same `n` and `grain` always map the same chunk
+   * onto the same thread of the pool
+   */
+  template<typename _Body>
+  void parallel_for(const std::size_t n, _Body &&body, const std::size_t grain = 1);
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace devi::core::internal
+{
+  //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+  inline thread_pool &thread_pool::instance()
+  {
+    static thread_pool pool { [] {
+      const char *env { std::getenv("DEVI_NUM_THREADS") };
+      const int size { env ? std::atoi(env) : 0 };
+      if (size > 0) return unsigned(size);
+      return std::max(std::thread::hardware_concurrency(), 1U);
+    }() };
+
+    return pool;
+  }
+
+  inline thread_pool::thread_pool(const unsigned size)
+    : p_task { nullptr }, m_generation { 0 }, m_tasks { 0 }, m_pending { 0 },
+      m_stop { false }
+  {
+    m_workers.reserve(size - 1);
+    for (unsigned id { 0 }; ++id < size;)
+      m_workers.emplace_back(&thread_pool::work, this, id);
+  }
+
+  inline thread_pool::~thread_pool() noexcept
+  {
+    {
+      std::lock_guard lock { m_mutex };
+      m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto &worker : m_workers) worker.join();
+  }
+
+  ////////////////////////////// GENERAL ///////////////////////////////
+
+  inline unsigned thread_pool::concurrency() const noexcept
+  {
+    return m_workers.size() + 1;
+  }
+
+  inline void thread_pool::run(
+    const unsigned n, const std::function<void(unsigned)> &task)
+  {
+    std::unique_lock region { m_region, std::defer_lock };
+    if (n < 2 || s_inside || !region.try_lock()) {
+      for (unsigned i { 0 }; i < n; ++i) task(i);
+      return;
+    }
+
+    {
+      std::lock_guard lock { m_mutex };
+      p_task    = &task;
+      m_tasks   = n;
+      m_pending = n - 1;
+      m_error   = nullptr;
+      ++m_generation;
+    }
+    m_wake.notify_all();
+
+    s_inside = true;
+    try {
+      task(0);
+    }
+    catch (...) {
+      std::lock_guard lock { m_mutex };
+      if (!m_error) m_error = std::current_exception();
+    }
+    s_inside = false;
+
+    std::unique_lock lock { m_mutex };
+    m_done.wait(lock, [this] { return m_pending == 0; });
+    p_task = nullptr;
+    if (m_error) std::rethrow_exception(std::exchange(m_error, nullptr));
+  }
+
+  inline void thread_pool::work(const unsigned id)
+  {
+    s_inside = true;
+    std::size_t seen { 0 };
+
+    std::unique_lock lock { m_mutex };
+    while (true) {
+      m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+      if (m_stop) return;
+      seen = m_generation;
+      if (id >= m_tasks) continue;
+
+      const auto &task { *p_task };
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        task(id);
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+
+      if (error && !m_error) m_error = error;
+      if (--m_pending == 0) m_done.notify_one();
+    }
+  }
+
+  inline std::pair<std::size_t, std::size_t> partition(
+    const std::size_t n, const unsigned parts, const unsigned i) noexcept
+  {
+    const std::size_t chunk { n / parts }, rem { n % parts };
+    const std::size_t begin { i * chunk + std::min<std::size_t>(i, rem) };
+    return { begin, begin + chunk + (i < rem) };
+  }
+
+  inline unsigned partition_count(const std::size_t n, const std::size_t grain)
+  {
+    return unsigned(std::min<std::size_t>(
+      thread_pool::instance().concurrency(), std::max<std::size_t>(n / grain, 1)));
+  }
+
+  template<typename _Body>
+  void parallel_for(const std::size_t n, _Body &&body, const std::size_t grain)
+  {
+    if (n == 0) return;
+
+    const auto parts { partition_count(n, grain) };
+    if (parts == 1) return (void)body(std::size_t { 0 }, n);
+
+    thread_pool::instance().run(parts, [&](const unsigned i) {
+      const auto [begin, end] { partition(n, parts, i) };
+      body(begin, end);
+    });
+  }
+
+}  // namespace devi::core::internal
+
+#endif
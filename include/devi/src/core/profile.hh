@@ -0,0 +1,263 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_PROFILE_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_PROFILE_HH_
+
+#include "__header_check__"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+/* Opt-in instrumentation of allocations and hot paths, enabled by defining `DEVI_PROFILE`
+ * before including any DeVi header (or with `-DDEVI_PROFILE`)
+ *
+ * When it is not defined, the instrumentation macros expand to nothing, so instrumented
+ * code compiles exactly as if they were not there, and the query API reports nothing
+ */
+#if defined(DEVI_PROFILE)
+// Counts an allocation of `bytes` bytes at `where` (a `profile::site` enumerator)
+#define DEVI_PROFILE_ALLOCATION(where, bytes)        \
+  ::devi::core::internal::profile::record_allocation( \
+    ::devi::core::internal::profile::site::where, bytes)
+// Times the rest of the enclosing scope as the region `name` (a string literal)
+#define DEVI_PROFILE_SCOPE(name)           DEVI_PROFILE_SCOPE_AT(name, __LINE__)
+#define DEVI_PROFILE_SCOPE_AT(name, line)  DEVI_PROFILE_SCOPE_IMPL(name, line)
+#define DEVI_PROFILE_SCOPE_IMPL(name, line)                                          \
+  static ::devi::core::internal::profile::region devi_profile_region_##line { name }; \
+  const ::devi::core::internal::profile::scoped_timer devi_profile_timer_##line {     \
+    devi_profile_region_##line                                                        \
+  }
+#else
+#define DEVI_PROFILE_ALLOCATION(where, bytes) ((void)0)
+#define DEVI_PROFILE_SCOPE(name) ((void)0)
+#endif
+
+namespace devi::core::internal::profile
+{
+  // Places in the library which allocate memory
+  enum class site {
+    array,      // storage owned by arrays
+    dimension,  // buffers of shapes, strides and indices
+    view,       // views from slicing or reshaping (and copies made by `view::reshape`)
+    workspace,  // scratch buffers of kernels
+  };
+
+  // Number of allocations and the total bytes allocated at a site
+  struct allocation_stats {
+    std::uint64_t m_count, m_bytes;
+  };
+
+  // Number of calls and the total (inclusive) time spent in a timed region
+  struct region_stats {
+    const char *m_name;
+    std::uint64_t m_calls;
+    double m_seconds;
+  };
+
+  // Returns true if the library was compiled with `DEVI_PROFILE`
+  [[nodiscard]] constexpr bool enabled() noexcept;
+
+  // Returns the allocation counters of `where` since the start of the program (or reset)
+  [[nodiscard]] allocation_stats allocations(const site where) noexcept;
+
+  /* Returns the counters of every timed region which has been entered atleast once, with
+   * regions of the same name (like the instantiations of a template) merged together
+   */
+  [[nodiscard]] std::vector<region_stats> regions();
+
+  // Sets all the counters to zero
+  void reset() noexcept;
+
+  // Writes all the counters to `out` as a human-readable table
+  void dump(std::ostream &out);
+
+  //////////////////////////////////// HOOKS ////////////////////////////////////
+  // (only used through the `DEVI_PROFILE_*` macros)
+
+  // Adds an allocation of `bytes` bytes to the counters of `where`
+  void record_allocation(const site where, const std::size_t bytes) noexcept;
+
+  // Counters of a single timed region, which registers itself on construction
+  class region {
+  public:
+    explicit region(const char *const name);
+
+    const char *const m_name;
+    std::atomic<std::uint64_t> m_calls { 0 }, m_nanoseconds { 0 };
+    region *p_next { nullptr };  // intrusive list of all the regions
+  };
+
+  // Adds the time between its construction and destruction to a region
+  class scoped_timer {
+  public:
+    explicit scoped_timer(region &region) noexcept;
+    ~scoped_timer() noexcept;
+
+    scoped_timer(const scoped_timer &)            = delete;
+    scoped_timer &operator=(const scoped_timer &) = delete;
+
+  private:
+    region &m_region;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+}  // namespace devi::core::internal::profile
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <cstdio>
+#include <mutex>
+#include <string_view>
+
+namespace devi::core::internal::profile
+{
+  inline constexpr unsigned site_count { unsigned(site::workspace) + 1 };
+
+  namespace  // for internal linkage
+  {
+    constexpr const char *site_names[site_count] { "array", "dimension", "view",
+      "workspace" };
+  }
+
+  // Process-wide state of all the counters (shared by all translation units)
+  struct state {
+    std::atomic<std::uint64_t> m_count[site_count] {}, m_bytes[site_count] {};
+    std::mutex m_mutex;  // guards the list of regions
+    region *p_regions { nullptr };
+
+    static state &instance() noexcept
+    {
+      static state s;
+      return s;
+    }
+  };
+
+  constexpr bool enabled() noexcept
+  {
+#if defined(DEVI_PROFILE)
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  inline allocation_stats allocations(const site where) noexcept
+  {
+    const auto &s { state::instance() };
+    const auto i { unsigned(where) };
+    return { s.m_count[i].load(std::memory_order_relaxed),
+      s.m_bytes[i].load(std::memory_order_relaxed) };
+  }
+
+  inline std::vector<region_stats> regions()
+  {
+    auto &s { state::instance() };
+    const std::lock_guard<std::mutex> lock { s.m_mutex };
+
+    std::vector<region_stats> ret;
+    for (const auto *r { s.p_regions }; r; r = r->p_next) {
+      const auto calls { r->m_calls.load(std::memory_order_relaxed) };
+      if (calls == 0) continue;
+      const auto ns { r->m_nanoseconds.load(std::memory_order_relaxed) };
+      const auto seconds { double(ns) * 1e-9 };
+
+      auto it { ret.begin() };
+      while (it != ret.end() && std::string_view { it->m_name } != r->m_name) ++it;
+      if (it == ret.end())
+        ret.push_back({ r->m_name, calls, seconds });
+      else {
+        it->m_calls += calls;
+        it->m_seconds += seconds;
+      }
+    }
+    return ret;
+  }
+
+  inline void reset() noexcept
+  {
+    auto &s { state::instance() };
+    for (unsigned i { 0 }; i < site_count; ++i) {
+      s.m_count[i].store(0, std::memory_order_relaxed);
+      s.m_bytes[i].store(0, std::memory_order_relaxed);
+    }
+
+    const std::lock_guard<std::mutex> lock { s.m_mutex };
+    for (auto *r { s.p_regions }; r; r = r->p_next) {
+      r->m_calls.store(0, std::memory_order_relaxed);
+      r->m_nanoseconds.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  inline void dump(std::ostream &out)
+  {
+    char line[128];
+    out << "DeVi profile" << (enabled() ? "\n" : " (disabled; define DEVI_PROFILE)\n");
+
+    std::snprintf(line, sizeof line, "  %-28s %14s %16s\n", "allocation site", "count",
+      "bytes");
+    out << line;
+    for (unsigned i { 0 }; i < site_count; ++i) {
+      const auto a { allocations(site(i)) };
+      std::snprintf(line, sizeof line, "  %-28s %14llu %16llu\n", site_names[i],
+        (unsigned long long)a.m_count, (unsigned long long)a.m_bytes);
+      out << line;
+    }
+
+    std::snprintf(line, sizeof line, "  %-28s %14s %16s\n", "region", "calls",
+      "total (ms)");
+    out << line;
+    for (const auto &r : regions()) {
+      std::snprintf(line, sizeof line, "  %-28s %14llu %16.3f\n", r.m_name,
+        (unsigned long long)r.m_calls, r.m_seconds * 1e3);
+      out << line;
+    }
+  }
+
+  inline void record_allocation(const site where, const std::size_t bytes) noexcept
+  {
+    auto &s { state::instance() };
+    s.m_count[unsigned(where)].fetch_add(1, std::memory_order_relaxed);
+    s.m_bytes[unsigned(where)].fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  inline region::region(const char *const name) : m_name { name }
+  {
+    auto &s { state::instance() };
+    const std::lock_guard<std::mutex> lock { s.m_mutex };
+    p_next      = s.p_regions;
+    s.p_regions = this;
+  }
+
+  inline scoped_timer::scoped_timer(region &region) noexcept
+    : m_region { region }, m_start { std::chrono::steady_clock::now() }
+  { }
+
+  inline scoped_timer::~scoped_timer() noexcept
+  {
+    const std::chrono::nanoseconds elapsed { std::chrono::steady_clock::now() - m_start };
+    m_region.m_calls.fetch_add(1, std::memory_order_relaxed);
+    m_region.m_nanoseconds.fetch_add(std::uint64_t(elapsed.count()),
+      std::memory_order_relaxed);
+  }
+
+}  // namespace devi::core::internal::profile
+
+#endif
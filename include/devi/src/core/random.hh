@@ -0,0 +1,383 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_RANDOM_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_RANDOM_HH_
+
+#include "__header_check__"
+#include "array.hh"
+
+#include <atomic>
+#include <cstdint>
+
+/* Random arrays from the counter-based Philox4x32-10 generator
+ *
+ * Every element is a pure function of the seed, the number of arrays generated before it
+ * from the same generator (its stream) and its own position in the array, so the results
+ * are identical for any number of threads, and arrays are filled in parallel
+ */
+namespace devi::core::internal::random
+{
+  // Seed and stream counter shared by a sequence of random arrays
+  class generator {
+  public:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    // Constructs a generator whose first array is generated from stream 0 of `seed`
+    explicit generator(const std::uint64_t seed) noexcept;
+
+    // Copy constructor, continuing from the same stream as `other`
+    generator(const generator &other) noexcept;
+
+    generator &operator=(const generator &) = delete;
+
+    ////////////////////////////// GETTERS ///////////////////////////////
+
+    // Returns the seed of the generator
+    [[nodiscard]] std::uint64_t seed() const noexcept;
+
+    // Returns the stream the next array will be generated from
+    [[nodiscard]] std::uint64_t stream() const noexcept;
+
+    ////////////////////////////// GENERAL ///////////////////////////////
+
+    // Returns the stream of the next array and moves past it (safe to call concurrently)
+    [[nodiscard]] std::uint64_t next() noexcept;
+
+  private:
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    const std::uint64_t m_seed;
+    std::atomic<std::uint64_t> m_stream;
+
+  };  // class generator
+
+  // Returns the process-wide generator used when none is specified (seeded with 0)
+  [[nodiscard]] generator &default_generator() noexcept;
+
+  /* Fills `dst` with numbers drawn uniformly from [low, high), converted to its datatype
+   * like `astype` (i.e. truncated towards zero for integers)
+   *
+   * Numbers are drawn in float64 for float64 and the 32-bit and 64-bit integers, and in
+   * float32 for every other datatype
+   *
+   * Errors:
+   * `std::invalid_argument` if `low` is not less than `high`
+   */
+  template<type _DType>
+  void uniform(array<_DType> &dst, const double low = 0.0, const double high = 1.0,
+    generator &gen = default_generator());
+
+  /* Fills `dst` with numbers drawn from a normal distribution of the specified `mean` and
+   * standard deviation `stddev` (using the Box-Muller transform), converted to its
+   * datatype like `astype`
+   *
+   * Errors:
+   * `std::invalid_argument` if `stddev` is negative
+   */
+  template<type _DType>
+  void normal(array<_DType> &dst, const double mean = 0.0, const double stddev = 1.0,
+    generator &gen = default_generator());
+
+  /* Fills `dst` with ones with probability `p`, and zeros otherwise
+   *
+   * Errors:
+   * `std::invalid_argument` if `p` is not in [0, 1]
+   */
+  template<type _DType>
+  void bernoulli(array<_DType> &dst, const double p = 0.5,
+    generator &gen = default_generator());
+
+  /* Fills `dst` with integers drawn uniformly from [low, high), converted to its datatype
+   * like `astype`
+   *
+   * Errors:
+   * `std::invalid_argument` if `low` is not less than `high`
+   */
+  template<type _DType>
+  void integers(array<_DType> &dst, const std::int64_t low, const std::int64_t high,
+    generator &gen = default_generator());
+
+}  // namespace devi::core::internal::random
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace devi::core::internal::random
+{
+  namespace  // for internal linkage
+  {
+    // number of counters encrypted at a time, with every round vectorized across them
+    constexpr std::size_t philox_batch { 256 };
+
+    /* Encrypts the counters (`c0[i]`, `c1[i]`, `c2[i]`, `c3[i]`) for every `i` in [0, n)
+     * in place, with ten rounds of Philox4x32 under the key (`k0`, `k1`)
+     */
+    inline void philox(std::uint32_t *const c0, std::uint32_t *const c1,
+      std::uint32_t *const c2, std::uint32_t *const c3, std::uint32_t k0,
+      std::uint32_t k1, const std::size_t n) noexcept
+    {
+      constexpr std::uint64_t m0 { 0xD2511F53 }, m1 { 0xCD9E8D57 };
+      constexpr std::uint32_t w0 { 0x9E3779B9 }, w1 { 0xBB67AE85 };
+
+      for (unsigned round { 0 }; round < 10; ++round, k0 += w0, k1 += w1)
+        for (std::size_t i { 0 }; i < n; ++i) {
+          const std::uint64_t p0 { m0 * c0[i] }, p1 { m1 * c2[i] };
+          c0[i] = std::uint32_t(p1 >> 32) ^ c1[i] ^ k0;
+          c2[i] = std::uint32_t(p0 >> 32) ^ c3[i] ^ k1;
+          c1[i] = std::uint32_t(p1);
+          c3[i] = std::uint32_t(p0);
+        }
+    }
+
+    // Returns a float32 in [0, 1) from the top 24 bits of `w`
+    inline float unit_float(const std::uint32_t w) noexcept
+    {
+      return float(w >> 8) * 0x1p-24F;
+    }
+
+    // Returns a float64 in [0, 1) from the top 53 bits of (`hi`, `lo`)
+    inline double unit_double(const std::uint32_t hi, const std::uint32_t lo) noexcept
+    {
+      return double(((std::uint64_t(hi) << 32) | lo) >> 11) * 0x1p-53;
+    }
+
+    // Returns the upper 64 bits of the 128-bit product of `a` and `b`
+    inline std::uint64_t mulhi(const std::uint64_t a, const std::uint64_t b) noexcept
+    {
+      const std::uint64_t a0 { a & 0xFFFFFFFF }, a1 { a >> 32 }, b0 { b & 0xFFFFFFFF },
+        b1 { b >> 32 };
+      const std::uint64_t mid { (a0 * b0 >> 32) + (a1 * b0 & 0xFFFFFFFF) + a0 * b1 };
+      return a1 * b1 + (a1 * b0 >> 32) + (mid >> 32);
+    }
+
+    /* Fills `dst` with the next stream of `gen`, `_Lanes` elements from every 128-bit
+     * block of random bits, where `draw(w0, w1, w2, w3, out)` turns the block of words
+     * into elements `out[0]` to `out[_Lanes - 1]`
+     *
+     * Block `b` is the encryption of the counter (`b`, stream) under the key `seed`
+     */
+    template<unsigned _Lanes, type _DType, typename _Draw>
+    void generate(array<_DType> &dst, generator &gen, const _Draw &draw)
+    {
+      using native_type = typename native_type<_DType>::type;
+
+      const auto seed { gen.seed() }, stream { gen.next() };
+      const std::uint32_t k0 { std::uint32_t(seed) }, k1 { std::uint32_t(seed >> 32) },
+        s0 { std::uint32_t(stream) }, s1 { std::uint32_t(stream >> 32) };
+      auto *const out { dst.data() };
+      const auto n { dst.size() }, blocks { (n + _Lanes - 1) / _Lanes };
+
+      parallel_for(
+        blocks,
+        [&](const std::size_t begin, const std::size_t end) {
+          std::uint32_t c0[philox_batch], c1[philox_batch], c2[philox_batch],
+            c3[philox_batch];
+          for (std::size_t first { begin }; first < end; first += philox_batch) {
+            const auto m { std::min(philox_batch, end - first) };
+            for (std::size_t i { 0 }; i < m; ++i) {
+              c0[i] = std::uint32_t(first + i), c1[i] = std::uint32_t((first + i) >> 32);
+              c2[i] = s0, c3[i] = s1;
+            }
+            philox(c0, c1, c2, c3, k0, k1, m);
+
+            // only the last block of the array can be partly used
+            const auto full { std::min(m, n / _Lanes - std::min(n / _Lanes, first)) };
+            auto *const block { out + first * _Lanes };
+            for (std::size_t i { 0 }; i < full; ++i)
+              draw(c0[i], c1[i], c2[i], c3[i], block + i * _Lanes);
+            if (full < m) {
+              native_type tail[_Lanes];
+              draw(c0[full], c1[full], c2[full], c3[full], tail);
+              std::copy_n(tail, n % _Lanes, block + full * _Lanes);
+            }
+          }
+        },
+        philox_batch);
+    }
+
+    /* Returns the largest number of the datatype `_Compute` of the draws which stays less
+     * than `high` once converted to `_Native` (or `low`, if there is none), so that the
+     * draws clamped to it stay in [low, high) even when `low + width * u` rounds up
+     */
+    template<typename _Native, typename _Compute>
+    _Compute uniform_ceiling(const _Compute low, const _Compute high) noexcept
+    {
+      // integers are truncated towards zero, floating point numbers are rounded
+      _Compute gap { high - std::nextafter(high, low) };
+      auto ceiling { high - gap };
+      if constexpr (!std::is_integral_v<_Native>)
+        while (ceiling > low && _Compute(static_cast<_Native>(ceiling)) >= high) {
+          gap *= 2;
+          ceiling = high - gap;
+        }
+      return std::max(ceiling, low);
+    }
+
+    // True if numbers for `_Type` are drawn in float64 rather than float32
+    template<typename _Type>
+    inline constexpr bool draws_double_v {
+      std::is_same_v<_Type, double> || (std::is_integral_v<_Type> && sizeof(_Type) >= 4)
+    };
+  }
+
+  //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+  inline generator::generator(const std::uint64_t seed) noexcept
+    : m_seed { seed }, m_stream { 0 }
+  { }
+
+  inline generator::generator(const generator &other) noexcept
+    : m_seed { other.m_seed }, m_stream { other.stream() }
+  { }
+
+  ////////////////////////////// GETTERS ///////////////////////////////
+
+  inline std::uint64_t generator::seed() const noexcept
+  {
+    return m_seed;
+  }
+
+  inline std::uint64_t generator::stream() const noexcept
+  {
+    return m_stream.load(std::memory_order_relaxed);
+  }
+
+  ////////////////////////////// GENERAL ///////////////////////////////
+
+  inline std::uint64_t generator::next() noexcept
+  {
+    return m_stream.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  inline generator &default_generator() noexcept
+  {
+    static generator instance { 0 };
+    return instance;
+  }
+
+  template<type _DType>
+  void uniform(array<_DType> &dst, const double low, const double high, generator &gen)
+  {
+    using native_type = typename native_type<_DType>::type;
+    if (!(low < high))
+      throw std::invalid_argument { "Uniform: low must be less than high" };
+
+    DEVI_PROFILE_SCOPE("core::random::uniform");
+    if constexpr (draws_double_v<native_type>) {
+      const double width { high - low };
+      const auto top { uniform_ceiling<native_type>(low, high) };
+      generate<2>(dst, gen,
+        [=](const auto w0, const auto w1, const auto w2, const auto w3, auto *const out) {
+          out[0] =
+            static_cast<native_type>(std::min(low + width * unit_double(w0, w1), top));
+          out[1] =
+            static_cast<native_type>(std::min(low + width * unit_double(w2, w3), top));
+        });
+    } else {
+      const float base { float(low) }, width { float(high - low) };
+      const auto top { uniform_ceiling<native_type>(base, float(high)) };
+      generate<4>(dst, gen,
+        [=](const auto w0, const auto w1, const auto w2, const auto w3, auto *const out) {
+          out[0] = static_cast<native_type>(std::min(base + width * unit_float(w0), top));
+          out[1] = static_cast<native_type>(std::min(base + width * unit_float(w1), top));
+          out[2] = static_cast<native_type>(std::min(base + width * unit_float(w2), top));
+          out[3] = static_cast<native_type>(std::min(base + width * unit_float(w3), top));
+        });
+    }
+  }
+
+  template<type _DType>
+  void normal(array<_DType> &dst, const double mean, const double stddev, generator &gen)
+  {
+    using native_type = typename native_type<_DType>::type;
+    if (!(stddev >= 0.0))
+      throw std::invalid_argument { "Normal: standard deviation must be non-negative" };
+
+    DEVI_PROFILE_SCOPE("core::random::normal");
+    // one pair of normal numbers from the radius (which never takes log of 0) and angle
+    if constexpr (draws_double_v<native_type>) {
+      constexpr double tau { 6.283185307179586 };
+      generate<2>(dst, gen,
+        [=](const auto w0, const auto w1, const auto w2, const auto w3, auto *const out) {
+          const double u { 1.0 - unit_double(w0, w1) };
+          const double r { stddev * std::sqrt(-2.0 * std::log(u)) };
+          const double theta { tau * unit_double(w2, w3) };
+          out[0] = static_cast<native_type>(mean + r * std::cos(theta));
+          out[1] = static_cast<native_type>(mean + r * std::sin(theta));
+        });
+    } else {
+      constexpr float tau { 6.2831853F };
+      const float mu { float(mean) }, sigma { float(stddev) };
+      generate<4>(dst, gen,
+        [=](const auto w0, const auto w1, const auto w2, const auto w3, auto *const out) {
+          const float r0 { sigma * std::sqrt(-2.0F * std::log(1.0F - unit_float(w0))) },
+            r1 { sigma * std::sqrt(-2.0F * std::log(1.0F - unit_float(w2))) };
+          const float theta0 { tau * unit_float(w1) }, theta1 { tau * unit_float(w3) };
+          out[0] = static_cast<native_type>(mu + r0 * std::cos(theta0));
+          out[1] = static_cast<native_type>(mu + r0 * std::sin(theta0));
+          out[2] = static_cast<native_type>(mu + r1 * std::cos(theta1));
+          out[3] = static_cast<native_type>(mu + r1 * std::sin(theta1));
+        });
+    }
+  }
+
+  template<type _DType>
+  void bernoulli(array<_DType> &dst, const double p, generator &gen)
+  {
+    using native_type = typename native_type<_DType>::type;
+    if (!(p >= 0.0 && p <= 1.0))
+      throw std::invalid_argument { "Bernoulli: probability must be in [0, 1]" };
+
+    DEVI_PROFILE_SCOPE("core::random::bernoulli");
+    // a word is a one if it is below `threshold` (out of 2^32 equally likely words)
+    const auto threshold { std::uint64_t(std::ldexp(p, 32)) };
+    generate<4>(dst, gen,
+      [=](const auto w0, const auto w1, const auto w2, const auto w3, auto *const out) {
+        out[0] = static_cast<native_type>(w0 < threshold);
+        out[1] = static_cast<native_type>(w1 < threshold);
+        out[2] = static_cast<native_type>(w2 < threshold);
+        out[3] = static_cast<native_type>(w3 < threshold);
+      });
+  }
+
+  template<type _DType>
+  void integers(array<_DType> &dst, const std::int64_t low, const std::int64_t high,
+    generator &gen)
+  {
+    using native_type = typename native_type<_DType>::type;
+    if (!(low < high))
+      throw std::invalid_argument { "Integers: low must be less than high" };
+
+    DEVI_PROFILE_SCOPE("core::random::integers");
+    // 64 random bits scaled onto the range (biased by atmost range / 2^64)
+    const auto base { std::uint64_t(low) }, range { std::uint64_t(high) - base };
+    generate<2>(dst, gen,
+      [=](const auto w0, const auto w1, const auto w2, const auto w3, auto *const out) {
+        const auto x0 { (std::uint64_t(w0) << 32) | w1 },
+          x1 { (std::uint64_t(w2) << 32) | w3 };
+        out[0] = static_cast<native_type>(std::int64_t(base + mulhi(x0, range)));
+        out[1] = static_cast<native_type>(std::int64_t(base + mulhi(x1, range)));
+      });
+  }
+
+}  // namespace devi::core::internal::random
+
+#endif
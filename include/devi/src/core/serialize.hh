@@ -0,0 +1,546 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_SERIALIZE_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_SERIALIZE_HH_
+
+#include "__header_check__"
+#include "array.hh"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace devi::core::internal
+{
+  /* Returns the compressed binary serialization of `src`, which records its datatype and
+   * shape along with its elements (in the byte order of the host)
+   *
+   * Elements are compressed losslessly in independent chunks of 64KB, in parallel. Every
+   * chunk is delta coded (where that makes more bytes zero, like in masks and smooth
+   * images), byte-shuffled (so that the bytes of equal significance of all the elements
+   * are adjacent) and then compressed with an LZ77 codec, or stored as is if that does
+   * not make it any smaller.
+   *
+   * Errors:
+   * `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] std::vector<std::uint8_t> serialize(const array<_DType> &src);
+
+  /* Decodes the `size` bytes at `data` returned by `serialize` directly into the storage
+   * of `dst`, in parallel
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if the bytes are not a valid serialization, or if its
+   *    datatype or shape is not the datatype or shape of `dst`
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  void deserialize(
+    const std::uint8_t *const data, const std::size_t size, array<_DType> &dst);
+
+  /* Returns the array decoded from the `size` bytes at `data` returned by `serialize`
+   *
+   * Errors:
+   * Same as the overload above
+   */
+  template<type _DType>
+  [[nodiscard]] array<_DType> deserialize(
+    const std::uint8_t *const data, const std::size_t size);
+
+  /* Writes the serialization of `src` into `out`
+   *
+   * Errors:
+   * `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  void save(std::ostream &out, const array<_DType> &src);
+
+  /* Reads an array written by `save` from `in`, consuming exactly its bytes
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `in` ends before the array or does not hold a valid
+   *    serialization of datatype `_DType`
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<_DType> load(std::istream &in);
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    // bytes of elements in a chunk, small enough for LZ offsets to fit into 16 bits
+    constexpr std::size_t serial_chunk { 1UL << 16 };
+    constexpr char serial_magic[4] { 'D', 'V', 'Z', '1' };
+
+    // chunk modes (the first byte of every encoded chunk)
+    constexpr std::uint8_t chunk_stored { 0 }, chunk_lz { 1 }, chunk_delta { 2 };
+
+    // Returns the largest size of `n` bytes compressed by `lz_compress`
+    constexpr std::size_t lz_bound(const std::size_t n) noexcept
+    {
+      return n + n / 255 + 16;
+    }
+
+    // Writes the part of a length over 15 (15 in the token), as bytes of 255 and the rest
+    inline std::uint8_t *put_length(std::uint8_t *out, std::size_t n) noexcept
+    {
+      for (; n >= 255; n -= 255) *out++ = 255;
+      *out++ = std::uint8_t(n);
+      return out;
+    }
+
+    // Writes a sequence of `literals` bytes at `in` followed by a match of `length` bytes
+    // at `offset` bytes before it (none for the last sequence, where `length` is zero)
+    inline std::uint8_t *put_sequence(std::uint8_t *out, const std::uint8_t *const in,
+      const std::size_t literals, const std::size_t offset, const std::size_t length)
+    {
+      const auto extra { length ? length - 4 : 0 };
+      *out++ = std::uint8_t(std::min<std::size_t>(literals, 15) << 4
+                            | std::min<std::size_t>(extra, 15));
+      if (literals >= 15) out = put_length(out, literals - 15);
+      std::memcpy(out, in, literals);
+      out += literals;
+      if (!length) return out;
+
+      *out++ = std::uint8_t(offset);
+      *out++ = std::uint8_t(offset >> 8);
+      if (extra >= 15) out = put_length(out, extra - 15);
+      return out;
+    }
+
+    /* Compresses `n` (atmost `serial_chunk`) bytes at `in` into `out`, which must hold
+     * atleast `lz_bound(n)` bytes, and returns the compressed size
+     *
+     * The format is a list of sequences (as in LZ4): a token of the literal and match
+     * lengths, the literal bytes, and the 16-bit offset of the match, where repeated
+     * bytes are matches at offset one (i.e. runs are run-length coded)
+     */
+    inline std::size_t lz_compress(
+      const std::uint8_t *const in, const std::size_t n, std::uint8_t *const out) noexcept
+    {
+      constexpr unsigned bits { 13 };
+      std::uint16_t table[1U << bits] {};  // last position of every hashed 4-byte prefix
+      const auto hash { [](const std::uint32_t v) {
+        return (v * 2654435761U) >> (32 - bits);
+      } };
+
+      auto *op { out };
+      std::size_t anchor { 0 }, i { 1 }, misses { 0 };
+      while (i + 12 <= n) {
+        std::uint32_t v, c;
+        std::memcpy(&v, in + i, 4);
+        auto &slot { table[hash(v)] };
+        const std::size_t candidate { slot };
+        slot = std::uint16_t(i);
+        std::memcpy(&c, in + candidate, 4);
+        if (c != v) {  // incompressible data is skipped faster and faster
+          i += 1 + (misses++ >> 5);
+          continue;
+        }
+        misses = 0;
+
+        // extend the match 8 bytes at a time
+        std::size_t length { 4 };
+        while (i + length + 8 <= n) {
+          std::uint64_t a, b;
+          std::memcpy(&a, in + candidate + length, 8);
+          std::memcpy(&b, in + i + length, 8);
+          if (a != b) {
+            length += std::size_t(__builtin_ctzll(a ^ b)) / 8;
+            break;
+          }
+          length += 8;
+        }
+        if (i + length + 8 > n)
+          while (i + length < n && in[candidate + length] == in[i + length]) ++length;
+
+        op = put_sequence(op, in + anchor, i - anchor, i - candidate, length);
+        i += length;
+        anchor = i;
+      }
+      return std::size_t(put_sequence(op, in + anchor, n - anchor, 0, 0) - out);
+    }
+
+    // Decompresses `size` bytes at `in` into exactly `n` bytes at `out`, and returns
+    // false if the input is corrupt (without ever reading or writing out of bounds)
+    inline bool lz_decompress(const std::uint8_t *in, const std::size_t size,
+      std::uint8_t *const out, const std::size_t n) noexcept
+    {
+      const auto *const end { in + size };
+      auto *op { out };
+      auto *const oend { out + n };
+      const auto length { [&](std::size_t &value) {
+        if (value != 15) return true;
+        for (std::uint8_t b { 255 }; b == 255; value += b) {
+          if (in == end) return false;
+          b = *in++;
+        }
+        return true;
+      } };
+
+      for (;;) {
+        if (in == end) return false;
+        const auto token { *in++ };
+        std::size_t literals { std::size_t(token >> 4) };
+        std::size_t extra { std::size_t(token & 15) };
+        if (!length(literals) || literals > std::size_t(end - in)
+            || literals > std::size_t(oend - op))
+          return false;
+        std::memcpy(op, in, literals);
+        in += literals;
+        op += literals;
+        if (op == oend) return in == end;
+
+        if (end - in < 2) return false;
+        const std::size_t offset { std::size_t(in[0]) | std::size_t(in[1]) << 8 };
+        in += 2;
+        if (!length(extra)) return false;
+        const auto match { extra + 4 };
+        if (offset == 0 || offset > std::size_t(op - out)
+            || match > std::size_t(oend - op))
+          return false;
+
+        if (offset >= match) std::memcpy(op, op - offset, match);
+        else {  // a pattern repeated every `offset` bytes, copied in doubling blocks
+          std::memcpy(op, op - offset, offset);
+          for (std::size_t done { offset }; done < match; done *= 2)
+            std::memcpy(op + done, op, std::min(done, match - done));
+        }
+        op += match;
+      }
+    }
+
+    // Returns true if delta coding the `m` elements (of `_Bytes` bytes) at `in` makes
+    // more of their bytes zero, judged on a sample
+    template<std::size_t _Bytes>
+    bool prefers_delta(const std::uint8_t *const in, const std::size_t m) noexcept
+    {
+      std::size_t raw { 0 }, delta { 0 };
+      const auto sample { std::min<std::size_t>(m, 2048) };
+      for (std::size_t k { 1 }; k < sample; ++k)
+        for (std::size_t b { 0 }; b < _Bytes; ++b) {
+          raw += in[k * _Bytes + b] == 0;
+          // the bytes of the difference, with borrows, are approximated by the bytewise
+          // difference, which is zero exactly where the bytes are equal
+          delta += in[k * _Bytes + b] == in[(k - 1) * _Bytes + b];
+        }
+      return delta > raw;
+    }
+
+    // Unsigned integer of `_Bytes` bytes
+    template<std::size_t _Bytes>
+    using word_t = std::conditional_t<_Bytes == 1, std::uint8_t,
+      std::conditional_t<_Bytes == 2, std::uint16_t,
+        std::conditional_t<_Bytes == 4, std::uint32_t, std::uint64_t>>>;
+
+    // Writes the (delta coded) `m` elements at `in` into `out`, byte-shuffled
+    template<std::size_t _Bytes>
+    void shuffle(const std::uint8_t *const in, const std::size_t m, const bool delta,
+      std::uint8_t *const out) noexcept
+    {
+      using word = word_t<_Bytes>;
+      word previous { 0 };
+      for (std::size_t k { 0 }; k < m; ++k) {
+        word v;
+        std::memcpy(&v, in + k * _Bytes, _Bytes);
+        const word coded { delta ? word(v - previous) : v };
+        previous = v;
+        for (std::size_t b { 0 }; b < _Bytes; ++b)
+          out[b * m + k] = std::uint8_t(coded >> 8 * b);
+      }
+    }
+
+    // Inverse of `shuffle`
+    template<std::size_t _Bytes>
+    void unshuffle(const std::uint8_t *const in, const std::size_t m, const bool delta,
+      std::uint8_t *const out) noexcept
+    {
+      using word = word_t<_Bytes>;
+      word previous { 0 };
+      for (std::size_t k { 0 }; k < m; ++k) {
+        word v { 0 };
+        for (std::size_t b { 0 }; b < _Bytes; ++b)
+          v |= word(word(in[b * m + k]) << 8 * b);
+        if (delta) v = previous += v;
+        std::memcpy(out + k * _Bytes, &v, _Bytes);
+      }
+    }
+
+    // Encodes the `m` elements at `in` into `out` (which must hold atleast
+    // `lz_bound(m * _Bytes) + 1` bytes), using `scratch` of `m * _Bytes` bytes, and
+    // returns the encoded size
+    template<std::size_t _Bytes>
+    std::size_t encode_chunk(const std::uint8_t *const in, const std::size_t m,
+      std::uint8_t *const out, std::uint8_t *const scratch) noexcept
+    {
+      const auto n { m * _Bytes };
+      const bool delta { prefers_delta<_Bytes>(in, m) };
+      shuffle<_Bytes>(in, m, delta, scratch);
+
+      const auto size { lz_compress(scratch, n, out + 1) };
+      if (size >= n) {
+        out[0] = chunk_stored;
+        std::memcpy(out + 1, in, n);
+        return n + 1;
+      }
+      out[0] = std::uint8_t(chunk_lz | (delta ? chunk_delta : 0));
+      return size + 1;
+    }
+
+    // Decodes the `size` bytes at `in` encoded by `encode_chunk` into the `m` elements at
+    // `out`, using `scratch` of `m * _Bytes` bytes, and returns false if they are corrupt
+    template<std::size_t _Bytes>
+    bool decode_chunk(const std::uint8_t *const in, const std::size_t size,
+      const std::size_t m, std::uint8_t *const out, std::uint8_t *const scratch) noexcept
+    {
+      const auto n { m * _Bytes };
+      if (size == 0 || (in[0] != chunk_stored && !(in[0] & chunk_lz)) || in[0] > 3)
+        return false;
+      if (in[0] == chunk_stored) {
+        if (size != n + 1) return false;
+        std::memcpy(out, in + 1, n);
+        return true;
+      }
+
+      // single bytes are not shuffled, so they are decompressed in place
+      const bool delta { (in[0] & chunk_delta) != 0 };
+      auto *const target { _Bytes == 1 ? out : scratch };
+      if (!lz_decompress(in + 1, size - 1, target, n)) return false;
+      if (_Bytes > 1 || delta) unshuffle<_Bytes>(target, m, delta, out);
+      return true;
+    }
+
+    // Appends the `n` bytes of `value` to `out`
+    template<typename _Type>
+    void put_bytes(std::vector<std::uint8_t> &out, const _Type value)
+    {
+      const auto *const bytes { reinterpret_cast<const std::uint8_t *>(&value) };
+      out.insert(out.end(), bytes, bytes + sizeof value);
+    }
+
+    // Layout of a serialization, read from its header
+    struct serial_header {
+      std::size_t m_dims[10];
+      unsigned m_ndims;
+      std::uint8_t m_type;
+      std::size_t m_chunks, m_header_bytes;
+    };
+
+    // Returns the size of the header of a serialization of `ndims` dimensions and
+    // `chunks` chunks
+    constexpr std::size_t header_bytes(const unsigned ndims, const std::size_t chunks)
+    {
+      return 4 + 1 + 1 + 8 * ndims + 4 + 4 * chunks;
+    }
+
+    /* Reads the header of the `size` bytes at `data`, up to the table of chunk sizes, of
+     * an array of elements of `element` bytes (whose size in bytes must fit a size_t)
+     */
+    inline serial_header read_header(
+      const std::uint8_t *const data, const std::size_t size, const std::size_t element)
+    {
+      const char *const error { "Deserialize: bytes are not a valid serialization" };
+      if (size < header_bytes(0, 0) || std::memcmp(data, serial_magic, 4) != 0)
+        throw std::invalid_argument { error };
+
+      serial_header ret {};
+      ret.m_type  = data[4];
+      ret.m_ndims = data[5];
+      if (ret.m_ndims == 0 || ret.m_ndims > 10 || size < header_bytes(ret.m_ndims, 0))
+        throw std::invalid_argument { error };
+      std::memcpy(ret.m_dims, data + 6, 8 * ret.m_ndims);
+      // (the size of a forged shape could otherwise wrap around, and its array would get
+      // storage for fewer elements than the shape holds)
+      std::size_t bytes { element };
+      const std::size_t *const dims { ret.m_dims }, *const end { dims + ret.m_ndims };
+      const bool empty { std::find(dims, end, std::size_t { 0 }) != end };
+      for (unsigned i { 0 }; !empty && i < ret.m_ndims; ++i) {
+        if (ret.m_dims[i] > SIZE_MAX / bytes) throw std::invalid_argument { error };
+        bytes *= ret.m_dims[i];
+      }
+      std::uint32_t chunks;
+      std::memcpy(&chunks, data + 6 + 8 * ret.m_ndims, 4);
+      ret.m_chunks       = chunks;
+      ret.m_header_bytes = header_bytes(ret.m_ndims, chunks);
+      return ret;
+    }
+  }
+
+  template<type _DType>
+  std::vector<std::uint8_t> serialize(const array<_DType> &src)
+  {
+    DEVI_PROFILE_SCOPE("core::serialize");
+    using native_type = typename native_type<_DType>::type;
+    constexpr std::size_t bytes { sizeof(native_type) };
+    constexpr std::size_t per_chunk { serial_chunk / bytes };
+    const auto &s { src.shape() };
+    const std::size_t n { src.size() }, chunks { (n + per_chunk - 1) / per_chunk };
+
+    std::vector<std::uint8_t> ret;
+    ret.reserve(header_bytes(s.ndims(), chunks));
+    ret.insert(ret.end(), serial_magic, serial_magic + 4);
+    ret.push_back(std::uint8_t(_DType));
+    ret.push_back(std::uint8_t(s.ndims()));
+    for (unsigned d { 0 }; d < s.ndims(); ++d) put_bytes(ret, std::uint64_t(s[d]));
+    put_bytes(ret, std::uint32_t(chunks));
+
+    // every chunk is encoded into a slot of the largest encoded size, then compacted
+    constexpr std::size_t slot { lz_bound(serial_chunk) + 1 };
+    const std::unique_ptr<std::uint8_t[]> encoded { new std::uint8_t[chunks * slot] };
+    std::vector<std::size_t> sizes(chunks);
+    DEVI_PROFILE_ALLOCATION(workspace, chunks * slot);
+    const auto *const in { reinterpret_cast<const std::uint8_t *>(src.data()) };
+    parallel_for(chunks, [&](const std::size_t begin, const std::size_t end) {
+      std::vector<std::uint8_t> scratch(serial_chunk);
+      for (auto c { begin }; c < end; ++c) {
+        const auto m { std::min(per_chunk, n - c * per_chunk) };
+        sizes[c] = encode_chunk<bytes>(
+          in + c * serial_chunk, m, encoded.get() + c * slot, scratch.data());
+      }
+    });
+
+    std::size_t total { ret.size() + 4 * chunks };
+    for (const auto size : sizes) total += size;
+    ret.reserve(total);
+    for (const auto size : sizes) put_bytes(ret, std::uint32_t(size));
+    for (std::size_t c { 0 }; c < chunks; ++c) {
+      const auto *const chunk { encoded.get() + c * slot };
+      ret.insert(ret.end(), chunk, chunk + sizes[c]);
+    }
+    return ret;
+  }
+
+  template<type _DType>
+  void deserialize(
+    const std::uint8_t *const data, const std::size_t size, array<_DType> &dst)
+  {
+    DEVI_PROFILE_SCOPE("core::deserialize");
+    using native_type = typename native_type<_DType>::type;
+    constexpr std::size_t bytes { sizeof(native_type) };
+    constexpr std::size_t per_chunk { serial_chunk / bytes };
+    const char *const error { "Deserialize: bytes are not a valid serialization" };
+
+    const auto header { read_header(data, size, sizeof(native_type)) };
+    if (header.m_type != std::uint8_t(_DType))
+      throw std::invalid_argument { "Deserialize: datatype does not match" };
+    if (shape::from_dims(header.m_dims, header.m_ndims) != dst.shape())
+      throw std::invalid_argument { "Deserialize: shape does not match" };
+
+    const std::size_t n { dst.size() }, chunks { (n + per_chunk - 1) / per_chunk };
+    if (header.m_chunks != chunks || size < header.m_header_bytes)
+      throw std::invalid_argument { error };
+
+    // offsets of the chunks from the prefix sum of their sizes
+    std::vector<std::size_t> offsets(chunks + 1, header.m_header_bytes);
+    for (std::size_t c { 0 }; c < chunks; ++c) {
+      std::uint32_t length;
+      std::memcpy(&length, data + header.m_header_bytes - 4 * (chunks - c), 4);
+      offsets[c + 1] = offsets[c] + length;
+    }
+    if (offsets[chunks] != size) throw std::invalid_argument { error };
+
+    auto *const out { reinterpret_cast<std::uint8_t *>(dst.data()) };
+    std::atomic<bool> corrupt { false };
+    parallel_for(chunks, [&](const std::size_t begin, const std::size_t end) {
+      std::vector<std::uint8_t> scratch(bytes > 1 ? serial_chunk : 0);
+      for (auto c { begin }; c < end; ++c) {
+        const auto m { std::min(per_chunk, n - c * per_chunk) };
+        if (!decode_chunk<bytes>(data + offsets[c], offsets[c + 1] - offsets[c], m,
+              out + c * serial_chunk, scratch.data()))
+          corrupt = true;
+      }
+    });
+    if (corrupt) throw std::invalid_argument { error };
+  }
+
+  template<type _DType>
+  array<_DType> deserialize(const std::uint8_t *const data, const std::size_t size)
+  {
+    using native_type = typename native_type<_DType>::type;
+    const auto header { read_header(data, size, sizeof(native_type)) };
+    array<_DType> ret { shape::from_dims(header.m_dims, header.m_ndims) };
+    deserialize(data, size, ret);
+    return ret;
+  }
+
+  template<type _DType>
+  void save(std::ostream &out, const array<_DType> &src)
+  {
+    const auto bytes { serialize(src) };
+    const auto *const chars { reinterpret_cast<const char *>(bytes.data()) };
+    out.write(chars, std::streamsize(bytes.size()));
+  }
+
+  template<type _DType>
+  array<_DType> load(std::istream &in)
+  {
+    using native_type = typename native_type<_DType>::type;
+    std::vector<std::uint8_t> bytes;
+    const auto read { [&](const std::size_t n) {
+      const auto start { bytes.size() };
+      bytes.resize(start + n);
+      if (!in.read(reinterpret_cast<char *>(bytes.data() + start), std::streamsize(n)))
+        throw std::invalid_argument { "Load: stream ended before the array" };
+    } };
+
+    // the header is read in parts, since every part gives the size of the next one
+    read(header_bytes(0, 0));
+    if (bytes[5] > 10) throw std::invalid_argument { "Load: array is not valid" };
+    read(8 * bytes[5]);
+    auto header { read_header(bytes.data(), bytes.size(), sizeof(native_type)) };
+
+    // the table and the chunks are only read if their sizes fit the array, so that a
+    // corrupt header cannot make the stream be read (and buffered) without bound
+    constexpr std::size_t per_chunk { serial_chunk / sizeof(native_type) };
+    const auto n { shape::from_dims(header.m_dims, header.m_ndims).size() };
+    if (header.m_type != std::uint8_t(_DType)
+        || header.m_chunks != (n + per_chunk - 1) / per_chunk)
+      throw std::invalid_argument { "Load: array is not valid" };
+    read(4 * header.m_chunks);
+
+    std::size_t payload { 0 };
+    for (std::size_t c { 0 }; c < header.m_chunks; ++c) {
+      std::uint32_t length;
+      const auto at { header.m_header_bytes - 4 * (header.m_chunks - c) };
+      std::memcpy(&length, bytes.data() + at, 4);
+      if (length > lz_bound(serial_chunk) + 1)
+        throw std::invalid_argument { "Load: array is not valid" };
+      payload += length;
+    }
+    read(payload);
+    return deserialize<_DType>(bytes.data(), bytes.size());
+  }
+
+}  // namespace devi::core::internal
+
+#endif
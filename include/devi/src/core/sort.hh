@@ -0,0 +1,372 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_SORT_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_SORT_HH_
+
+#include "__header_check__"
+#include "array.hh"
+#include "compare.hh"
+
+namespace devi::core::internal
+{
+  /* Returns a copy of `src` with its elements sorted along `axis` in ascending (or
+   * descending) order, where equal elements keep their relative order and NaNs are
+   * ordered after all numbers (i.e. last in ascending and first in descending order)
+   *
+   * Long lanes along the axis are radix sorted and short ones comparison sorted, with all
+   * the independent lanes sorted in parallel
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `axis` is out of bounds of the shape of `src`
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<_DType> sort(const array<_DType> &src, const unsigned axis,
+    const bool descending = false);
+  template<type _DType>
+  [[nodiscard]] array<_DType> sort(const view<_DType> &src, const unsigned axis,
+    const bool descending = false);
+
+  /* Returns the positions (along `axis`) of the elements of `src` in the order `sort`
+   * would place them in, i.e. `sort(src, axis)` gathered from `src` by these positions
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `axis` is out of bounds of the shape of `src`
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<type::int64> argsort(const array<_DType> &src, const unsigned axis,
+    const bool descending = false);
+  template<type _DType>
+  [[nodiscard]] array<type::int64> argsort(const view<_DType> &src, const unsigned axis,
+    const bool descending = false);
+
+  // Values and positions (along the axis) of the elements selected by `topk`
+  template<type _DType>
+  struct topk_result {
+    array<_DType> m_values;
+    array<type::int64> m_indices;
+  };
+
+  /* Returns the `k` largest (or smallest) elements of every lane of `src` along `axis`,
+   * in sorted order, along with their positions; the shape of both arrays is the shape of
+   * `src` with its `axis` dimension replaced by `k`
+   *
+   * Every lane is partially ordered with a selection algorithm before sorting only the
+   * `k` selected elements, and ties are broken by the smaller position (NaNs count as
+   * larger than all numbers)
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `axis` is out of bounds of the shape of `src`, or if
+   *    `k` is zero or greater than the length of the axis
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] topk_result<_DType> topk(const array<_DType> &src, const std::size_t k,
+    const unsigned axis, const bool largest = true);
+  template<type _DType>
+  [[nodiscard]] topk_result<_DType> topk(const view<_DType> &src, const std::size_t k,
+    const unsigned axis, const bool largest = true);
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    // lanes atleast this long are radix sorted
+    constexpr std::size_t radix_threshold { 1UL << 8 };
+
+    // Unsigned integer of the same size as `_Type`
+    template<typename _Type>
+    using unsigned_of = std::conditional_t<sizeof(_Type) == 1, std::uint8_t,
+      std::conditional_t<sizeof(_Type) == 2, std::uint16_t,
+        std::conditional_t<sizeof(_Type) == 4, std::uint32_t, std::uint64_t>>>;
+
+    /* Maps `value` onto an unsigned integer key, such that keys are ordered just like the
+     * values, NaNs map onto the largest key and both zeros onto the same key
+     */
+    template<typename _Native>
+    unsigned_of<_Native> sort_key(const _Native value) noexcept
+    {
+      using key = unsigned_of<_Native>;
+      constexpr key sign { key(key(1) << (8 * sizeof(key) - 1)) };
+
+      if constexpr (std::is_same_v<_Native, bool>) return key(value);
+      else if constexpr (std::is_unsigned_v<_Native>) return value;
+      else if constexpr (std::is_integral_v<_Native>) return key(key(value) ^ sign);
+      else {
+        const auto number { compute_type<_Native>(value) };
+        if (number != number) return key(~key(0));
+        if (number == 0) return sign;
+
+        // flip negative numbers entirely, and only the sign bit of positive ones
+        key bits;
+        std::memcpy(&bits, &value, sizeof bits);
+        return bits & sign ? key(~bits) : key(bits | sign);
+      }
+    }
+
+    // Sort key of an element along with its position in the lane
+    template<typename _Key, typename _Index>
+    struct keyed {
+      _Key m_key;
+      _Index m_index;
+
+      bool operator<(const keyed &other) const noexcept
+      {
+        return m_key < other.m_key || (m_key == other.m_key && m_index < other.m_index);
+      }
+    };
+
+    /* Stable LSD radix sort of `n` keyed elements by their keys, one byte at a time,
+     * using `buffer` (of atleast `n` elements) as scratch space
+     */
+    template<typename _Entry>
+    void radix_sort(_Entry *const data, _Entry *const buffer, const std::size_t n)
+    {
+      constexpr unsigned passes { sizeof(_Entry::m_key) };
+      std::size_t counts[passes][256] {};
+      for (std::size_t i { 0 }; i < n; ++i)
+        for (unsigned p { 0 }; p < passes; ++p)
+          ++counts[p][(data[i].m_key >> 8 * p) & 0xFF];
+
+      auto *from { data }, *to { buffer };
+      for (unsigned p { 0 }; p < passes; ++p) {
+        auto &offsets { counts[p] };
+        if (offsets[(from[0].m_key >> 8 * p) & 0xFF] == n) continue;  // a single digit
+
+        for (std::size_t b { 0 }, sum { 0 }; b < 256; ++b)
+          sum += std::exchange(offsets[b], sum);
+        for (std::size_t i { 0 }; i < n; ++i)
+          to[offsets[(from[i].m_key >> 8 * p) & 0xFF]++] = from[i];
+        std::swap(from, to);
+      }
+      if (from != data) std::copy(from, from + n, data);
+    }
+
+    // Returns the offset of the first element of lane `lane` along `axis` of a layout
+    inline std::size_t lane_offset(const shape &shape, const slice_data &stride,
+      const unsigned axis, std::size_t lane) noexcept
+    {
+      std::size_t offset { 0 };
+      for (auto d { shape.ndims() }; d--;)
+        if (d != axis) {
+          offset += lane % shape[d] * stride[d];
+          lane /= shape[d];
+        }
+      return offset;
+    }
+
+    template<typename _Src>
+    void throw_if_axis_out_of_bounds(const _Src &src, const unsigned axis)
+    {
+      if (axis >= src.ndims())
+        throw std::invalid_argument { "Sort: axis is out of bounds of the shape" };
+    }
+
+    /* Calls `order(entries, buffer, n)` for every lane of `src` along `axis` in parallel,
+     * where `entries` holds the keys of the `n` elements of the lane along with their
+     * positions (as `_Index`) and `buffer` is scratch space of `n` entries, and then
+     * `write(lane, entries)` once the lane has been ordered
+     */
+    template<typename _Index, typename _Src, typename _Order, typename _Write>
+    void order_lanes_with(const _Src &src, const unsigned axis, const bool descending,
+      const _Order &order, const _Write &write)
+    {
+      using native = std::remove_cv_t<std::remove_pointer_t<decltype(src.data())>>;
+      using key    = unsigned_of<native>;
+      using entry  = keyed<key, _Index>;
+
+      const auto stride { src.stride() };
+      const auto n { src.shape()[axis] }, step { stride[axis] };
+      const auto *const data { src.data() };
+      if (src.size() == 0) return;
+
+      // every chunk of lanes should amount to a fair share of elements
+      parallel_for(src.size() / n, [&](const std::size_t begin, const std::size_t end) {
+        std::vector<entry> entries(2 * n);
+        DEVI_PROFILE_ALLOCATION(workspace, entries.size() * sizeof(entry));
+
+        for (auto lane { begin }; lane < end; ++lane) {
+          const auto *const first { data + lane_offset(src.shape(), stride, axis, lane) };
+          for (std::size_t i { 0 }; i < n; ++i) {
+            const auto k { sort_key(first[i * step]) };
+            entries[i] = { descending ? key(~k) : k, _Index(i) };
+          }
+          order(entries.data(), entries.data() + n, n);
+          write(lane, entries.data());
+        }
+      }, std::max(1UL, (1UL << 15) / n));
+    }
+
+    // Orders the lanes (see above), storing positions in 32 bits whenever they fit
+    template<typename _Src, typename _Order, typename _Write>
+    void order_lanes(const _Src &src, const unsigned axis, const bool descending,
+      const _Order &order, const _Write &write)
+    {
+      if (src.shape()[axis] <= std::numeric_limits<std::uint32_t>::max())
+        order_lanes_with<std::uint32_t>(src, axis, descending, order, write);
+      else order_lanes_with<std::size_t>(src, axis, descending, order, write);
+    }
+
+    // Fully orders the `n` entries of a lane
+    template<typename _Entry>
+    void order_all(_Entry *const entries, _Entry *const buffer, const std::size_t n)
+    {
+      if (n >= radix_threshold) radix_sort(entries, buffer, n);
+      else std::sort(entries, entries + n);
+    }
+
+    template<type _DType, typename _Src>
+    array<_DType> sort_lanes(const _Src &src, const unsigned axis, const bool descending)
+    {
+      DEVI_PROFILE_SCOPE("core::sort");
+      throw_if_axis_out_of_bounds(src, axis);
+      array<_DType> ret { src.shape() };
+
+      const auto in_stride { src.stride() }, out_stride { ret.stride() };
+      const auto n { src.shape()[axis] };
+      const auto in_step { in_stride[axis] }, out_step { out_stride[axis] };
+      const auto *const in { src.data() };
+      auto *const out { ret.data() };
+      order_lanes(src, axis, descending,
+        [](auto *const entries, auto *const buffer, const std::size_t length) {
+          order_all(entries, buffer, length);
+        },
+        [&](const std::size_t lane, const auto *const entries) {
+          const auto from { lane_offset(src.shape(), in_stride, axis, lane) };
+          auto *const dst { out + lane_offset(ret.shape(), out_stride, axis, lane) };
+          for (std::size_t i { 0 }; i < n; ++i)
+            dst[i * out_step] = in[from + entries[i].m_index * in_step];
+        });
+      return ret;
+    }
+
+    template<typename _Src>
+    array<type::int64> argsort_lanes(const _Src &src, const unsigned axis,
+      const bool descending)
+    {
+      DEVI_PROFILE_SCOPE("core::argsort");
+      throw_if_axis_out_of_bounds(src, axis);
+      array<type::int64> ret { src.shape() };
+
+      const auto out_stride { ret.stride() };
+      const auto n { src.shape()[axis] }, out_step { out_stride[axis] };
+      auto *const out { ret.data() };
+      order_lanes(src, axis, descending,
+        [](auto *const entries, auto *const buffer, const std::size_t length) {
+          order_all(entries, buffer, length);
+        },
+        [&](const std::size_t lane, const auto *const entries) {
+          auto *const dst { out + lane_offset(ret.shape(), out_stride, axis, lane) };
+          for (std::size_t i { 0 }; i < n; ++i)
+            dst[i * out_step] = std::int64_t(entries[i].m_index);
+        });
+      return ret;
+    }
+
+    template<type _DType, typename _Src>
+    topk_result<_DType> topk_lanes(const _Src &src, const std::size_t k,
+      const unsigned axis, const bool largest)
+    {
+      DEVI_PROFILE_SCOPE("core::topk");
+      throw_if_axis_out_of_bounds(src, axis);
+      if (k == 0 || k > src.shape()[axis])
+        throw std::invalid_argument { "Top-k: k must be in [1, length of the axis]" };
+
+      auto selected { src.shape() };
+      selected[axis] = k;
+      topk_result<_DType> ret { array<_DType> { selected },
+        array<type::int64> { selected } };
+
+      const auto in_stride { src.stride() }, out_stride { ret.m_values.stride() };
+      const auto in_step { in_stride[axis] }, out_step { out_stride[axis] };
+      const auto *const in { src.data() };
+      auto *const values { ret.m_values.data() };
+      auto *const indices { ret.m_indices.data() };
+      order_lanes(src, axis, largest,
+        [k](auto *const entries, auto *, const std::size_t length) {
+          // select the first `k` entries in linear time, and then only sort those
+          if (k < length) std::nth_element(entries, entries + k, entries + length);
+          std::sort(entries, entries + k);
+        },
+        [&](const std::size_t lane, const auto *const entries) {
+          const auto from { lane_offset(src.shape(), in_stride, axis, lane) };
+          const auto offset { lane_offset(selected, out_stride, axis, lane) };
+          for (std::size_t i { 0 }; i < k; ++i) {
+            values[offset + i * out_step]  = in[from + entries[i].m_index * in_step];
+            indices[offset + i * out_step] = std::int64_t(entries[i].m_index);
+          }
+        });
+      return ret;
+    }
+  }
+
+  template<type _DType>
+  array<_DType> sort(const array<_DType> &src, const unsigned axis, const bool descending)
+  {
+    return sort_lanes<_DType>(src, axis, descending);
+  }
+
+  template<type _DType>
+  array<_DType> sort(const view<_DType> &src, const unsigned axis, const bool descending)
+  {
+    return sort_lanes<_DType>(src, axis, descending);
+  }
+
+  template<type _DType>
+  array<type::int64> argsort(const array<_DType> &src, const unsigned axis,
+    const bool descending)
+  {
+    return argsort_lanes(src, axis, descending);
+  }
+
+  template<type _DType>
+  array<type::int64> argsort(const view<_DType> &src, const unsigned axis,
+    const bool descending)
+  {
+    return argsort_lanes(src, axis, descending);
+  }
+
+  template<type _DType>
+  topk_result<_DType> topk(const array<_DType> &src, const std::size_t k,
+    const unsigned axis, const bool largest)
+  {
+    return topk_lanes<_DType>(src, k, axis, largest);
+  }
+
+  template<type _DType>
+  topk_result<_DType> topk(const view<_DType> &src, const std::size_t k,
+    const unsigned axis, const bool largest)
+  {
+    return topk_lanes<_DType>(src, k, axis, largest);
+  }
+
+}  // namespace devi::core::internal
+
+#endif
@@ -0,0 +1,338 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_STRIDED_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_STRIDED_HH_
+
+#include "__header_check__"
+#include "dimension/slice.hh"
+#include "parallel.hh"
+
+namespace devi::core::internal
+{
+  /* Returns the number of rows in a strided memory layout of the argument `shape`, where
+   * a row is a run of elements along the last dimension
+   */
+  [[nodiscard]] std::size_t row_count(const shape &shape) noexcept;
+
+  /* Calls `body(row, offset)` for every row in [begin, end) of the strided memory layout
+   * given by `shape` and `stride`, where `offset` is the distance (in elements) from the
+   * first element of the layout to the first element of the row
+   *
+   * Consecutive elements of a row are `stride[ndims - 1]` elements apart
+   *
+   * Precondition: `end` must be atmost `row_count(shape)`
+   */
+  template<typename _Body>
+  void for_each_row(const shape &shape, const slice_data &stride, const std::size_t begin,
+    const std::size_t end, _Body &&body);
+
+  /* Returns true if the strided memory layout given by `shape` and `stride` is
+   * C-contiguous, i.e. its elements are adjacent in row-major order (the strides of
+   * dimensions of length one are ignored)
+   */
+  [[nodiscard]] bool is_contiguous(const shape &shape, const slice_data &stride) noexcept;
+
+  /* Returns true if the elements of the strided memory layout given by `shape` and
+   * `stride` can be addressed in the same (row-major) order through the shape `to`
+   * without moving them, in which case `result` is filled with the strides for `to`
+   *
+   * Precondition: `to.size()` must be equal to `shape.size()`, and `result` must have as
+   * many dimensions as `to` (like `slice_data::get_stride(to)`)
+   */
+  [[nodiscard]] bool reshape_stride(const shape &shape, const slice_data &stride,
+    const class shape &to, slice_data &result);
+
+  /* Decomposition of a strided memory layout into runs of equally spaced elements, after
+   * merging all adjacent dimensions which are laid out contiguously with respect to each
+   * other (a contiguous array is a single run)
+   */
+  class runs {
+  public:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    // Constructs the decomposition of the layout given by `shape` and `stride`
+    runs(const shape &shape, const slice_data &stride);
+
+    ////////////////////////////// GENERAL ///////////////////////////////
+
+    // Returns the total number of elements in the layout
+    [[nodiscard]] std::size_t size() const noexcept;
+
+    // Returns the distance (in elements) between consecutive elements of a run
+    [[nodiscard]] std::size_t step() const noexcept;
+
+    /* Calls `body(index, offset, n)` for every run of part `i` when all the elements are
+     * split into `parts` parts of (almost) equal size, where `index` is the position of
+     * the first element of the run in row-major order, `offset` is its distance (in
+     * elements) from the first element of the layout, and `n` is the length of the run
+     */
+    template<typename _Body>
+    void for_each(const unsigned parts, const unsigned i, _Body &&body) const;
+
+  private:
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    shape m_shape;
+    slice_data m_stride;
+
+  };  // class runs
+
+  /* Decomposition of two strided memory layouts of the same shape into pairs of runs,
+   * after merging all adjacent dimensions which are laid out contiguously in both
+   * layouts (two contiguous arrays are a single pair of runs)
+   */
+  class paired_runs {
+  public:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    // Constructs the decomposition of the layouts `stride_a` and `stride_b` of `shape`
+    paired_runs(
+      const shape &shape, const slice_data &stride_a, const slice_data &stride_b);
+
+    ////////////////////////////// GENERAL ///////////////////////////////
+
+    // Returns the total number of elements in either layout
+    [[nodiscard]] std::size_t size() const noexcept;
+
+    // Returns true if both layouts are contiguous (and hence a single pair of runs)
+    [[nodiscard]] bool contiguous() const noexcept;
+
+    // Returns the distance (in elements) between consecutive elements of a run in either
+    // layout
+    [[nodiscard]] std::size_t step_a() const noexcept;
+    [[nodiscard]] std::size_t step_b() const noexcept;
+
+    /* Calls `body(index, offset_a, offset_b, n)` for every run covering the elements in
+     * [begin, end) of row-major order, where `index` is the position of the first
+     * element of the run, `offset_a` and `offset_b` are its distances (in elements) from
+     * the first element of either layout, and `n` is the length of the run
+     */
+    template<typename _Body>
+    void for_each(const std::size_t begin, const std::size_t end, _Body &&body) const;
+
+  private:
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    shape m_shape;
+    slice_data m_stride_a, m_stride_b;
+
+  };  // class paired_runs
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+namespace devi::core::internal
+{
+  inline std::size_t row_count(const shape &shape) noexcept
+  {
+    const auto inner { shape[shape.ndims() - 1] };
+    return inner ? shape.size() / inner : 0;
+  }
+
+  template<typename _Body>
+  void for_each_row(const shape &shape, const slice_data &stride, const std::size_t begin,
+    const std::size_t end, _Body &&body)
+  {
+    if (begin >= end) return;
+
+    // multi-index (over all the outer dimensions) of the current row and its offset
+    const unsigned outer { shape.ndims() - 1 };
+    std::size_t index[16] {}, offset { 0 };
+    for (std::size_t d { outer }, rem { begin }; d--; rem /= shape[d]) {
+      index[d] = rem % shape[d];
+      offset += index[d] * stride[d];
+    }
+
+    for (auto row { begin }; row < end; ++row) {
+      body(row, offset);
+
+      // increment the multi-index with carry
+      for (auto d { outer }; d--;) {
+        offset += stride[d];
+        if (++index[d] < shape[d]) break;
+        offset -= index[d] * stride[d];
+        index[d] = 0;
+      }
+    }
+  }
+
+  inline bool is_contiguous(const shape &shape, const slice_data &stride) noexcept
+  {
+    std::size_t expected { 1 };
+    for (auto d { shape.ndims() }; d--;)
+      if (shape[d] != 1) {
+        if (stride[d] != expected) return false;
+        expected *= shape[d];
+      }
+    return true;
+  }
+
+  inline bool reshape_stride(const shape &shape, const slice_data &stride,
+    const class shape &to, slice_data &result)
+  {
+    if (shape.size() == 0) return true;
+
+    // dimensions of length one can have any stride, so they are left out
+    std::size_t dims[16], steps[16];
+    unsigned ndims { 0 };
+    for (unsigned d { 0 }; d < shape.ndims(); ++d)
+      if (shape[d] != 1) {
+        dims[ndims]    = shape[d];
+        steps[ndims++] = stride[d];
+      }
+
+    // match the smallest groups of old and new dimensions spanning the same elements,
+    // where every old group must be contiguous within itself
+    unsigned oi { 0 }, ni { 0 };
+    while (oi < ndims && ni < to.ndims()) {
+      unsigned oj { oi + 1 }, nj { ni + 1 };
+      std::size_t old_size { dims[oi] }, new_size { to[ni] };
+      while (old_size != new_size)
+        if (new_size < old_size) new_size *= to[nj++];
+        else old_size *= dims[oj++];
+
+      for (auto k { oi }; k + 1 < oj; ++k)
+        if (steps[k] != dims[k + 1] * steps[k + 1]) return false;
+
+      result[nj - 1] = steps[oj - 1];
+      for (auto k { nj - 1 }; k > ni; --k) result[k - 1] = result[k] * to[k];
+      oi = oj;
+      ni = nj;
+    }
+    // any remaining new dimensions have length one, so their strides do not matter
+    return true;
+  }
+
+  //////////////////////////////////// RUNS ////////////////////////////////////
+
+  inline runs::runs(const shape &shape, const slice_data &stride)
+    : m_shape { shape }, m_stride { stride }
+  {
+    // merging is skipped if zeros (which are used as markers below) are already present
+    for (unsigned d { 0 }; d < m_shape.ndims(); ++d)
+      if (m_shape[d] == 0 || m_stride[d] == 0) return;
+
+    for (auto d { m_shape.ndims() - 1 }; d--;)
+      if (m_stride[d] == m_stride[d + 1] * m_shape[d + 1]) {
+        m_shape[d] *= m_shape[d + 1];
+        m_stride[d]    = m_stride[d + 1];
+        m_shape[d + 1] = m_stride[d + 1] = 0;
+      }
+    m_shape.remove_zeros();
+    m_stride.remove_zeros();
+  }
+
+  inline std::size_t runs::size() const noexcept { return m_shape.size(); }
+
+  inline std::size_t runs::step() const noexcept { return m_stride[m_shape.ndims() - 1]; }
+
+  template<typename _Body>
+  void runs::for_each(const unsigned parts, const unsigned i, _Body &&body) const
+  {
+    const auto inner { m_shape[m_shape.ndims() - 1] };
+    if (m_shape.ndims() == 1) {  // split the only run itself
+      const auto [begin, end] { partition(inner, parts, i) };
+      if (begin < end) body(begin, begin * this->step(), end - begin);
+      return;
+    }
+
+    const auto [begin, end] { partition(row_count(m_shape), parts, i) };
+    for_each_row(m_shape, m_stride, begin, end,
+      [&](const std::size_t row, const std::size_t offset) {
+        body(row * inner, offset, inner);
+      });
+  }
+
+  ///////////////////////////////// PAIRED RUNS /////////////////////////////////
+
+  inline paired_runs::paired_runs(
+    const shape &shape, const slice_data &stride_a, const slice_data &stride_b)
+    : m_shape { shape }, m_stride_a { stride_a }, m_stride_b { stride_b }
+  {
+    // merging is skipped if zeros (which are used as markers below) are already present
+    for (unsigned d { 0 }; d < m_shape.ndims(); ++d)
+      if (m_shape[d] == 0 || m_stride_a[d] == 0 || m_stride_b[d] == 0) return;
+
+    for (auto d { m_shape.ndims() - 1 }; d--;)
+      if (m_stride_a[d] == m_stride_a[d + 1] * m_shape[d + 1]
+          && m_stride_b[d] == m_stride_b[d + 1] * m_shape[d + 1]) {
+        m_shape[d] *= m_shape[d + 1];
+        m_stride_a[d]  = m_stride_a[d + 1];
+        m_stride_b[d]  = m_stride_b[d + 1];
+        m_shape[d + 1] = m_stride_a[d + 1] = m_stride_b[d + 1] = 0;
+      }
+    m_shape.remove_zeros();
+    m_stride_a.remove_zeros();
+    m_stride_b.remove_zeros();
+  }
+
+  inline std::size_t paired_runs::size() const noexcept { return m_shape.size(); }
+
+  inline bool paired_runs::contiguous() const noexcept
+  {
+    return m_shape.ndims() == 1 && m_stride_a[0] == 1 && m_stride_b[0] == 1;
+  }
+
+  inline std::size_t paired_runs::step_a() const noexcept
+  {
+    return m_stride_a[m_shape.ndims() - 1];
+  }
+
+  inline std::size_t paired_runs::step_b() const noexcept
+  {
+    return m_stride_b[m_shape.ndims() - 1];
+  }
+
+  template<typename _Body>
+  void paired_runs::for_each(const std::size_t begin, const std::size_t end,
+    _Body &&body) const
+  {
+    const unsigned outer { m_shape.ndims() - 1 };
+    const auto inner { m_shape[outer] };
+    if (begin >= end || inner == 0) return;
+
+    // multi-index (over all the outer dimensions) of the first row and its offsets
+    std::size_t index[16] {}, offset_a { 0 }, offset_b { 0 };
+    for (std::size_t d { outer }, rem { begin / inner }; d--; rem /= m_shape[d]) {
+      index[d] = rem % m_shape[d];
+      offset_a += index[d] * m_stride_a[d];
+      offset_b += index[d] * m_stride_b[d];
+    }
+
+    const auto sa { this->step_a() }, sb { this->step_b() };
+    for (std::size_t i { begin }, col { begin % inner }; i < end; col = 0) {
+      const auto n { std::min(inner - col, end - i) };
+      body(i, offset_a + col * sa, offset_b + col * sb, n);
+      i += n;
+
+      // increment the multi-index with carry
+      for (auto d { outer }; d--;) {
+        offset_a += m_stride_a[d];
+        offset_b += m_stride_b[d];
+        if (++index[d] < m_shape[d]) break;
+        offset_a -= index[d] * m_stride_a[d];
+        offset_b -= index[d] * m_stride_b[d];
+        index[d] = 0;
+      }
+    }
+  }
+
+}  // namespace devi::core::internal
+
+#endif
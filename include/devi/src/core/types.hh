@@ -18,9 +18,11 @@
 #define _HEADER_GUARD__DEVI_SRC_CORE_TYPES_HH_
 
 #include "__header_check__"
+#include "half.hh"
 
 #include <climits>
 #include <cstdint>
+#include <type_traits>
 
 // Checking C++ floating point width
 // TODO: add automatic datatype adjustment in case of failure
@@ -44,6 +46,8 @@ namespace devi::core::internal
     uint32,
     uint64,
     // floating point numbers
+    float16,
+    bfloat16,
     float32,
     float64
   };
@@ -67,9 +71,115 @@ namespace devi::core::internal
   CORE2NATIVE(uint16, std::uint16_t);
   CORE2NATIVE(uint32, std::uint32_t);
   CORE2NATIVE(uint64, std::uint64_t);
+  CORE2NATIVE(float16, float16_t);
+  CORE2NATIVE(bfloat16, bfloat16_t);
   CORE2NATIVE(float32, float);
   CORE2NATIVE(float64, double);
 
+  /* Returns the datatype which both `a` and `b` are promoted to when they are combined in
+   * an element-wise operation, following the NumPy type promotion rules
+   *
+   * 1) `bool8` promotes to the other datatype
+   * 2) Datatypes of the same kind promote to the wider of the two (`float16` and
+   *    `bfloat16` promote to `float32`)
+   * 3) A signed and an unsigned integer promote to the smallest signed integer which can
+   *    hold both (`float64` when combined with `uint64`)
+   * 4) An integer and a floating point number promote to the smallest floating point
+   *    datatype which is atleast as wide as the float and represents every value of the
+   *    integer exactly (8-bit -> 16-bit, 16-bit -> 32-bit, wider -> 64-bit)
+   */
+  [[nodiscard]] constexpr type promote_types(const type a, const type b) noexcept;
+
+  // Compile-time result datatype of an element-wise operation on `_A` and `_B`
+  template<type _A, type _B>
+  inline constexpr type result_type { promote_types(_A, _B) };
+
+  /* Native C++ datatype in which arithmetic on `_Type` is carried out (`float` for the
+   * 16-bit floating point datatypes, `_Type` itself for every other datatype)
+   */
+  template<typename _Type>
+  using compute_type = std::conditional_t<is_half_v<_Type>, float, _Type>;
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    enum class kind { boolean, signed_int, unsigned_int, floating };
+
+    constexpr kind kind_of(const type t) noexcept
+    {
+      if (t == type::bool8) return kind::boolean;
+      if (t <= type::int64) return kind::signed_int;
+      if (t <= type::uint64) return kind::unsigned_int;
+      return kind::floating;
+    }
+
+    // Width (in bits) of every datatype
+    constexpr unsigned width_of(const type t) noexcept
+    {
+      switch (t) {
+      case type::bool8:
+      case type::int8:
+      case type::uint8: return 8;
+      case type::int16:
+      case type::uint16:
+      case type::float16:
+      case type::bfloat16: return 16;
+      case type::int32:
+      case type::uint32:
+      case type::float32: return 32;
+      default: return 64;
+      }
+    }
+
+    // Signed integer datatype of the given width
+    constexpr type signed_of(const unsigned width) noexcept
+    {
+      return width == 8 ? type::int8
+           : width == 16 ? type::int16
+           : width == 32 ? type::int32
+                         : type::int64;
+    }
+
+    // Smallest floating point datatype which represents every value of `integer` exactly
+    constexpr type float_holding(const type integer) noexcept
+    {
+      const auto width { width_of(integer) };
+      return width == 8 ? type::float16 : width == 16 ? type::float32 : type::float64;
+    }
+  }
+
+  constexpr type promote_types(const type a, const type b) noexcept
+  {
+    const auto ka { kind_of(a) }, kb { kind_of(b) };
+    const auto wa { width_of(a) }, wb { width_of(b) };
+
+    if (a == b || kb == kind::boolean) return a;
+    if (ka == kind::boolean) return b;
+
+    if (ka == kb) {
+      if (wa == wb) return type::float32;  // only `float16` and `bfloat16`
+      return wa > wb ? a : b;
+    }
+
+    if (ka == kind::floating || kb == kind::floating) {
+      const auto f { ka == kind::floating ? a : b };
+      const auto i { float_holding(ka == kind::floating ? b : a) };
+      return width_of(i) <= width_of(f) ? f : i;
+    }
+
+    // one signed and one unsigned integer
+    const auto ws { ka == kind::signed_int ? wa : wb };
+    const auto wu { ka == kind::unsigned_int ? wa : wb };
+    if (ws > wu) return signed_of(ws);
+    return wu == 64 ? type::float64 : signed_of(2 * wu);
+  }
+
 }  // namespace devi::core::internal
 
 #endif
@@ -19,12 +19,17 @@
 
 #include "__header_check__"
 #include "dimension/index.hh"
+#include "strided.hh"
 #include "types.hh"
 
+#include <memory>
+
 namespace devi::core::internal
 {
   template<type _DType>
   class array;  // to avoid recursive include error
+  template<type _To, type _From>
+  class cast_view;  // to avoid recursive include error
 
   template<type _DType>
   class view {
@@ -70,19 +75,60 @@ namespace devi::core::internal
     // Returns the `devi::core::type` of the view
     [[nodiscard]] enum type type() const noexcept;
 
+    // Returns a pointer to the first element of the view
+    [[nodiscard]] native_type *data() noexcept;
+    [[nodiscard]] const native_type *data() const noexcept;
+
+    // Returns the distance (in elements) between consecutive indices of every dimension
+    [[nodiscard]] const slice_data &stride() const noexcept;
+
+    // Returns true if the elements of the view are adjacent in row-major order
+    [[nodiscard]] bool is_contiguous() const noexcept;
+
+    /* Returns true if the view owns a copy of its elements, which only happens when
+     * `reshape` could not address the original elements with the new shape
+     */
+    [[nodiscard]] bool owns_data() const noexcept;
+
+    ////////////////////////////// CREATION //////////////////////////////
+
+    /* Returns a view of the same elements (in row-major order) with the specified shape,
+     * which shares the memory of the current view whenever its strides allow it (always
+     * for contiguous views), and otherwise owns a contiguous copy of the elements
+     *
+     * Errors:
+     * 1) `std::invalid_argument` if the size of the new shape is not equal to view's size
+     * 2) `new` can throw an `std::bad_alloc` exception
+     */
+    template<typename... _Args>
+    [[nodiscard]] view reshape(const _Args... args);
+    [[nodiscard]] view reshape(const class shape &s);
+
+    // Returns a one-dimensional view of the same elements (as described by `reshape`)
+    [[nodiscard]] view flatten();
+
+    /* Returns a read-only window which reads the elements of the view as `_AsType`, each
+     * one converted only when it is accessed (no converted copy is ever made)
+     */
+    template<enum type _AsType>
+    [[nodiscard]] cast_view<_AsType, _DType> as() const;
+
   private:
     //////////////////////////// CONSTRUCTORS ////////////////////////////
 
-    // Direct value constructor
+    // Direct value constructor, where `storage` is the memory owned by the view (if any)
     view(native_type *const source, const class shape &shape, const std::size_t start,
-      const slice_data &stride);
+      const slice_data &stride, std::shared_ptr<native_type[]> storage = nullptr);
 
     ///////////////////////////// ATTRIBUTES /////////////////////////////
 
     const iterator p_iter;
     class shape m_shape;
+    std::shared_ptr<native_type[]> p_storage;  // only set for copies made by `reshape`
+    bool m_contiguous;
 
     friend class array<_DType>;  // for access to constructor
+    friend struct view_access;   // for access to constructor
 
     ////////////////////////////// ITERATOR //////////////////////////////
 
@@ -108,6 +154,22 @@ namespace devi::core::internal
 
   };  // class view
 
+  /* Constructs views of arbitrary layouts for the functions of the library which return
+   * windows that cannot be expressed by slicing (like `split`)
+   */
+  struct view_access {
+    /* Returns a view of the specified `shape` and `stride` into the memory of `source`,
+     * starting `offset` elements after its first element (and sharing ownership of the
+     * copy made by `view::reshape`, if any)
+     */
+    template<type _DType>
+    [[nodiscard]] static view<_DType> window(view<_DType> &source,
+      const class shape &shape, const std::size_t offset, const slice_data &stride);
+    template<type _DType>
+    [[nodiscard]] static view<_DType> window(array<_DType> &source,
+      const class shape &shape, const std::size_t offset, const slice_data &stride);
+  };
+
 }  // namespace devi::core::internal
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -119,9 +181,14 @@ namespace devi::core::internal
 
   template<type _DType>
   view<_DType>::view(native_type *const source, const class shape &shape,
-    const std::size_t start, const slice_data &stride)
-    : p_iter { source, shape, start, stride }, m_shape { shape }
-  { }
+    const std::size_t start, const slice_data &stride,
+    std::shared_ptr<native_type[]> storage)
+    : p_iter { source, shape, start, stride }, m_shape { shape },
+      p_storage { std::move(storage) },
+      m_contiguous { internal::is_contiguous(shape, stride) }
+  {
+    DEVI_PROFILE_ALLOCATION(view, 0);
+  }
 
   ///////////////////////// OPERATOR OVERLOADS /////////////////////////
 
@@ -185,6 +252,107 @@ namespace devi::core::internal
     return _DType;
   }
 
+  template<type _DType>
+  typename view<_DType>::native_type *view<_DType>::data() noexcept
+  {
+    return p_iter.p_source + p_iter.m_start;
+  }
+
+  template<type _DType>
+  const typename view<_DType>::native_type *view<_DType>::data() const noexcept
+  {
+    return p_iter.p_source + p_iter.m_start;
+  }
+
+  template<type _DType>
+  const slice_data &view<_DType>::stride() const noexcept
+  {
+    return p_iter.m_stride;
+  }
+
+  template<type _DType>
+  bool view<_DType>::is_contiguous() const noexcept
+  {
+    return m_contiguous;
+  }
+
+  template<type _DType>
+  bool view<_DType>::owns_data() const noexcept
+  {
+    return p_storage != nullptr;
+  }
+
+  ////////////////////////////// CREATION //////////////////////////////
+
+  template<type _DType>
+  template<typename... _Args>
+  view<_DType> view<_DType>::reshape(const _Args... args)
+  {
+    return this->reshape(core::internal::shape { args... });
+  }
+
+  template<type _DType>
+  view<_DType> view<_DType>::reshape(const class shape &s)
+  {
+    if (s.size() != m_shape.size())
+      throw std::invalid_argument { "Reshape: size of the view must not change" };
+
+    auto new_stride { slice_data::get_stride(s) };
+    if (reshape_stride(m_shape, p_iter.m_stride, s, new_stride))
+      return { p_iter.p_source, s, p_iter.m_start, new_stride, p_storage };
+
+    // the elements cannot be addressed with the new shape, so they are gathered
+    const auto n { m_shape.size() };
+    std::shared_ptr<native_type[]> storage { new native_type[n] };
+    DEVI_PROFILE_ALLOCATION(view, n * sizeof(native_type));
+
+    const runs runs { m_shape, p_iter.m_stride };
+    const auto step { runs.step() };
+    const auto *const src { this->data() };
+    auto *const dst { storage.get() };
+    const auto parts { partition_count(n, 1UL << 15) };
+    thread_pool::instance().run(parts, [&](const unsigned i) {
+      runs.for_each(parts, i,
+        [&](const std::size_t index, const std::size_t offset, const std::size_t count) {
+          for (std::size_t j { 0 }; j < count; ++j)
+            dst[index + j] = src[offset + j * step];
+        });
+    });
+
+    auto *const source { storage.get() };
+    return { source, s, 0, slice_data::get_stride(s), std::move(storage) };
+  }
+
+  template<type _DType>
+  view<_DType> view<_DType>::flatten()
+  {
+    return this->reshape(m_shape.size());
+  }
+
+  template<type _DType>
+  template<type _AsType>
+  cast_view<_AsType, _DType> view<_DType>::as() const
+  {
+    return cast_view<_AsType, _DType> { *this };
+  }
+
+  //////////////////////////// VIEW ACCESS /////////////////////////////
+
+  template<type _DType>
+  view<_DType> view_access::window(view<_DType> &source, const class shape &shape,
+    const std::size_t offset, const slice_data &stride)
+  {
+    const auto &iter { source.p_iter };
+    return { iter.p_source, shape, iter.m_start + offset, stride, source.p_storage };
+  }
+
+  template<type _DType>
+  view<_DType> view_access::window(array<_DType> &source, const class shape &shape,
+    const std::size_t offset, const slice_data &stride)
+  {
+    return { source.data(), shape, offset, stride };
+  }
+
   ////////////////////////////// ITERATOR //////////////////////////////
 
   template<type _DType>
@@ -0,0 +1,288 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_CORE_WINDOW_HH_
+#define _HEADER_GUARD__DEVI_SRC_CORE_WINDOW_HH_
+
+#include "__header_check__"
+#include "array.hh"
+#include "gemm.hh"
+
+#include <vector>
+
+namespace devi::core::internal
+{
+  /* Returns a view of all the windows of shape `window` in `source`, taken `steps[d]`
+   * positions apart along every dimension `d` (one position apart if `steps` is empty),
+   * without copying any element
+   *
+   * The view has twice the dimensionality of `source`: the first half indexes the
+   * position of a window, with `(source[d] - window[d]) / steps[d] + 1` positions along
+   * every dimension, and the second half indexes the elements inside a window. Both
+   * halves reuse the strides of `source`, so overlapping windows share their elements.
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `window` (or a non-empty `steps`) does not have the
+   *    dimensionality of `source`, or if the view would have more than 10 dimensions
+   * 2) `std::invalid_argument` if a dimension of `window` is zero or larger than the
+   *    same dimension of `source`, or if a step is zero
+   */
+  template<type _DType>
+  [[nodiscard]] view<_DType> sliding_window_view(view<_DType> &source,
+    const shape &window, const std::vector<std::size_t> &steps = {});
+  template<type _DType>
+  [[nodiscard]] view<_DType> sliding_window_view(array<_DType> &source,
+    const shape &window, const std::vector<std::size_t> &steps = {});
+
+  /* Returns the reduction of every window of `windows` (a view returned by
+   * `sliding_window_view`, whose second half of dimensions is reduced) by folding its
+   * elements into `init` with `op(accumulator, element)`, e.g. `std::plus` for sums or
+   * the maximum for max-pooling, without copying any window
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `windows` does not have an even dimensionality
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType, typename _Op>
+  [[nodiscard]] array<_DType> reduce_windows(const view<_DType> &windows,
+    const typename native_type<_DType>::type init, _Op &&op);
+
+  /* Returns the product of every window of `windows` (a view returned by
+   * `sliding_window_view`), flattened in row-major order to K elements, with `weight` of
+   * shape (K, N), i.e. the result has the shape of the window positions followed by N
+   *
+   * Windows are gathered into cache-sized blocks of rows right before being multiplied,
+   * instead of being copied all at once (im2col), and a view of contiguous windows along
+   * a single dimension (like the windows of a signal) is multiplied in place
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `windows` does not have an even dimensionality, or if
+   *    `weight` is not of shape (K, N)
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<type::float32> window_matmul(
+    const view<_DType> &windows, const array<type::float32> &weight);
+
+}  // namespace devi::core::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace devi::core::internal
+{
+  namespace  // for internal linkage
+  {
+    // Returns the shape of all the windows of `window` in `s`
+    inline shape windows_shape(
+      const shape &s, const shape &window, const std::vector<std::size_t> &steps)
+    {
+      const auto n { s.ndims() };
+      if (window.ndims() != n || (!steps.empty() && steps.size() != n) || 2 * n > 10)
+        throw std::invalid_argument { "Windows: dimensionality of window is invalid" };
+
+      std::size_t dims[10];
+      for (unsigned d { 0 }; d < n; ++d) {
+        const auto step { steps.empty() ? 1 : steps[d] };
+        if (window[d] == 0 || window[d] > s[d] || step == 0)
+          throw std::invalid_argument { "Windows: window does not fit in the source" };
+        dims[d]     = (s[d] - window[d]) / step + 1;
+        dims[n + d] = window[d];
+      }
+      return shape::from_dims(dims, 2 * n);
+    }
+
+    // Returns the strides of all the windows in the layout `stride`
+    inline slice_data windows_stride(const shape &windows, const slice_data &stride,
+      const std::vector<std::size_t> &steps)
+    {
+      const auto n { stride.ndims() };
+      auto ret { slice_data::get_stride(windows) };
+      for (unsigned d { 0 }; d < n; ++d) {
+        ret[d]     = stride[d] * (steps.empty() ? 1 : steps[d]);
+        ret[n + d] = stride[d];
+      }
+      return ret;
+    }
+
+    // Positions and elements of the windows of a view returned by `sliding_window_view`
+    struct window_halves {
+      // positions with a trailing dimension of length one, to be walked by `for_each_row`
+      shape m_positions;
+      slice_data m_position_stride;
+      shape m_window;
+      slice_data m_window_stride;
+
+      window_halves(const shape &s, const slice_data &stride);
+      [[nodiscard]] static shape half(const shape &s, const unsigned first);
+    };
+
+    inline window_halves::window_halves(const shape &s, const slice_data &stride)
+      : m_positions { half(s, 0) },
+        m_position_stride { slice_data::get_stride(m_positions) },
+        m_window { half(s, s.ndims() / 2) },
+        m_window_stride { slice_data::get_stride(m_window) }
+    {
+      const unsigned n { m_window.ndims() };
+      for (unsigned d { 0 }; d < n; ++d) {
+        m_position_stride[d] = stride[d];
+        m_window_stride[d]   = stride[n + d];
+      }
+    }
+
+    // Returns the second half of the dimensions of `s` if `first` is not zero, and
+    // otherwise the first half followed by a dimension of length one
+    inline shape window_halves::half(const shape &s, const unsigned first)
+    {
+      if (s.ndims() % 2)
+        throw std::invalid_argument { "Windows: dimensionality must be even" };
+
+      const unsigned n { s.ndims() / 2 };
+      std::size_t dims[10];
+      for (unsigned d { 0 }; d < n; ++d) dims[d] = s[first + d];
+      dims[n] = 1;
+      return shape::from_dims(dims, first ? n : n + 1);
+    }
+
+    // Returns the offsets of the elements of a window from its first element, in
+    // row-major order, so that every window is read without any index arithmetic
+    inline std::vector<std::size_t> window_taps(const window_halves &halves)
+    {
+      const runs patch { halves.m_window, halves.m_window_stride };
+      const auto step { patch.step() };
+      std::vector<std::size_t> ret(patch.size());
+      patch.for_each(1, 0,
+        [&](const std::size_t index, const std::size_t offset, const std::size_t n) {
+          for (std::size_t k { 0 }; k < n; ++k) ret[index + k] = offset + k * step;
+        });
+      return ret;
+    }
+  }
+
+  template<type _DType>
+  view<_DType> sliding_window_view(
+    view<_DType> &source, const shape &window, const std::vector<std::size_t> &steps)
+  {
+    const auto s { windows_shape(source.shape(), window, steps) };
+    return view_access::window(source, s, 0, windows_stride(s, source.stride(), steps));
+  }
+
+  template<type _DType>
+  view<_DType> sliding_window_view(
+    array<_DType> &source, const shape &window, const std::vector<std::size_t> &steps)
+  {
+    const auto s { windows_shape(source.shape(), window, steps) };
+    return view_access::window(source, s, 0, windows_stride(s, source.stride(), steps));
+  }
+
+  template<type _DType, typename _Op>
+  array<_DType> reduce_windows(const view<_DType> &windows,
+    const typename native_type<_DType>::type init, _Op &&op)
+  {
+    DEVI_PROFILE_SCOPE("core::reduce_windows");
+    const window_halves halves { windows.shape(), windows.stride() };
+    const auto n { halves.m_window.ndims() };
+    std::size_t dims[5];
+    for (unsigned d { 0 }; d < n; ++d) dims[d] = windows.shape()[d];
+    array<_DType> ret { shape::from_dims(dims, n) };
+
+    const auto taps { window_taps(halves) };
+    const auto K { taps.size() };
+    const auto *const data { windows.data() };
+    auto *const out { ret.data() };
+    parallel_for(
+      ret.size(),
+      [&](const std::size_t begin, const std::size_t end) {
+        for_each_row(halves.m_positions, halves.m_position_stride, begin, end,
+          [&](const std::size_t position, const std::size_t offset) {
+            const auto *const in { data + offset };
+            auto acc { init };
+            for (std::size_t k { 0 }; k < K; ++k) acc = op(acc, in[taps[k]]);
+            out[position] = acc;
+          });
+      },
+      (1UL << 15) / std::max<std::size_t>(K, 1) + 1);
+    return ret;
+  }
+
+  template<type _DType>
+  array<type::float32> window_matmul(
+    const view<_DType> &windows, const array<type::float32> &weight)
+  {
+    DEVI_PROFILE_SCOPE("core::window_matmul");
+    using element = typename native_type<_DType>::type;
+    const window_halves halves { windows.shape(), windows.stride() };
+    const std::size_t K { halves.m_window.size() };
+    if (weight.ndims() != 2 || weight.shape()[0] != K)
+      throw std::invalid_argument { "Windows: weight must be of shape (K, N)" };
+
+    const std::size_t N { weight.shape()[1] };
+    std::size_t dims[6];
+    const auto n { halves.m_window.ndims() };
+    for (unsigned d { 0 }; d < n; ++d) dims[d] = windows.shape()[d];
+    dims[n] = N;
+    array<type::float32> ret { shape::from_dims(dims, n + 1) };
+    const std::size_t P { ret.size() / std::max<std::size_t>(N, 1) };
+    if (ret.size() == 0) return ret;
+
+    const auto *const data { windows.data() };
+    const float *const B { weight.data() };
+    float *const C { ret.data() };
+
+    // windows of adjacent elements along a single dimension are already rows of a matrix
+    if (n == 1 && halves.m_window_stride[0] == 1) {
+      const auto lda { halves.m_position_stride[0] };
+      parallel_for(
+        P,
+        [&](const std::size_t begin, const std::size_t end) {
+          gemm(end - begin, N, K, data + begin * lda, lda, B, N, C + begin * N, N);
+        },
+        GEMM_MC);
+      return ret;
+    }
+
+    const auto taps { window_taps(halves) };
+    parallel_for(
+      P,
+      [&](const std::size_t begin, const std::size_t end) {
+        const auto rows { std::min(GEMM_MC, end - begin) };
+        std::vector<element> block(rows * K);
+        DEVI_PROFILE_ALLOCATION(workspace, block.size() * sizeof(element));
+
+        std::size_t first { begin }, m { 0 };
+        for_each_row(halves.m_positions, halves.m_position_stride, begin, end,
+          [&](const std::size_t, const std::size_t offset) {
+            const auto *const in { data + offset };
+            auto *const row { block.data() + m * K };
+            for (std::size_t k { 0 }; k < K; ++k) row[k] = in[taps[k]];
+            if (++m == rows) {
+              gemm(m, N, K, block.data(), K, B, N, C + first * N, N);
+              first += m;
+              m = 0;
+            }
+          });
+        if (m) gemm(m, N, K, block.data(), K, B, N, C + first * N, N);
+      },
+      GEMM_MC);
+    return ret;
+  }
+
+}  // namespace devi::core::internal
+
+#endif
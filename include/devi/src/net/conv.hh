@@ -0,0 +1,351 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_NET_CONV_HH_
+#define _HEADER_GUARD__DEVI_SRC_NET_CONV_HH_
+
+#include "../core/array.hh"
+#include "../core/gemm.hh"
+#include "../core/parallel.hh"
+#include "__header_check__"
+
+namespace devi::net::internal
+{
+  using core::internal::array;
+  using core::internal::shape;
+  using core::internal::type;
+
+  // Pair of (vertical, horizontal) hyperparameters of a 2D sliding window
+  struct size2d {
+    std::size_t m_y, m_x;
+
+    // Same value along both dimensions
+    size2d(const std::size_t yx);
+    // Direct value initialization constructor
+    size2d(const std::size_t y, const std::size_t x);
+  };
+
+  // 2D convolution layer over batched (N, C, H, W) float32 tensors
+  class conv2d {
+  public:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    /* Constructs a convolution layer having the filters `weight` of shape
+     * (O, C / groups, KH, KW), and an optional `bias` of shape (O)
+     *
+     * Errors:
+     * 1) `std::invalid_argument` if `weight` is not 4-dimensional, or if a non-empty
+     *    `bias` is not of shape (O)
+     * 2) `std::invalid_argument` if `stride`, `dilation` or `groups` is zero, or if O is
+     *    not a multiple of `groups`
+     */
+    conv2d(array<type::float32> weight, const size2d stride = 1,
+      const size2d padding = 0, const size2d dilation = 1, const std::size_t groups = 1);
+    conv2d(array<type::float32> weight, array<type::float32> bias,
+      const size2d stride = 1, const size2d padding = 0, const size2d dilation = 1,
+      const std::size_t groups = 1);
+
+    ////////////////////////////// GENERAL ///////////////////////////////
+
+    /* Returns the shape of the output for an input of shape `input`
+     *
+     * Errors:
+     * `std::invalid_argument` if `input` is not of shape (N, C, H, W) with C matching the
+     * layer, or if the padded input is smaller than the dilated filter
+     */
+    [[nodiscard]] shape output_shape(const shape &input) const;
+
+    /* Returns the result of convolving the batch `input` with the layer's filters
+     *
+     * Errors:
+     * 1) all the errors listed for `output_shape`
+     * 2) `new` can throw an `std::bad_alloc` exception
+     */
+    [[nodiscard]] array<type::float32> forward(const array<type::float32> &input) const;
+
+    /* Same as above, but writes the result into the preallocated `output`
+     *
+     * Errors:
+     * 1) all the errors listed for `output_shape`
+     * 2) `std::invalid_argument` if `output` is not of the shape given by `output_shape`
+     */
+    void forward(const array<type::float32> &input, array<type::float32> &output) const;
+
+  private:
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    array<type::float32> m_weight, m_bias;
+    size2d m_stride, m_padding, m_dilation;
+    std::size_t m_groups;
+
+  };  // class conv2d
+
+}  // namespace devi::net::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <vector>
+
+namespace devi::net::internal
+{
+  inline size2d::size2d(const std::size_t yx) : m_y { yx }, m_x { yx } { }
+
+  inline size2d::size2d(const std::size_t y, const std::size_t x) : m_y { y }, m_x { x }
+  { }
+
+  // Geometry of a 2D convolution over a single plane
+  struct conv_geometry {
+    std::size_t m_height, m_width, m_out_height, m_out_width, m_kernel_y, m_kernel_x;
+    size2d m_stride, m_padding, m_dilation;
+
+    // Returns the horizontal input offset of filter tap `kx` for output column 0
+    std::ptrdiff_t offset(const std::size_t kx) const noexcept
+    {
+      return std::ptrdiff_t(kx * m_dilation.m_x) - std::ptrdiff_t(m_padding.m_x);
+    }
+
+    // Returns the vertical input position of filter tap `ky` for output row `oy`
+    std::ptrdiff_t input_row(const std::size_t oy, const std::size_t ky) const noexcept
+    {
+      return std::ptrdiff_t(oy * m_stride.m_y + ky * m_dilation.m_y)
+           - std::ptrdiff_t(m_padding.m_y);
+    }
+
+    /* Returns the range [lo, hi) of output columns whose filter tap at horizontal
+     * position `kx` falls inside the input row
+     */
+    std::pair<std::size_t, std::size_t> valid_columns(
+      const std::size_t kx) const noexcept
+    {
+      const auto off { this->offset(kx) };
+      const auto sx { std::ptrdiff_t(m_stride.m_x) }, W { std::ptrdiff_t(m_width) };
+      const std::ptrdiff_t lo { off < 0 ? (-off + sx - 1) / sx : 0 };
+      const std::ptrdiff_t hi { W > off ? (W - off + sx - 1) / sx : 0 };
+      return { std::size_t(lo), std::min(std::size_t(std::max(hi, lo)), m_out_width) };
+    }
+  };
+
+  /* Validates the filters of shape `weight`, the (possibly empty) bias of shape `bias`
+   * and the hyperparameters of a convolution layer
+   */
+  inline void check_conv(const shape &weight, const shape &bias, const size2d stride,
+    const size2d dilation, const std::size_t groups)
+  {
+    if (weight.ndims() != 4)
+      throw std::invalid_argument { "Conv2D: `weight` must be of shape (O, C, KH, KW)" };
+    if (bias.size() && bias != shape(weight[0]))
+      throw std::invalid_argument { "Conv2D: `bias` must be of shape (O)" };
+    if (!stride.m_y || !stride.m_x || !dilation.m_y || !dilation.m_x || !groups
+        || weight[0] % groups)
+      throw std::invalid_argument {
+        "Conv2D: `stride`, `dilation` and `groups` must be non-zero, and `groups` must "
+        "divide the number of filters"
+      };
+  }
+
+  // Returns the output shape of convolving `input` with filters of shape `weight`
+  inline shape conv_output_shape(const shape &input, const shape &weight,
+    const size2d stride, const size2d padding, const size2d dilation,
+    const std::size_t groups)
+  {
+    if (input.ndims() != 4 || input[1] != weight[1] * groups)
+      throw std::invalid_argument {
+        "Conv2D: input must be of shape (N, C, H, W) with C matching the layer"
+      };
+
+    const auto extent { [](const std::size_t n, const std::size_t pad,
+                          const std::size_t k, const std::size_t dilation,
+                          const std::size_t stride) {
+      const auto span { dilation * (k - 1) + 1 };
+      if (n + 2 * pad < span)
+        throw std::invalid_argument { "Conv2D: padded input is smaller than the filter" };
+      return (n + 2 * pad - span) / stride + 1;
+    } };
+
+    return { input[0], weight[0],
+      extent(input[2], padding.m_y, weight[2], dilation.m_y, stride.m_y),
+      extent(input[3], padding.m_x, weight[3], dilation.m_x, stride.m_x) };
+  }
+
+  namespace  // for internal linkage
+  {
+    /* Fills `col` with the (K x n) im2col tile of output pixels [p0, p0 + n) of a single
+     * group, where K = `channels` * KY * KX, after offsetting every input by `zero` (the
+     * padding is filled with zeros, i.e. the inputs equal to `zero`)
+     */
+    template<typename _Type, typename _Col>
+    void im2col(const _Type *const in, const std::size_t channels, const conv_geometry &g,
+      const std::size_t p0, const std::size_t n, _Col *col, const _Col zero) noexcept
+    {
+      const std::size_t H { g.m_height }, W { g.m_width }, OW { g.m_out_width };
+      for (std::size_t c { 0 }; c < channels; ++c)
+        for (std::size_t ky { 0 }; ky < g.m_kernel_y; ++ky)
+          for (std::size_t kx { 0 }; kx < g.m_kernel_x; ++kx, col += n) {
+            const auto [lo, hi] { g.valid_columns(kx) };
+            const auto off { g.offset(kx) };
+            const auto sx { std::ptrdiff_t(g.m_stride.m_x) };
+
+            // walk the tile one output row segment at a time
+            for (std::size_t p { p0 }; p < p0 + n;) {
+              const std::size_t oy { p / OW }, ox0 { p % OW };
+              const std::size_t ox1 { std::min(OW, ox0 + (p0 + n - p)) };
+              _Col *const out { col + (p - p0) };
+              const auto iy { g.input_row(oy, ky) };
+
+              if (iy < 0 || iy >= std::ptrdiff_t(H))
+                std::fill_n(out, ox1 - ox0, _Col { 0 });
+              else {
+                const _Type *const row { in + (c * H + iy) * W };
+                for (auto ox { ox0 }; ox < ox1; ++ox)
+                  out[ox - ox0] = ox >= lo && ox < hi
+                    ? _Col(_Col(row[std::ptrdiff_t(ox) * sx + off]) - zero) : _Col { 0 };
+              }
+              p += ox1 - ox0;
+            }
+          }
+    }
+
+    // Direct convolution of a single input plane with a single filter into `out`
+    inline void depthwise(const float *const in, const float *const filter,
+      const float bias, const conv_geometry &g, float *const out) noexcept
+    {
+      const std::size_t H { g.m_height }, W { g.m_width }, OW { g.m_out_width };
+      for (std::size_t oy { 0 }; oy < g.m_out_height; ++oy) {
+        float *const row_out { out + oy * OW };
+        std::fill_n(row_out, OW, bias);
+
+        for (std::size_t ky { 0 }; ky < g.m_kernel_y; ++ky) {
+          const auto iy { g.input_row(oy, ky) };
+          if (iy < 0 || iy >= std::ptrdiff_t(H)) continue;
+          const float *const row_in { in + iy * W };
+
+          for (std::size_t kx { 0 }; kx < g.m_kernel_x; ++kx) {
+            const float w { filter[ky * g.m_kernel_x + kx] };
+            const auto [lo, hi] { g.valid_columns(kx) };
+            if (lo >= hi) continue;
+
+            // input of output column `lo`, after which the tap stays inside the row
+            const std::size_t sx { g.m_stride.m_x }, n { hi - lo };
+            const float *const in_lo { row_in + std::ptrdiff_t(lo * sx) + g.offset(kx) };
+            float *const out_lo { row_out + lo };
+            if (sx == 1)
+              for (std::size_t i { 0 }; i < n; ++i) out_lo[i] += w * in_lo[i];
+            else
+              for (std::size_t i { 0 }; i < n; ++i) out_lo[i] += w * in_lo[i * sx];
+          }
+        }
+      }
+    }
+  }
+
+  //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+  inline conv2d::conv2d(array<type::float32> weight, const size2d stride,
+    const size2d padding, const size2d dilation, const std::size_t groups)
+    : conv2d { std::move(weight), array<type::float32> { shape(0) }, stride, padding,
+        dilation, groups }
+  { }
+
+  inline conv2d::conv2d(array<type::float32> weight, array<type::float32> bias,
+    const size2d stride, const size2d padding, const size2d dilation,
+    const std::size_t groups)
+    : m_weight { std::move(weight) }, m_bias { std::move(bias) }, m_stride { stride },
+      m_padding { padding }, m_dilation { dilation }, m_groups { groups }
+  {
+    check_conv(m_weight.shape(), m_bias.shape(), stride, dilation, groups);
+  }
+
+  ////////////////////////////// GENERAL ///////////////////////////////
+
+  inline shape conv2d::output_shape(const shape &input) const
+  {
+    return conv_output_shape(
+      input, m_weight.shape(), m_stride, m_padding, m_dilation, m_groups);
+  }
+
+  inline array<type::float32> conv2d::forward(const array<type::float32> &input) const
+  {
+    array<type::float32> output { this->output_shape(input.shape()) };
+    this->forward(input, output);
+    return output;
+  }
+
+  inline void conv2d::forward(
+    const array<type::float32> &input, array<type::float32> &output) const
+  {
+    DEVI_PROFILE_SCOPE("net::conv2d");
+    if (output.shape() != this->output_shape(input.shape()))
+      throw std::invalid_argument { "Conv2D: output is not of the expected shape" };
+
+    const auto &s { input.shape() }, &w { m_weight.shape() }, &o { output.shape() };
+    const conv_geometry g { s[2], s[3], o[2], o[3], w[2], w[3], m_stride, m_padding,
+      m_dilation };
+    const std::size_t N { s[0] }, C { s[1] }, O { w[0] }, HW { s[2] * s[3] };
+    const std::size_t Cg { C / m_groups }, Og { O / m_groups }, P { o[2] * o[3] };
+    const std::size_t K { Cg * w[2] * w[3] };
+
+    const float *const in { input.data() }, *const weight { m_weight.data() };
+    const float *const bias { m_bias.size() ? m_bias.data() : nullptr };
+    float *const out { output.data() };
+    using core::internal::gemm, core::internal::parallel_for;
+
+    // direct path for depthwise convolutions
+    if (Cg == 1 && m_groups == C) {
+      parallel_for(N * O, [&](const std::size_t begin, const std::size_t end) {
+        for (auto t { begin }; t < end; ++t) {
+          const std::size_t n { t / O }, oc { t % O }, ic { oc / Og };
+          const float b { bias ? bias[oc] : 0.0F };
+          depthwise(in + (n * C + ic) * HW, weight + oc * K, b, g, out + t * P);
+        }
+      });
+      return;
+    }
+
+    // implicit GEMM over tiles of output pixels, bounding the im2col workspace to ~1MB
+    const bool pointwise { w[2] == 1 && w[3] == 1 && m_stride.m_y == 1
+                           && m_stride.m_x == 1 && !m_padding.m_y && !m_padding.m_x };
+    const std::size_t NR { core::internal::GEMM_NR }, budget { (1UL << 18) / K };
+    const auto tile { std::min(P, std::max(4 * NR, budget / NR * NR)) };
+    const std::size_t tiles { (P + tile - 1) / tile }, tasks { N * m_groups * tiles };
+
+    parallel_for(tasks, [&](const std::size_t begin, const std::size_t end) {
+      std::vector<float> col(pointwise ? 0 : K * tile);
+      DEVI_PROFILE_ALLOCATION(workspace, col.size() * sizeof(float));
+      for (auto t { begin }; t < end; ++t) {
+        const std::size_t n { t / (m_groups * tiles) }, grp { t / tiles % m_groups };
+        const std::size_t p0 { t % tiles * tile }, np { std::min(tile, P - p0) };
+        const float *const src { in + (n * C + grp * Cg) * HW };
+        float *const dst { out + (n * O + grp * Og) * P + p0 };
+
+        const float *const filters { weight + grp * Og * K };
+        if (pointwise)
+          gemm(Og, np, K, filters, K, src + p0, HW, dst, P);
+        else {
+          im2col(src, Cg, g, p0, np, col.data(), 0.0F);
+          gemm(Og, np, K, filters, K, col.data(), np, dst, P);
+        }
+
+        if (bias)
+          for (std::size_t oc { 0 }; oc < Og; ++oc)
+            for (std::size_t p { 0 }; p < np; ++p) dst[oc * P + p] += bias[grp * Og + oc];
+      }
+    });
+  }
+
+}  // namespace devi::net::internal
+
+#endif
@@ -0,0 +1,538 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_NET_QUANTIZED_HH_
+#define _HEADER_GUARD__DEVI_SRC_NET_QUANTIZED_HH_
+
+#include "__header_check__"
+#include "conv.hh"
+
+#include <vector>
+
+namespace devi::net::internal
+{
+  /* Quantized tensor of 8-bit integers `q` representing the real values
+   * `scale * (q - zero_point)`, with either a single (scale, zero point) pair for the
+   * whole tensor, or one pair for every channel along a given axis
+   */
+  template<type _DType>
+  class quantized {
+    static_assert(_DType == type::int8 || _DType == type::uint8,
+      "Quantized tensors must be of type int8 or uint8");
+
+  public:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    /* Constructs a tensor quantized per-tensor with `scale` and `zero_point`
+     *
+     * Errors:
+     * `std::invalid_argument` if `scale` is not positive, or `zero_point` is not
+     * representable in the datatype
+     */
+    quantized(array<_DType> values, const float scale, const std::int32_t zero_point = 0);
+
+    /* Constructs a tensor quantized per-channel along `axis`, where channel `c` uses
+     * `scales[c]` and `zero_points[c]`
+     *
+     * Errors:
+     * 1) `std::invalid_argument` if `axis` is out of bounds of the values' shape, or
+     *    the number of scales or zero points is not equal to the number of channels
+     * 2) `std::invalid_argument` if any scale is not positive, or any zero point is not
+     *    representable in the datatype
+     */
+    quantized(array<_DType> values, std::vector<float> scales,
+      std::vector<std::int32_t> zero_points, const unsigned axis);
+
+    ////////////////////////////// GETTERS ///////////////////////////////
+
+    // Returns the quantized integer values
+    [[nodiscard]] const array<_DType> &values() const noexcept;
+    [[nodiscard]] array<_DType> &values() noexcept;
+
+    // Returns true if the tensor is quantized per-channel
+    [[nodiscard]] bool per_channel() const noexcept;
+
+    // Returns the axis of the channels (zero if the tensor is quantized per-tensor)
+    [[nodiscard]] unsigned axis() const noexcept;
+
+    // Returns the scale of channel `c` (or of the whole tensor if quantized per-tensor)
+    [[nodiscard]] float scale(const std::size_t c = 0) const noexcept;
+
+    // Returns the zero point of channel `c` (or of the whole tensor if per-tensor)
+    [[nodiscard]] std::int32_t zero_point(const std::size_t c = 0) const noexcept;
+
+    ////////////////////////////// CREATION //////////////////////////////
+
+    // Returns the real values represented by the tensor
+    [[nodiscard]] array<type::float32> dequantize() const;
+
+  private:
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    array<_DType> m_values;
+    std::vector<float> m_scales;
+    std::vector<std::int32_t> m_zero_points;
+    unsigned m_axis;
+
+  };  // class quantized
+
+  /* Returns `src` quantized per-tensor with `scale` and `zero_point`, where every value
+   * is rounded to the nearest integer and saturated to the range of the datatype
+   *
+   * Errors:
+   * same as the per-tensor constructor of `quantized`
+   */
+  template<type _DType>
+  [[nodiscard]] quantized<_DType> quantize(const array<type::float32> &src,
+    const float scale, const std::int32_t zero_point = 0);
+
+  /* Returns `src` quantized per-channel along `axis`, where channel `c` uses `scales[c]`
+   * and `zero_points[c]`
+   *
+   * Errors:
+   * same as the per-channel constructor of `quantized`
+   */
+  template<type _DType>
+  [[nodiscard]] quantized<_DType> quantize(const array<type::float32> &src,
+    std::vector<float> scales, std::vector<std::int32_t> zero_points,
+    const unsigned axis);
+
+  /* Returns the (M x N) product of the (M x K) matrix `a`, quantized per-tensor, and the
+   * (K x N) matrix `b`, quantized per-tensor or per-column (along axis 1), requantized
+   * to int8 with `scale` and `zero_point`
+   *
+   * Products are accumulated exactly in int32, and then scaled in float32
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `a` and `b` are not 2-dimensional with matching inner
+   *    dimensions, or are quantized along any other axis
+   * 2) `std::invalid_argument` if `scale` or `zero_point` is invalid for int8
+   */
+  template<type _TypeA, type _TypeB>
+  [[nodiscard]] quantized<type::int8> matmul(const quantized<_TypeA> &a,
+    const quantized<_TypeB> &b, const float scale, const std::int32_t zero_point = 0);
+
+  /* 2D convolution layer over batched (N, C, H, W) quantized tensors, having int8
+   * filters and producing int8 outputs
+   */
+  class qconv2d {
+  public:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    /* Constructs a convolution layer having the filters `weight` of shape
+     * (O, C / groups, KH, KW) quantized per-tensor or per-filter (along axis 0), an
+     * optional float32 `bias` of shape (O), and whose outputs are requantized to int8
+     * with `scale` and `zero_point`
+     *
+     * Errors:
+     * 1) all the errors listed for the constructor of `conv2d`
+     * 2) `std::invalid_argument` if `weight` is quantized along any other axis, or if
+     *    `scale` or `zero_point` is invalid for int8
+     */
+    qconv2d(const quantized<type::int8> &weight, const float scale,
+      const std::int32_t zero_point = 0, const size2d stride = 1,
+      const size2d padding = 0, const size2d dilation = 1, const std::size_t groups = 1);
+    qconv2d(const quantized<type::int8> &weight, array<type::float32> bias,
+      const float scale, const std::int32_t zero_point = 0, const size2d stride = 1,
+      const size2d padding = 0, const size2d dilation = 1, const std::size_t groups = 1);
+
+    ////////////////////////////// GENERAL ///////////////////////////////
+
+    /* Returns the shape of the output for an input of shape `input`
+     *
+     * Errors:
+     * same as `conv2d::output_shape`
+     */
+    [[nodiscard]] shape output_shape(const shape &input) const;
+
+    /* Returns the result of convolving the batch `input`, quantized per-tensor, with the
+     * layer's filters
+     *
+     * Padding uses the zero point of `input`, i.e. the real value zero
+     *
+     * Errors:
+     * 1) all the errors listed for `output_shape`
+     * 2) `std::invalid_argument` if `input` is quantized per-channel
+     */
+    template<type _DType>
+    [[nodiscard]] quantized<type::int8> forward(const quantized<_DType> &input) const;
+
+  private:
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    array<type::int16> m_weight;  // filters offset by their zero points
+    array<type::float32> m_bias;
+    std::vector<float> m_weight_scales;  // one per filter
+    float m_scale;
+    std::int32_t m_zero_point;
+    size2d m_stride, m_padding, m_dilation;
+    std::size_t m_groups;
+
+  };  // class qconv2d
+
+}  // namespace devi::net::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <cmath>
+#include <limits>
+
+namespace devi::net::internal
+{
+  namespace  // for internal linkage
+  {
+    // Throws if `scale` and `zero_point` are not valid quantization parameters of `_Type`
+    template<typename _Type>
+    void check_quantization(const float scale, const std::int32_t zero_point)
+    {
+      if (!(scale > 0.0F) || !std::isfinite(scale))
+        throw std::invalid_argument { "Quantization: scale must be positive" };
+      if (zero_point < std::numeric_limits<_Type>::min()
+          || zero_point > std::numeric_limits<_Type>::max())
+        throw std::invalid_argument {
+          "Quantization: zero point must be representable in the datatype"
+        };
+    }
+
+    /* Rounds (to nearest, ties to even) and saturates `value` to the range of `_Type`
+     *
+     * Adding and subtracting 1.5 * 2^23 rounds any float of magnitude below 2^22 to an
+     * integer, which (unlike `std::lrint`) vectorizes along with the clamping
+     */
+    template<typename _Type>
+    _Type saturate(const float value) noexcept
+    {
+      constexpr float lo { std::numeric_limits<_Type>::min() };
+      constexpr float hi { std::numeric_limits<_Type>::max() };
+      constexpr float magic { 12582912.0F };
+      return _Type((std::clamp(value, lo, hi) + magic) - magic);
+    }
+
+    // Scales the int32 accumulator `acc` by `multiplier` into an int8 with `zero_point`
+    inline std::int8_t requantize(
+      const std::int32_t acc, const float multiplier, const std::int32_t zero_point)
+    {
+      return saturate<std::int8_t>(float(acc) * multiplier + float(zero_point));
+    }
+
+    /* Calls `body(begin, end, c)` in parallel for every run [begin, end) of consecutive
+     * elements of a tensor of shape `s` belonging to the same channel `c` along `axis`
+     */
+    template<typename _Body>
+    void for_each_channel_run(const shape &s, const unsigned axis, _Body &&body)
+    {
+      std::size_t inner { 1 };
+      for (auto d { axis + 1 }; d < s.ndims(); ++d) inner *= s[d];
+      const std::size_t runs { inner ? s.size() / inner : 0 }, channels { s[axis] };
+
+      core::internal::parallel_for(runs,
+        [&](const std::size_t begin, const std::size_t end) {
+          for (auto r { begin }; r < end; ++r)
+            body(r * inner, (r + 1) * inner, r % channels);
+        },
+        (std::size_t { 1 } << 14) / std::max<std::size_t>(inner, 1) + 1);
+    }
+  }
+
+  //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+  template<type _DType>
+  quantized<_DType>::quantized(
+    array<_DType> values, const float scale, const std::int32_t zero_point)
+    : m_values { std::move(values) }, m_scales { scale }, m_zero_points { zero_point },
+      m_axis { 0 }
+  {
+    check_quantization<typename core::internal::native_type<_DType>::type>(
+      scale, zero_point);
+  }
+
+  template<type _DType>
+  quantized<_DType>::quantized(array<_DType> values, std::vector<float> scales,
+    std::vector<std::int32_t> zero_points, const unsigned axis)
+    : m_values { std::move(values) }, m_scales { std::move(scales) },
+      m_zero_points { std::move(zero_points) }, m_axis { axis }
+  {
+    if (axis >= m_values.ndims())
+      throw std::invalid_argument { "Quantization: axis out of bounds of the shape" };
+    if (m_scales.size() != m_values.shape()[axis]
+        || m_zero_points.size() != m_values.shape()[axis])
+      throw std::invalid_argument {
+        "Quantization: there must be one scale and zero point per channel"
+      };
+
+    for (std::size_t c { 0 }; c < m_scales.size(); ++c)
+      check_quantization<typename core::internal::native_type<_DType>::type>(
+        m_scales[c], m_zero_points[c]);
+  }
+
+  ////////////////////////////// GETTERS ///////////////////////////////
+
+  template<type _DType>
+  const array<_DType> &quantized<_DType>::values() const noexcept
+  {
+    return m_values;
+  }
+
+  template<type _DType>
+  array<_DType> &quantized<_DType>::values() noexcept
+  {
+    return m_values;
+  }
+
+  template<type _DType>
+  bool quantized<_DType>::per_channel() const noexcept
+  {
+    // a per-channel tensor with a single channel behaves exactly like a per-tensor one
+    return m_scales.size() > 1;
+  }
+
+  template<type _DType>
+  unsigned quantized<_DType>::axis() const noexcept
+  {
+    return m_axis;
+  }
+
+  template<type _DType>
+  float quantized<_DType>::scale(const std::size_t c) const noexcept
+  {
+    return m_scales[this->per_channel() ? c : 0];
+  }
+
+  template<type _DType>
+  std::int32_t quantized<_DType>::zero_point(const std::size_t c) const noexcept
+  {
+    return m_zero_points[this->per_channel() ? c : 0];
+  }
+
+  ////////////////////////////// CREATION //////////////////////////////
+
+  template<type _DType>
+  array<type::float32> quantized<_DType>::dequantize() const
+  {
+    array<type::float32> ret { m_values.shape() };
+    const auto *const src { m_values.data() };
+    float *const dst { ret.data() };
+
+    for_each_channel_run(m_values.shape(), m_axis,
+      [&](const std::size_t begin, const std::size_t end, const std::size_t c) {
+        const float scale { this->scale(c) };
+        const auto zero { this->zero_point(c) };
+        for (auto i { begin }; i < end; ++i)
+          dst[i] = scale * float(std::int32_t(src[i]) - zero);
+      });
+
+    return ret;
+  }
+
+  template<type _DType>
+  quantized<_DType> quantize(
+    const array<type::float32> &src, const float scale, const std::int32_t zero_point)
+  {
+    return quantize<_DType>(src, { scale }, { zero_point }, 0);
+  }
+
+  template<type _DType>
+  quantized<_DType> quantize(const array<type::float32> &src, std::vector<float> scales,
+    std::vector<std::int32_t> zero_points, const unsigned axis)
+  {
+    using native_type = typename core::internal::native_type<_DType>::type;
+
+    // a single pair of parameters is applied to all the channels
+    const bool per_tensor { scales.size() == 1 && zero_points.size() == 1 };
+    quantized<_DType> ret { per_tensor
+        ? quantized<_DType> { array<_DType> { src.shape() }, scales[0], zero_points[0] }
+        : quantized<_DType> { array<_DType> { src.shape() }, std::move(scales),
+            std::move(zero_points), axis } };
+
+    const float *const in { src.data() };
+    native_type *const out { ret.values().data() };
+    for_each_channel_run(src.shape(), per_tensor ? 0 : axis,
+      [&](const std::size_t begin, const std::size_t end, const std::size_t c) {
+        const float scale { ret.scale(c) }, zero { float(ret.zero_point(c)) };
+        for (auto i { begin }; i < end; ++i)
+          out[i] = saturate<native_type>(in[i] / scale + zero);
+      });
+
+    return ret;
+  }
+
+  template<type _TypeA, type _TypeB>
+  quantized<type::int8> matmul(const quantized<_TypeA> &a, const quantized<_TypeB> &b,
+    const float scale, const std::int32_t zero_point)
+  {
+    DEVI_PROFILE_SCOPE("net::matmul");
+    const auto &sa { a.values().shape() }, &sb { b.values().shape() };
+    if (sa.ndims() != 2 || sb.ndims() != 2 || sa[1] != sb[0])
+      throw std::invalid_argument {
+        "Quantized matmul: operands must be (M x K) and (K x N) matrices"
+      };
+    if (a.per_channel() || (b.per_channel() && b.axis() != 1))
+      throw std::invalid_argument {
+        "Quantized matmul: `a` must be quantized per-tensor, and `b` per-tensor or "
+        "per-column"
+      };
+    check_quantization<std::int8_t>(scale, zero_point);
+
+    const std::size_t M { sa[0] }, N { sb[1] }, K { sa[1] };
+    array<type::int8> out { shape(M, N) };
+    std::vector<float> multipliers(N);
+    for (std::size_t j { 0 }; j < N; ++j)
+      multipliers[j] = a.scale() * b.scale(j) / scale;
+
+    // per-column zero points are subtracted upfront, as the kernel takes a single one
+    array<type::int16> offset { shape(b.per_channel() ? K * N : 0) };
+    if (b.per_channel())
+      for (std::size_t k { 0 }; k < K; ++k)
+        for (std::size_t j { 0 }; j < N; ++j)
+          offset[k * N + j] = std::int16_t(b.values()[k * N + j] - b.zero_point(j));
+
+    const auto multiply { [&](const auto *const B, const std::int32_t b_zero) {
+      // blocks of rows bound the int32 accumulator workspace of every thread
+      constexpr std::size_t ROWS { 32 };
+      using core::internal::gemm, core::internal::parallel_for;
+      parallel_for(M, [&](const std::size_t begin, const std::size_t end) {
+        std::vector<std::int32_t> acc(std::min(ROWS, end - begin) * N);
+        for (auto i { begin }; i < end; i += ROWS) {
+          const auto rows { std::min(ROWS, end - i) };
+          gemm(rows, N, K, a.values().data() + i * K, K, a.zero_point(), B, N, b_zero,
+            acc.data(), N);
+
+          std::int8_t *const dst { out.data() + i * N };
+          for (std::size_t r { 0 }; r < rows; ++r)
+            for (std::size_t j { 0 }; j < N; ++j)
+              dst[r * N + j] = requantize(acc[r * N + j], multipliers[j], zero_point);
+        }
+      });
+    } };
+
+    if (b.per_channel())
+      multiply(offset.data(), 0);
+    else
+      multiply(b.values().data(), b.zero_point());
+
+    return { std::move(out), scale, zero_point };
+  }
+
+  //////////////////////////////////// QCONV2D ////////////////////////////////////
+
+  inline qconv2d::qconv2d(const quantized<type::int8> &weight, const float scale,
+    const std::int32_t zero_point, const size2d stride, const size2d padding,
+    const size2d dilation, const std::size_t groups)
+    : qconv2d { weight, array<type::float32> { shape(0) }, scale, zero_point, stride,
+        padding, dilation, groups }
+  { }
+
+  inline qconv2d::qconv2d(const quantized<type::int8> &weight, array<type::float32> bias,
+    const float scale, const std::int32_t zero_point, const size2d stride,
+    const size2d padding, const size2d dilation, const std::size_t groups)
+    : m_weight { weight.values().shape() }, m_bias { std::move(bias) }, m_scale { scale },
+      m_zero_point { zero_point }, m_stride { stride }, m_padding { padding },
+      m_dilation { dilation }, m_groups { groups }
+  {
+    check_conv(m_weight.shape(), m_bias.shape(), stride, dilation, groups);
+    if (weight.per_channel() && weight.axis() != 0)
+      throw std::invalid_argument {
+        "QConv2D: `weight` must be quantized per-tensor or per-filter"
+      };
+    check_quantization<std::int8_t>(scale, zero_point);
+
+    const std::size_t O { m_weight.shape()[0] }, K { m_weight.size() / O };
+    m_weight_scales.resize(O);
+    for (std::size_t o { 0 }; o < O; ++o) {
+      m_weight_scales[o] = weight.scale(o);
+      for (std::size_t k { 0 }; k < K; ++k)
+        m_weight[o * K + k]
+          = std::int16_t(weight.values()[o * K + k] - weight.zero_point(o));
+    }
+  }
+
+  inline shape qconv2d::output_shape(const shape &input) const
+  {
+    return conv_output_shape(
+      input, m_weight.shape(), m_stride, m_padding, m_dilation, m_groups);
+  }
+
+  template<type _DType>
+  quantized<type::int8> qconv2d::forward(const quantized<_DType> &input) const
+  {
+    DEVI_PROFILE_SCOPE("net::qconv2d");
+    if (input.per_channel())
+      throw std::invalid_argument { "QConv2D: input must be quantized per-tensor" };
+    array<type::int8> output { this->output_shape(input.values().shape()) };
+
+    const auto &s { input.values().shape() }, &w { m_weight.shape() };
+    const auto &o { output.shape() };
+    const conv_geometry g { s[2], s[3], o[2], o[3], w[2], w[3], m_stride, m_padding,
+      m_dilation };
+    const std::size_t N { s[0] }, C { s[1] }, O { w[0] }, HW { s[2] * s[3] };
+    const std::size_t Cg { C / m_groups }, Og { O / m_groups }, P { o[2] * o[3] };
+    const std::size_t K { Cg * w[2] * w[3] };
+
+    // per-filter requantization multipliers, and biases in the accumulator's scale
+    const auto in_zero { input.zero_point() };
+    std::vector<float> multipliers(O);
+    std::vector<std::int32_t> bias(O);
+    for (std::size_t oc { 0 }; oc < O; ++oc) {
+      const float acc_scale { input.scale() * m_weight_scales[oc] };
+      multipliers[oc] = acc_scale / m_scale;
+      bias[oc] = m_bias.size() ? std::int32_t(std::lrint(m_bias[oc] / acc_scale)) : 0;
+    }
+
+    const auto *const in { input.values().data() };
+    const std::int16_t *const weight { m_weight.data() };
+    std::int8_t *const out { output.data() };
+    using core::internal::gemm, core::internal::parallel_for;
+
+    // implicit GEMM over tiles of output pixels, as in `conv2d`
+    const bool pointwise { w[2] == 1 && w[3] == 1 && m_stride.m_y == 1
+                           && m_stride.m_x == 1 && !m_padding.m_y && !m_padding.m_x };
+    const std::size_t NR { core::internal::IGEMM_NR }, budget { (1UL << 18) / K };
+    const auto tile { std::min(P, std::max(4 * NR, budget / NR * NR)) };
+    const std::size_t tiles { (P + tile - 1) / tile }, tasks { N * m_groups * tiles };
+
+    parallel_for(tasks, [&](const std::size_t begin, const std::size_t end) {
+      std::vector<std::int16_t> col(pointwise ? 0 : K * tile);
+      std::vector<std::int32_t> acc(Og * tile);
+      DEVI_PROFILE_ALLOCATION(workspace,
+        col.size() * sizeof(std::int16_t) + acc.size() * sizeof(std::int32_t));
+      for (auto t { begin }; t < end; ++t) {
+        const std::size_t n { t / (m_groups * tiles) }, grp { t / tiles % m_groups };
+        const std::size_t p0 { t % tiles * tile }, np { std::min(tile, P - p0) };
+        const auto *const src { in + (n * C + grp * Cg) * HW };
+        std::int8_t *const dst { out + (n * O + grp * Og) * P + p0 };
+
+        const std::int16_t *const filters { weight + grp * Og * K };
+        if (pointwise)
+          gemm(Og, np, K, filters, K, 0, src + p0, HW, in_zero, acc.data(), np);
+        else {
+          im2col(src, Cg, g, p0, np, col.data(), std::int16_t(in_zero));
+          gemm(Og, np, K, filters, K, 0, col.data(), np, 0, acc.data(), np);
+        }
+
+        for (std::size_t oc { 0 }, f { grp * Og }; oc < Og; ++oc, ++f)
+          for (std::size_t p { 0 }; p < np; ++p)
+            dst[oc * P + p] = requantize(acc[oc * np + p] + bias[f], multipliers[f],
+              m_zero_point);
+      }
+    });
+
+    return { std::move(output), m_scale, m_zero_point };
+  }
+
+}  // namespace devi::net::internal
+
+#endif
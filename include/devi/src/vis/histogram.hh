@@ -0,0 +1,512 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_VIS_HISTOGRAM_HH_
+#define _HEADER_GUARD__DEVI_SRC_VIS_HISTOGRAM_HH_
+
+#include "../core/array.hh"
+#include "../core/parallel.hh"
+#include "../core/strided.hh"
+#include "__header_check__"
+
+#include <vector>
+
+namespace devi::vis::internal
+{
+  using core::internal::array;
+  using core::internal::shape;
+  using core::internal::type;
+  using core::internal::view;
+
+  // Default upper bound of the histogram value range of every datatype
+  template<type _DType>
+  static constexpr double histogram_upper {
+    _DType == type::float16 || _DType == type::bfloat16 || _DType == type::float32
+        || _DType == type::float64
+      ? 1.0
+    : _DType == type::uint16 ? 65536.0
+                             : 256.0
+  };
+
+  /* Returns the histogram of all the elements of `src`, having `bins` equal-width bins
+   * spanning the half-open value range [lo, hi); elements outside the range are ignored
+   *
+   * Every thread counts into a private histogram, and all of them are merged at the end
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `bins` is zero or if `lo` is not less than `hi`
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<type::uint64> histogram(const array<_DType> &src,
+    const std::size_t bins = 256, const double lo = 0,
+    const double hi = histogram_upper<_DType>);
+  template<type _DType>
+  [[nodiscard]] array<type::uint64> histogram(const view<_DType> &src,
+    const std::size_t bins = 256, const double lo = 0,
+    const double hi = histogram_upper<_DType>);
+
+  /* Returns a copy of the 8-bit or 16-bit image `src` with its histogram equalized over
+   * the full value range of its datatype
+   *
+   * Errors:
+   * `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<_DType> equalize(const array<_DType> &src);
+  template<type _DType>
+  [[nodiscard]] array<_DType> equalize(const view<_DType> &src);
+
+  /* Returns a copy of the (H, W) 8-bit or 16-bit image `src` after Contrast Limited
+   * Adaptive Histogram Equalization over a grid of `tiles_y` x `tiles_x` tiles
+   * Histogram bins of every tile are clipped at `clip_limit` times the average bin count,
+   * and the tile mappings are bilinearly interpolated at every pixel
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `src` is not 2-dimensional, or if the grid has a zero
+   *    dimension or more tiles than pixels along a dimension
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<_DType> clahe(const array<_DType> &src,
+    const double clip_limit = 2.0, const std::size_t tiles_y = 8,
+    const std::size_t tiles_x = 8);
+
+}  // namespace devi::vis::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace devi::vis::internal
+{
+  namespace  // for internal linkage
+  {
+    // Strided memory layout of all the elements of an array or a view
+    template<typename _Native>
+    struct elements {
+      _Native *p_data;
+      const shape &m_shape;
+      core::internal::runs m_runs;
+    };
+
+    template<type _DType>
+    elements<const typename core::internal::native_type<_DType>::type> elements_of(
+      const array<_DType> &src)
+    {
+      const auto &s { src.shape() };
+      return { src.data(), s, { s, core::internal::slice_data::get_stride(s) } };
+    }
+
+    template<type _DType>
+    elements<const typename core::internal::native_type<_DType>::type> elements_of(
+      const view<_DType> &src)
+    {
+      return { src.data(), src.shape(), { src.shape(), src.stride() } };
+    }
+
+    // Maps element values onto histogram bins
+    template<typename _Native>
+    struct binning {
+      double m_lo, m_hi, m_scale;
+      std::size_t m_bins;
+      bool m_direct;  // values are integers equal to their bin index
+
+      binning(const std::size_t bins, const double lo, const double hi)
+        : m_lo { lo }, m_hi { hi }, m_scale { bins / (hi - lo) }, m_bins { bins },
+          m_direct { std::is_integral_v<_Native> && lo == 0 && hi == double(bins) }
+      {
+        if (bins == 0 || !(lo < hi))
+          throw std::invalid_argument {
+            "Histogram: `bins` must be non-zero and `lo` must be less than `hi`"
+          };
+      }
+
+      // Adds `n` elements which are `step` apart starting from `p` into `hist`
+      void count(const _Native *p, const std::size_t n, const std::size_t step,
+        std::uint64_t *const hist) const noexcept
+      {
+        if (m_direct) {
+          for (std::size_t i { 0 }; i < n; ++i, p += step)
+            if (std::size_t(p[0]) < m_bins) ++hist[std::size_t(p[0])];
+          return;
+        }
+
+        for (std::size_t i { 0 }; i < n; ++i, p += step) {
+          const auto v { static_cast<double>(p[0]) };
+          if (!(v >= m_lo && v < m_hi)) continue;
+          ++hist[std::min(std::size_t((v - m_lo) * m_scale), m_bins - 1)];
+        }
+      }
+    };
+
+    /* Counts contiguous bytes into 4 interleaved sub-histograms of 256 bins each, which
+     * breaks the store-to-load dependency between repeated values
+     */
+    inline void count_bytes(
+      const std::uint8_t *const p, const std::size_t n, std::uint64_t (*const sub)[256])
+    {
+      std::size_t i { 0 };
+      for (; i + 4 <= n; i += 4) {
+        ++sub[0][p[i]];
+        ++sub[1][p[i + 1]];
+        ++sub[2][p[i + 2]];
+        ++sub[3][p[i + 3]];
+      }
+      for (; i < n; ++i) ++sub[0][p[i]];
+    }
+
+    template<typename _Native>
+    array<type::uint64> histogram(const elements<const _Native> &src,
+      const std::size_t bins, const double lo, const double hi)
+    {
+      DEVI_PROFILE_SCOPE("vis::histogram");
+      const binning<_Native> binning { bins, lo, hi };
+      const auto step { src.m_runs.step() };
+      const bool bytes { sizeof(_Native) == 1 && std::is_unsigned_v<_Native>
+                         && binning.m_direct && bins >= 256 && step == 1 };
+
+      // private histograms of every thread, padded to separate cache lines
+      const auto parts { core::internal::partition_count(src.m_runs.size(), 1UL << 16) };
+      const std::size_t padded { (bins + 7) & ~std::size_t { 7 } };
+      std::vector<std::uint64_t> local(parts * padded);
+      DEVI_PROFILE_ALLOCATION(workspace, local.size() * sizeof(std::uint64_t));
+
+      core::internal::thread_pool::instance().run(parts, [&](const unsigned i) {
+        auto *const hist { local.data() + i * padded };
+        if (!bytes)
+          return src.m_runs.for_each(parts, i,
+            [&](std::size_t, const std::size_t offset, const std::size_t n) {
+              binning.count(src.p_data + offset, n, step, hist);
+            });
+
+        std::vector<std::uint64_t> sub(4 * 256);
+        auto *const sub4 { reinterpret_cast<std::uint64_t(*)[256]>(sub.data()) };
+        src.m_runs.for_each(parts, i,
+          [&](std::size_t, const std::size_t offset, const std::size_t n) {
+            const auto *const p { src.p_data + offset };
+            count_bytes(reinterpret_cast<const std::uint8_t *>(p), n, sub4);
+          });
+        for (unsigned b { 0 }; b < 256; ++b)
+          hist[b] = sub4[0][b] + sub4[1][b] + sub4[2][b] + sub4[3][b];
+      });
+
+      array<type::uint64> ret { shape(bins) };
+      for (unsigned i { 0 }; i < parts; ++i)
+        for (std::size_t b { 0 }; b < bins; ++b) ret.data()[b] += local[i * padded + b];
+
+      return ret;
+    }
+
+    // Checks that the datatype is supported by the equalization functions
+    template<type _DType>
+    constexpr void static_assert_equalizable() noexcept
+    {
+      static_assert(_DType == type::uint8 || _DType == type::uint16,
+        "Histogram equalization is only supported for `uint8` and `uint16` images");
+    }
+
+    /* Maps `n` contiguous bytes of `in` through the 256-entry `lut` into `out`, and
+     * returns the number of bytes mapped (a multiple of 32, the rest is left to the
+     * caller)
+     *
+     * Every 16-byte row of the table is looked up by the low nibbles of 32 bytes at once,
+     * and kept for the bytes whose high nibble is the index of the row
+     */
+    inline std::size_t lut_bytes(const std::uint8_t *const in, const std::size_t n,
+      const std::uint8_t *const lut, std::uint8_t *const out) noexcept
+    {
+      std::size_t i { 0 };
+#if defined(__AVX2__)
+      __m256i rows[16];
+      for (int k { 0 }; k < 16; ++k)
+        rows[k] = _mm256_broadcastsi128_si256(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(lut + 16 * k)));
+      const auto nibble { _mm256_set1_epi8(0x0F) };
+      for (; i + 32 <= n; i += 32) {
+        const auto v { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i)) };
+        const auto low { _mm256_and_si256(v, nibble) };
+        const auto high { _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble) };
+        auto mapped { _mm256_setzero_si256() };
+        for (int k { 0 }; k < 16; ++k) {
+          const auto row { _mm256_cmpeq_epi8(high, _mm256_set1_epi8(char(k))) };
+          mapped = _mm256_or_si256(
+            mapped, _mm256_and_si256(row, _mm256_shuffle_epi8(rows[k], low)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), mapped);
+      }
+#endif
+      (void)in, (void)n, (void)lut, (void)out;
+      return i;
+    }
+
+    // Maps every element of `src` through `lut` into the contiguous `dst`
+    template<typename _Native>
+    void apply_lut(
+      const elements<const _Native> &src, const _Native *const lut, _Native *const dst)
+    {
+      const auto step { src.m_runs.step() };
+      const auto parts { core::internal::partition_count(src.m_runs.size(), 1UL << 14) };
+      core::internal::thread_pool::instance().run(parts, [&](const unsigned i) {
+        src.m_runs.for_each(parts, i,
+          [&](const std::size_t index, const std::size_t offset, const std::size_t n) {
+            const _Native *const in { src.p_data + offset };
+            _Native *const out { dst + index };
+            std::size_t j { 0 };
+            if constexpr (std::is_same_v<_Native, std::uint8_t>)
+              if (step == 1) j = lut_bytes(in, n, lut, out);
+            if (step == 1)
+              for (; j < n; ++j) out[j] = lut[in[j]];
+            else
+              for (; j < n; ++j) out[j] = lut[in[j * step]];
+          });
+      });
+    }
+
+    template<type _DType, typename _Native>
+    array<_DType> equalize(const elements<const _Native> &src)
+    {
+      DEVI_PROFILE_SCOPE("vis::equalize");
+      static_assert_equalizable<_DType>();
+      constexpr auto bins { std::size_t { std::numeric_limits<_Native>::max() } + 1 };
+
+      const auto hist { histogram(src, bins, 0, bins) };
+      const auto *const h { hist.data() };
+
+      std::vector<_Native> lut(bins);
+      std::uint64_t cdf { 0 }, first { 0 };
+      const std::uint64_t total { src.m_shape.size() };
+      for (std::size_t b { 0 }; b < bins && first == 0; ++b) first = h[b];
+      for (std::size_t b { 0 }; b < bins; ++b) {
+        cdf += h[b];
+        lut[b] = total == first
+                 ? _Native(b)
+                 : _Native(std::lround(double(cdf - std::min(cdf, first)) * (bins - 1)
+                                       / double(total - first)));
+      }
+
+      array<_DType> ret { src.m_shape };
+      apply_lut(src, lut.data(), ret.data());
+      return ret;
+    }
+
+    /* Writes the pixels of a row of `W` pixels of `in` mapped through the tile mappings
+     * above (`top`) and below (`bottom`) it, bilinearly interpolated with the weight `wy`
+     * between them, and for every pixel `x`, with the weight `wx[x]` between the mappings
+     * starting `left[x]` and `right[x]` elements into them
+     *
+     * NOTE: the mappings are read 4 bytes at a time, so they must be followed by atleast
+     * 4 bytes of padding
+     */
+    template<typename _Native>
+    void clahe_row(const _Native *const in, const std::size_t W, const _Native *const top,
+      const _Native *const bottom, const float wy, const std::uint32_t *const left,
+      const std::uint32_t *const right, const float *const wx, _Native *const out)
+    {
+      std::size_t x { 0 };
+#if defined(__AVX2__)
+      // 8 pixels at a time, with the 4 mappings of every pixel gathered
+      const auto mask { _mm256_set1_epi32(std::numeric_limits<_Native>::max()) };
+      const auto fetch { [&](const _Native *const lut, const __m256i i) {
+        const auto *const base { reinterpret_cast<const int *>(lut) };
+        const auto v { _mm256_i32gather_epi32(base, i, sizeof(_Native)) };
+        return _mm256_cvtepi32_ps(_mm256_and_si256(v, mask));
+      } };
+      const auto vy { _mm256_set1_ps(wy) }, half { _mm256_set1_ps(0.5F) };
+      for (; x + 8 <= W; x += 8) {
+        __m256i v;
+        if constexpr (sizeof(_Native) == 1)
+          v = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(in + x)));
+        else
+          v = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x)));
+        const auto l { _mm256_add_epi32(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(left + x)), v) };
+        const auto r { _mm256_add_epi32(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(right + x)), v) };
+        const auto vx { _mm256_loadu_ps(wx + x) };
+        const auto tl { fetch(top, l) }, bl { fetch(bottom, l) };
+        const auto t { _mm256_add_ps(
+          tl, _mm256_mul_ps(vx, _mm256_sub_ps(fetch(top, r), tl))) };
+        const auto b { _mm256_add_ps(
+          bl, _mm256_mul_ps(vx, _mm256_sub_ps(fetch(bottom, r), bl))) };
+        const auto blended { _mm256_add_ps(
+          _mm256_add_ps(t, _mm256_mul_ps(vy, _mm256_sub_ps(b, t))), half) };
+        // narrow the 8 integers (which are in range) and keep them in the low 128 bits
+        const auto words { _mm256_permute4x64_epi64(
+          _mm256_packus_epi32(_mm256_cvttps_epi32(blended), _mm256_setzero_si256()),
+          0x08) };
+        const auto low { _mm256_castsi256_si128(words) };
+        if constexpr (sizeof(_Native) == 1)
+          _mm_storel_epi64(
+            reinterpret_cast<__m128i *>(out + x), _mm_packus_epi16(low, low));
+        else
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x), low);
+      }
+#endif
+      for (; x < W; ++x) {
+        const std::size_t l { left[x] + in[x] }, r { right[x] + in[x] };
+        const float t { top[l] + wx[x] * (float(top[r]) - top[l]) };
+        const float b { bottom[l] + wx[x] * (float(bottom[r]) - bottom[l]) };
+        out[x] = _Native(t + wy * (b - t) + 0.5F);
+      }
+    }
+  }
+
+  template<type _DType>
+  array<type::uint64> histogram(const array<_DType> &src, const std::size_t bins,
+    const double lo, const double hi)
+  {
+    return histogram(elements_of(src), bins, lo, hi);
+  }
+
+  template<type _DType>
+  array<type::uint64> histogram(
+    const view<_DType> &src, const std::size_t bins, const double lo, const double hi)
+  {
+    return histogram(elements_of(src), bins, lo, hi);
+  }
+
+  template<type _DType>
+  array<_DType> equalize(const array<_DType> &src)
+  {
+    return equalize<_DType>(elements_of(src));
+  }
+
+  template<type _DType>
+  array<_DType> equalize(const view<_DType> &src)
+  {
+    return equalize<_DType>(elements_of(src));
+  }
+
+  template<type _DType>
+  array<_DType> clahe(const array<_DType> &src, const double clip_limit,
+    const std::size_t tiles_y, const std::size_t tiles_x)
+  {
+    DEVI_PROFILE_SCOPE("vis::clahe");
+    static_assert_equalizable<_DType>();
+    using native = typename core::internal::native_type<_DType>::type;
+    constexpr auto bins { std::size_t { std::numeric_limits<native>::max() } + 1 };
+
+    const auto &s { src.shape() };
+    if (s.ndims() != 2)
+      throw std::invalid_argument { "CLAHE: image must be of shape (H, W)" };
+    const std::size_t H { s[0] }, W { s[1] };
+    if (tiles_y == 0 || tiles_x == 0 || tiles_y > H || tiles_x > W)
+      throw std::invalid_argument { "CLAHE: invalid grid of tiles for the image shape" };
+
+    const auto *const in { src.data() };
+    const auto stride { core::internal::slice_data::get_stride(s) };
+    const auto tile_y { [&](const std::size_t i) {
+      return core::internal::partition(H, tiles_y, i);
+    } };
+    const auto tile_x { [&](const std::size_t j) {
+      return core::internal::partition(W, tiles_x, j);
+    } };
+
+    // clipped and equalized mapping of every tile (padded for `clahe_row`), counted by
+    // `histogram` over the window of the tile (serially, within a parallel region)
+    std::vector<native> luts(tiles_y * tiles_x * bins + 4);
+    core::internal::parallel_for(
+      tiles_y * tiles_x, [&](const std::size_t begin, const std::size_t end) {
+        for (auto t { begin }; t < end; ++t) {
+          const auto [y0, y1] { tile_y(t / tiles_x) };
+          const auto [x0, x1] { tile_x(t % tiles_x) };
+          const shape window { y1 - y0, x1 - x0 };
+          const elements<const native> tile { in + y0 * W + x0, window,
+            { window, stride } };
+          auto counts { histogram(tile, bins, 0, bins) };
+          auto *const hist { counts.data() };
+
+          // clip and redistribute the excess uniformly
+          const std::uint64_t area { (y1 - y0) * (x1 - x0) };
+          const auto limit { std::max<std::uint64_t>(1, clip_limit * area / bins) };
+          std::uint64_t excess { 0 };
+          for (std::size_t b { 0 }; b < bins; ++b)
+            if (hist[b] > limit) {
+              excess += hist[b] - limit;
+              hist[b] = limit;
+            }
+          // (spreading exactly the residual, so that the counts still add up to `area`)
+          const auto uniform { excess / bins };
+          auto residual { excess % bins };
+          for (std::size_t b { 0 }; b < bins; ++b) hist[b] += uniform;
+          if (residual)
+            for (std::size_t b { 0 }, step { bins / residual }; b < bins && residual;
+                 b += step, --residual)
+              ++hist[b];
+
+          std::uint64_t cdf { 0 };
+          auto *const lut { luts.data() + t * bins };
+          for (std::size_t b { 0 }; b < bins; ++b) {
+            cdf += hist[b];
+            lut[b] = native(std::lround(double(cdf) * (bins - 1) / area));
+          }
+        }
+      });
+
+    // neighboring tiles and interpolation weights of every row and column
+    const auto neighbors { [](const std::size_t tiles, const auto &tile,
+                             const std::size_t i) {
+      // centers of tiles `t` and `t + 1` enclose `i`
+      const auto center { [&](const std::size_t t) {
+        const auto [b, e] { tile(t) };
+        return (b + e - 1) / 2.0;
+      } };
+      std::size_t t { 0 };
+      while (t + 1 < tiles && center(t + 1) <= i) ++t;
+      if (i <= center(0) || t + 1 == tiles) return std::tuple { t, t, 0.0F };
+      const auto w { (i - center(t)) / (center(t + 1) - center(t)) };
+      return std::tuple { t, t + 1, float(w) };
+    } };
+    std::vector<std::uint32_t> left(W), right(W);
+    std::vector<float> wx(W);
+    for (std::size_t x { 0 }; x < W; ++x) {
+      const auto [t0, t1, w] { neighbors(tiles_x, tile_x, x) };
+      left[x]  = std::uint32_t(t0 * bins);
+      right[x] = std::uint32_t(t1 * bins);
+      wx[x]    = w;
+    }
+
+    array<_DType> ret { s };
+    auto *const out { ret.data() };
+    core::internal::parallel_for(
+      H,
+      [&](const std::size_t begin, const std::size_t end) {
+        for (auto y { begin }; y < end; ++y) {
+          const auto [ty0, ty1, wy] { neighbors(tiles_y, tile_y, y) };
+          const auto *const top { luts.data() + ty0 * tiles_x * bins };
+          const auto *const bottom { luts.data() + ty1 * tiles_x * bins };
+          clahe_row(in + y * W, W, top, bottom, wy, left.data(), right.data(), wx.data(),
+            out + y * W);
+        }
+      },
+      1 + (1UL << 14) / (W + 1));
+
+    return ret;
+  }
+
+}  // namespace devi::vis::internal
+
+#endif
@@ -0,0 +1,217 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_VIS_INTEGRAL_HH_
+#define _HEADER_GUARD__DEVI_SRC_VIS_INTEGRAL_HH_
+
+#include "../core/array.hh"
+#include "../core/parallel.hh"
+#include "__header_check__"
+
+#include <algorithm>
+#include <tuple>
+
+namespace devi::vis::internal
+{
+  using core::internal::array;
+  using core::internal::shape;
+  using core::internal::type;
+
+  // Compile-time mapper from an image datatype to the datatype of its integral image
+  template<type _DType>
+  struct integral_type;
+
+#define INTEGRAL_TYPE(image_t, sum_t)            \
+  template<>                                     \
+  struct integral_type<type::image_t> {          \
+    static constexpr type value { type::sum_t }; \
+  };
+
+  INTEGRAL_TYPE(bool8, uint32);
+  INTEGRAL_TYPE(uint8, uint32);
+  INTEGRAL_TYPE(int8, int32);
+  INTEGRAL_TYPE(uint16, uint64);
+  INTEGRAL_TYPE(uint32, uint64);
+  INTEGRAL_TYPE(uint64, uint64);
+  INTEGRAL_TYPE(int16, int64);
+  INTEGRAL_TYPE(int32, int64);
+  INTEGRAL_TYPE(int64, int64);
+  INTEGRAL_TYPE(float16, float32);
+  INTEGRAL_TYPE(bfloat16, float32);
+  INTEGRAL_TYPE(float32, float64);
+  INTEGRAL_TYPE(float64, float64);
+
+#undef INTEGRAL_TYPE
+
+  /* Returns the integral image (summed-area table) of the (H, W) or (H, W, C) image `src`
+   * The result has shape (H + 1, W + 1) or (H + 1, W + 1, C), with a leading row and
+   * column of zeros, so that element (y, x) is the sum of all pixels in [0, y) x [0, x)
+   *
+   * NOTE: 8-bit images accumulate in 32 bits, which holds atleast 2^24 pixels at full
+   * intensity
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `src` is neither 2- nor 3-dimensional
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<integral_type<_DType>::value> integral(const array<_DType> &src);
+
+  // Same as `integral`, but accumulates the squares of the pixels in float64
+  template<type _DType>
+  [[nodiscard]] array<type::float64> integral_squared(const array<_DType> &src);
+
+  /* Returns the sum of all the pixels of channel `c` within rows [y0, y1) and columns
+   * [x0, x1) of an image, in constant time, using its integral image `table`
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `table` is neither 2- nor 3-dimensional
+   * 2) `std::out_of_range` if the region or the channel is out of bounds of the image
+   */
+  template<type _DType>
+  [[nodiscard]] typename core::internal::native_type<_DType>::type region_sum(
+    const array<_DType> &table, const std::size_t y0, const std::size_t x0,
+    const std::size_t y1, const std::size_t x1, const std::size_t c = 0);
+
+}  // namespace devi::vis::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+namespace devi::vis::internal
+{
+  namespace  // for internal linkage
+  {
+    /* Builds the integral `dst` of the (H, W, C) image `src`, after mapping every pixel
+     * through `op`
+     *
+     * Phase 1 computes the table of every horizontal band of rows independently in
+     * parallel; phase 2 propagates the last row of every band into all following bands
+     */
+    template<typename _Acc, typename _In, typename _Op>
+    void integrate(const _In *const src, _Acc *const dst, const std::size_t H,
+      const std::size_t W, const std::size_t C, _Op op)
+    {
+      const std::size_t in_row { W * C }, out_row { (W + 1) * C };
+      std::fill_n(dst, out_row, _Acc {});
+
+      auto &pool { core::internal::thread_pool::instance() };
+      // atleast ~16K pixels and one row per band (an empty band would carry its last
+      // row into itself)
+      const auto bands { unsigned(std::min<std::size_t>(
+        { pool.concurrency(), H, std::max<std::size_t>(H * in_row >> 14, 1) })) };
+      const auto band { [&](const unsigned b) {
+        return core::internal::partition(H, bands, b);
+      } };
+
+      // Phase 1: band-local running sums
+      pool.run(bands, [&](const unsigned b) {
+        const auto [begin, end] { band(b) };
+        for (auto y { begin }; y < end; ++y) {
+          const _In *const in { src + y * in_row };
+          _Acc *const out { dst + (y + 1) * out_row };
+
+          std::fill_n(out, C, _Acc {});
+          for (std::size_t i { 0 }; i < in_row; ++i)
+            out[i + C] = out[i] + static_cast<_Acc>(op(in[i]));
+
+          if (y == begin) continue;
+          const _Acc *const above { out - out_row };
+          for (std::size_t i { C }; i < out_row; ++i) out[i] += above[i];
+        }
+      });
+      if (bands == 1) return;
+
+      // Phase 2: carry the last row of every band forward
+      for (unsigned b { 1 }; b < bands; ++b) {
+        const _Acc *const carry { dst + band(b - 1).second * out_row };
+        _Acc *const last { dst + band(b).second * out_row };
+        for (std::size_t i { C }; i < out_row; ++i) last[i] += carry[i];
+      }
+      pool.run(bands, [&](const unsigned b) {
+        if (b == 0) return;
+        const auto [begin, end] { band(b) };
+        const _Acc *const carry { dst + begin * out_row };
+        for (auto y { begin + 1 }; y < end; ++y) {
+          _Acc *const out { dst + y * out_row };
+          for (std::size_t i { C }; i < out_row; ++i) out[i] += carry[i];
+        }
+      });
+    }
+
+    // Returns the (H, W, C) extents of a 2- or 3-dimensional image shape
+    inline std::tuple<std::size_t, std::size_t, std::size_t> image_extents(
+      const shape &s, const std::size_t pad = 0)
+    {
+      if (s.ndims() != 2 && s.ndims() != 3)
+        throw std::invalid_argument { "Integral: image must be of shape (H, W[, C])" };
+
+      return { s[0] - pad, s[1] - pad, s.ndims() == 3 ? s[2] : 1 };
+    }
+
+    // Returns the shape of the integral of the image shape `s`
+    inline shape integral_shape(const shape &s)
+    {
+      return s.ndims() == 2 ? shape(s[0] + 1, s[1] + 1) : shape(s[0] + 1, s[1] + 1, s[2]);
+    }
+  }
+
+  template<type _DType>
+  array<integral_type<_DType>::value> integral(const array<_DType> &src)
+  {
+    DEVI_PROFILE_SCOPE("vis::integral");
+    using namespace core::internal;
+    using acc_type = typename native_type<integral_type<_DType>::value>::type;
+
+    const auto [H, W, C] { image_extents(src.shape()) };
+    array<integral_type<_DType>::value> ret { integral_shape(src.shape()) };
+    integrate<acc_type>(src.data(), ret.data(), H, W, C, [](const auto v) { return v; });
+
+    return ret;
+  }
+
+  template<type _DType>
+  array<type::float64> integral_squared(const array<_DType> &src)
+  {
+    DEVI_PROFILE_SCOPE("vis::integral_squared");
+    const auto [H, W, C] { image_extents(src.shape()) };
+    array<type::float64> ret { integral_shape(src.shape()) };
+    integrate<double>(src.data(), ret.data(), H, W, C, [](const auto v) {
+      const auto d { static_cast<double>(v) };
+      return d * d;
+    });
+
+    return ret;
+  }
+
+  template<type _DType>
+  typename core::internal::native_type<_DType>::type region_sum(
+    const array<_DType> &table, const std::size_t y0, const std::size_t x0,
+    const std::size_t y1, const std::size_t x1, const std::size_t c)
+  {
+    const auto [H, W, C] { image_extents(table.shape(), 1) };
+    if (y0 > y1 || x0 > x1 || y1 > H || x1 > W || c >= C)
+      throw std::out_of_range { "Integral: region is out of bounds of the image" };
+
+    const auto *const p { table.data() + c };
+    const std::size_t row { (W + 1) * C };
+    return p[y1 * row + x1 * C] - p[y0 * row + x1 * C] - p[y1 * row + x0 * C]
+         + p[y0 * row + x0 * C];
+  }
+
+}  // namespace devi::vis::internal
+
+#endif
@@ -0,0 +1,285 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_VIS_LABEL_HH_
+#define _HEADER_GUARD__DEVI_SRC_VIS_LABEL_HH_
+
+#include "../core/array.hh"
+#include "../core/parallel.hh"
+#include "__header_check__"
+
+#include <vector>
+
+namespace devi::vis::internal
+{
+  using core::internal::array;
+  using core::internal::shape;
+  using core::internal::type;
+
+  // Area, bounding box and centroid of a connected component of a mask
+  struct region {
+    std::size_t m_area;             // number of pixels
+    std::size_t m_top, m_left;      // first row and column of the bounding box
+    std::size_t m_bottom, m_right;  // one past the last row and column
+    double m_cy, m_cx;              // centroid (mean row and column)
+  };
+
+  /* Returns the labels (of shape (H, W)) of the connected components of the nonzero
+   * pixels of the (H, W) mask `src`, where `connectivity` is 4 (edge neighbours) or 8
+   * (edge and corner neighbours); background pixels are labelled 0, and components are
+   * numbered from 1 in the raster order of their first pixel
+   *
+   * The overload taking `regions` also replaces its contents with the statistics of
+   * every component, `regions[l - 1]` being the ones of label `l`
+   *
+   * Every row is split into runs of foreground pixels, which are merged with the runs of
+   * the row above them (union-find) in parallel strips of rows, followed by the runs on
+   * both sides of the seams between strips. The statistics are accumulated over the runs
+   * while their labels are resolved, so the image is read only once
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `src` is not 2-dimensional, if `connectivity` is
+   *    neither 4 nor 8, or if `src` has more than 2^31 - 1 pixels
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<type::int32> label(
+    const array<_DType> &src, const unsigned connectivity = 8);
+  template<type _DType>
+  [[nodiscard]] array<type::int32> label(const array<_DType> &src,
+    std::vector<region> &regions, const unsigned connectivity = 8);
+
+}  // namespace devi::vis::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace devi::vis::internal
+{
+  namespace  // for internal linkage
+  {
+    // Foreground pixels [m_x0, m_x1) of row `m_y`
+    struct label_run {
+      std::uint32_t m_y, m_x0, m_x1;
+    };
+
+    // Runs of a strip of rows, with `m_rows[i]` the index of the first run of its row `i`
+    // (and a final element, the number of runs), and the union-find forest of the runs
+    struct label_strip {
+      std::vector<label_run> m_runs;
+      std::vector<std::uint32_t> m_rows, m_parent;
+      std::size_t m_offset;  // index of the first run of the strip among all runs
+    };
+
+    // Calls `emit(x0, x1)` for every run [x0, x1) of nonzero bytes of `row`
+    template<typename _Emit>
+    void scan_runs(const std::uint8_t *const row, const std::size_t W, _Emit &&emit)
+    {
+      std::size_t start { 0 };
+      bool inside { false };
+      for (std::size_t x { 0 }; x < W; x += 64) {
+        // one bit per pixel, then one bit per change of pixel (from the previous one)
+        const auto n { std::min<std::size_t>(64, W - x) };
+        std::uint64_t bits { 0 };
+        std::size_t i { 0 };
+#if defined(__AVX2__)
+        for (; i + 32 <= n; i += 32) {
+          const auto *const p { reinterpret_cast<const __m256i *>(row + x + i) };
+          const auto v { _mm256_loadu_si256(p) };
+          const auto zero { _mm256_cmpeq_epi8(v, _mm256_setzero_si256()) };
+          bits |= std::uint64_t(~std::uint32_t(_mm256_movemask_epi8(zero))) << i;
+        }
+#endif
+        for (; i < n; ++i) bits |= std::uint64_t(row[x + i] != 0) << i;
+        auto changes { bits ^ (bits << 1 | std::uint64_t(inside)) };
+        if (n < 64) changes &= (std::uint64_t(1) << n) - 1;
+        for (; changes; changes &= changes - 1) {
+          const auto at { x + std::size_t(__builtin_ctzll(changes)) };
+          if (inside) emit(start, at);
+          start  = at;
+          inside = !inside;
+        }
+      }
+      if (inside) emit(start, W);
+    }
+
+    // Returns the root of `i`, halving the path to it
+    inline std::uint32_t label_find(std::uint32_t *const parent, std::uint32_t i) noexcept
+    {
+      while (parent[i] != i) i = parent[i] = parent[parent[i]];
+      return i;
+    }
+
+    // Merges the trees of `a` and `b`, keeping the smaller root (so parents precede their
+    // children, in raster order)
+    inline void label_unite(
+      std::uint32_t *const parent, const std::uint32_t a, const std::uint32_t b) noexcept
+    {
+      const auto ra { label_find(parent, a) }, rb { label_find(parent, b) };
+      if (ra < rb)
+        parent[rb] = ra;
+      else
+        parent[ra] = rb;
+    }
+
+    /* Unites every run of [begin, end) with the runs of [above, begin) (the row above)
+     * which it touches, where `touch` is 1 if diagonal neighbours are connected, else 0
+     */
+    inline void label_rows(const label_run *const runs, std::uint32_t *const parent,
+      std::uint32_t above, const std::uint32_t begin, const std::uint32_t end,
+      const std::uint32_t touch) noexcept
+    {
+      const auto last { begin };
+      for (auto i { begin }; i < end; ++i) {
+        const auto &r { runs[i] };
+        while (above < last && runs[above].m_x1 + touch <= r.m_x0) ++above;
+        for (auto j { above }; j < last && runs[j].m_x0 < r.m_x1 + touch; ++j)
+          label_unite(parent, i, j);
+      }
+    }
+
+    // Returns the labels of `src`, and the statistics of its components if `regions`
+    template<type _DType>
+    array<type::int32> labelling(const array<_DType> &src,
+      std::vector<region> *const regions, const unsigned connectivity)
+    {
+      static_assert(_DType == type::bool8 || _DType == type::uint8,
+        "Labeling is only supported for `bool8` and `uint8` masks");
+      DEVI_PROFILE_SCOPE("vis::label");
+      const auto &s { src.shape() };
+      if (s.ndims() != 2)
+        throw std::invalid_argument { "Labeling: mask must be of shape (H, W)" };
+      if (connectivity != 4 && connectivity != 8)
+        throw std::invalid_argument { "Labeling: connectivity must be 4 or 8" };
+      if (src.size() > std::size_t(INT32_MAX))
+        throw std::invalid_argument { "Labeling: mask has too many pixels" };
+
+      const std::size_t H { s[0] }, W { s[1] };
+      const std::uint32_t touch { connectivity == 8 };
+      const auto *const in { reinterpret_cast<const std::uint8_t *>(src.data()) };
+      array<type::int32> ret { s };
+      if (regions) regions->clear();
+      if (src.size() == 0) return ret;
+
+      // runs of every strip, united within the strip
+      auto &threads { core::internal::thread_pool::instance() };
+      const auto parts { core::internal::partition_count(H, (1UL << 15) / W + 1) };
+      std::vector<label_strip> strips(parts);
+      threads.run(parts, [&](const unsigned p) {
+        const auto [begin, end] { core::internal::partition(H, parts, p) };
+        auto &strip { strips[p] };
+        for (auto y { begin }; y < end; ++y) {
+          strip.m_rows.push_back(std::uint32_t(strip.m_runs.size()));
+          scan_runs(in + y * W, W, [&](const std::size_t x0, const std::size_t x1) {
+            strip.m_runs.push_back(
+              { std::uint32_t(y), std::uint32_t(x0), std::uint32_t(x1) });
+          });
+        }
+        strip.m_rows.push_back(std::uint32_t(strip.m_runs.size()));
+        strip.m_parent.resize(strip.m_runs.size());
+        for (std::size_t i { 0 }; i < strip.m_parent.size(); ++i)
+          strip.m_parent[i] = std::uint32_t(i);
+        for (std::size_t r { 1 }; r + 1 < strip.m_rows.size(); ++r)
+          label_rows(strip.m_runs.data(), strip.m_parent.data(), strip.m_rows[r - 1],
+            strip.m_rows[r], strip.m_rows[r + 1], touch);
+      });
+
+      // one forest over all the runs, then the seams between strips
+      std::size_t total { 0 };
+      for (auto &strip : strips) {
+        strip.m_offset = total;
+        total += strip.m_runs.size();
+      }
+      std::vector<label_run> runs(total);
+      std::vector<std::uint32_t> parent(total);
+      for (const auto &strip : strips) {
+        const auto offset { std::uint32_t(strip.m_offset) };
+        std::copy(strip.m_runs.begin(), strip.m_runs.end(), runs.begin() + offset);
+        for (std::size_t i { 0 }; i < strip.m_parent.size(); ++i)
+          parent[offset + i] = offset + strip.m_parent[i];
+      }
+      for (unsigned p { 1 }; p < parts; ++p) {
+        const auto &top { strips[p - 1] }, &bottom { strips[p] };
+        const auto rows { top.m_rows.size() };
+        label_rows(runs.data(), parent.data(),
+          std::uint32_t(top.m_offset + top.m_rows[rows - 2]),
+          std::uint32_t(bottom.m_offset),
+          std::uint32_t(bottom.m_offset + bottom.m_rows[1]), touch);
+      }
+
+      // labels in the order of the roots (the first run of every component), replacing
+      // the parents, which always precede their children
+      std::uint32_t count { 0 };
+      for (std::size_t i { 0 }; i < total; ++i) {
+        parent[i] = parent[i] == i ? ++count : parent[parent[i]];
+        if (!regions) continue;
+        if (parent[i] > regions->size())
+          regions->push_back({ 0, runs[i].m_y, runs[i].m_x0, 0, runs[i].m_x1, 0, 0 });
+        auto &g { (*regions)[parent[i] - 1] };
+        const auto &r { runs[i] };
+        const std::size_t length { r.m_x1 - r.m_x0 };
+        g.m_area += length;
+        g.m_left   = std::min<std::size_t>(g.m_left, r.m_x0);
+        g.m_right  = std::max<std::size_t>(g.m_right, r.m_x1);
+        g.m_bottom = r.m_y + 1;
+        g.m_cy += double(r.m_y) * double(length);
+        g.m_cx += (double(r.m_x0) + double(r.m_x1 - 1)) / 2 * double(length);
+      }
+      if (regions)
+        for (auto &g : *regions) {
+          g.m_cy /= double(g.m_area);
+          g.m_cx /= double(g.m_area);
+        }
+
+      // every strip writes the labels of its runs (the background is already zero)
+      auto *const out { ret.data() };
+      threads.run(parts, [&](const unsigned p) {
+        const auto &strip { strips[p] };
+        for (auto i { strip.m_offset }; i < strip.m_offset + strip.m_runs.size(); ++i) {
+          const auto &r { runs[i] };
+          std::fill(out + r.m_y * W + r.m_x0, out + r.m_y * W + r.m_x1,
+            std::int32_t(parent[i]));
+        }
+      });
+      return ret;
+    }
+  }
+
+  template<type _DType>
+  array<type::int32> label(const array<_DType> &src, const unsigned connectivity)
+  {
+    return labelling(src, nullptr, connectivity);
+  }
+
+  template<type _DType>
+  array<type::int32> label(
+    const array<_DType> &src, std::vector<region> &regions, const unsigned connectivity)
+  {
+    return labelling(src, &regions, connectivity);
+  }
+
+}  // namespace devi::vis::internal
+
+#endif
@@ -0,0 +1,230 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_VIS_LAYOUT_HH_
+#define _HEADER_GUARD__DEVI_SRC_VIS_LAYOUT_HH_
+
+#include "../core/array.hh"
+#include "../core/parallel.hh"
+#include "__header_check__"
+
+#include <vector>
+
+namespace devi::vis::internal
+{
+  using core::internal::array;
+  using core::internal::shape;
+  using core::internal::type;
+  using core::internal::view;
+
+  /* Returns a planar (C, H, W) float32 copy of the interleaved (H, W, C) image `src`,
+   * with every channel normalized as `(x - mean[c]) / stddev[c]` in the same pass
+   * Empty `mean` and `stddev` arguments default to 0 and 1 respectively for all channels
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `src` is not 3-dimensional
+   * 2) `std::invalid_argument` if a non-empty `mean` or `stddev` does not have exactly
+   *    one value per channel
+   * 3) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<type::float32> to_planar(const array<_DType> &src,
+    const std::vector<float> &mean = {}, const std::vector<float> &stddev = {});
+  template<type _DType>
+  [[nodiscard]] array<type::float32> to_planar(const view<_DType> &src,
+    const std::vector<float> &mean = {}, const std::vector<float> &stddev = {});
+
+  /* Same as above, but writes the result directly into slot `n` of the preallocated
+   * (N, C, H, W) batch `dst`
+   *
+   * Errors:
+   * 1) all the errors listed above
+   * 2) `std::invalid_argument` if `dst` is not of shape (N, C, H, W)
+   * 3) `std::out_of_range` if `n` is not less than N
+   */
+  template<type _DType>
+  void to_planar(const array<_DType> &src, array<type::float32> &dst, const std::size_t n,
+    const std::vector<float> &mean = {}, const std::vector<float> &stddev = {});
+  template<type _DType>
+  void to_planar(const view<_DType> &src, array<type::float32> &dst, const std::size_t n,
+    const std::vector<float> &mean = {}, const std::vector<float> &stddev = {});
+
+}  // namespace devi::vis::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+namespace devi::vis::internal
+{
+  namespace  // for internal linkage
+  {
+    // Memory layout of an interleaved (H, W, C) image window
+    template<typename _Native>
+    struct interleaved {
+      const _Native *p_data;
+      std::size_t m_height, m_width, m_channels;
+      std::size_t m_row, m_col, m_chan;  // strides (in elements) of every dimension
+    };
+
+    template<type _DType>
+    interleaved<typename core::internal::native_type<_DType>::type> layout_of(
+      const array<_DType> &src)
+    {
+      if (src.ndims() != 3)
+        throw std::invalid_argument { "Layout: source image must be of shape (H, W, C)" };
+
+      const auto &s { src.shape() };
+      return { src.data(), s[0], s[1], s[2], s[1] * s[2], s[2], 1 };
+    }
+
+    template<type _DType>
+    interleaved<typename core::internal::native_type<_DType>::type> layout_of(
+      const view<_DType> &src)
+    {
+      if (src.ndims() != 3)
+        throw std::invalid_argument { "Layout: source image must be of shape (H, W, C)" };
+
+      const auto &s { src.shape() };
+      const auto &t { src.stride() };
+      return { src.data(), s[0], s[1], s[2], t[0], t[1], t[2] };
+    }
+
+    /* Converts rows [begin, end) of `src` into planes of `dst` as `x * scale + bias`
+     * A non-zero `_Channels` fixes the channel count at compile-time for unrolling
+     */
+    template<unsigned _Channels, typename _Native>
+    void deinterleave(const interleaved<_Native> &src, float *const dst,
+      const float *const scale, const float *const bias, const std::size_t begin,
+      const std::size_t end) noexcept
+    {
+      const std::size_t C { _Channels ? _Channels : src.m_channels };
+      const std::size_t W { src.m_width }, plane { src.m_height * W };
+
+      for (auto y { begin }; y < end; ++y) {
+        const _Native *const row { src.p_data + y * src.m_row };
+        float *const out { dst + y * W };
+
+        if (src.m_chan == 1 && src.m_col == C)  // densely packed pixels
+          for (std::size_t x { 0 }; x < W; ++x)
+            for (std::size_t c { 0 }; c < C; ++c)
+              out[c * plane + x]
+                = static_cast<float>(row[x * C + c]) * scale[c] + bias[c];
+        else
+          for (std::size_t x { 0 }; x < W; ++x)
+            for (std::size_t c { 0 }; c < C; ++c)
+              out[c * plane + x]
+                = static_cast<float>(row[x * src.m_col + c * src.m_chan]) * scale[c]
+                + bias[c];
+      }
+    }
+
+    // Fused deinterleave-convert-normalize kernel writing planes starting at `dst`
+    template<typename _Native>
+    void to_planar(const interleaved<_Native> &src, float *const dst,
+      const std::vector<float> &mean, const std::vector<float> &stddev)
+    {
+      DEVI_PROFILE_SCOPE("vis::to_planar");
+      const auto C { src.m_channels };
+      if ((!mean.empty() && mean.size() != C) || (!stddev.empty() && stddev.size() != C))
+        throw std::invalid_argument {
+          "Layout: `mean` and `stddev` must have exactly one value per channel"
+        };
+
+      // (x - mean) / stddev == x * scale + bias
+      std::vector<float> scale(C, 1.0F), bias(C, 0.0F);
+      for (std::size_t c { 0 }; c < C; ++c) {
+        if (!stddev.empty()) scale[c] = 1.0F / stddev[c];
+        if (!mean.empty()) bias[c] = -mean[c] * scale[c];
+      }
+
+      auto kernel { &deinterleave<0, _Native> };
+      switch (C) {
+        case 1: kernel = &deinterleave<1, _Native>; break;
+        case 3: kernel = &deinterleave<3, _Native>; break;
+        case 4: kernel = &deinterleave<4, _Native>; break;
+      }
+
+      // atleast ~16K elements per thread, so that small crops stay single-threaded
+      const std::size_t grain { 1 + (1UL << 14) / (src.m_width * C + 1) };
+      core::internal::parallel_for(
+        src.m_height,
+        [&](const std::size_t begin, const std::size_t end) {
+          kernel(src, dst, scale.data(), bias.data(), begin, end);
+        },
+        grain);
+    }
+
+    // Returns a pointer to slot `n` of the batch `dst` after validating it against `src`
+    template<typename _Native>
+    float *batch_slot(
+      const interleaved<_Native> &src, array<type::float32> &dst, const std::size_t n)
+    {
+      const auto &s { dst.shape() };
+      if (s.ndims() != 4 || s[1] != src.m_channels || s[2] != src.m_height
+          || s[3] != src.m_width)
+        throw std::invalid_argument {
+          "Layout: destination batch must be of shape (N, C, H, W) matching the source"
+        };
+      if (n >= s[0])
+        throw std::out_of_range { "Layout: batch slot is out of bounds for destination" };
+
+      return dst.data() + n * s[1] * s[2] * s[3];
+    }
+
+    template<typename _Native>
+    array<type::float32> to_planar(const interleaved<_Native> &src,
+      const std::vector<float> &mean, const std::vector<float> &stddev)
+    {
+      // NOTE: every element is overwritten, zero-initialization is only for safety
+      array<type::float32> ret { shape(src.m_channels, src.m_height, src.m_width) };
+      to_planar(src, ret.data(), mean, stddev);
+      return ret;
+    }
+  }
+
+  template<type _DType>
+  array<type::float32> to_planar(const array<_DType> &src, const std::vector<float> &mean,
+    const std::vector<float> &stddev)
+  {
+    return to_planar(layout_of(src), mean, stddev);
+  }
+
+  template<type _DType>
+  array<type::float32> to_planar(const view<_DType> &src, const std::vector<float> &mean,
+    const std::vector<float> &stddev)
+  {
+    return to_planar(layout_of(src), mean, stddev);
+  }
+
+  template<type _DType>
+  void to_planar(const array<_DType> &src, array<type::float32> &dst, const std::size_t n,
+    const std::vector<float> &mean, const std::vector<float> &stddev)
+  {
+    const auto layout { layout_of(src) };
+    to_planar(layout, batch_slot(layout, dst, n), mean, stddev);
+  }
+
+  template<type _DType>
+  void to_planar(const view<_DType> &src, array<type::float32> &dst, const std::size_t n,
+    const std::vector<float> &mean, const std::vector<float> &stddev)
+  {
+    const auto layout { layout_of(src) };
+    to_planar(layout, batch_slot(layout, dst, n), mean, stddev);
+  }
+
+}  // namespace devi::vis::internal
+
+#endif
@@ -0,0 +1,345 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_VIS_MORPHOLOGY_HH_
+#define _HEADER_GUARD__DEVI_SRC_VIS_MORPHOLOGY_HH_
+
+#include "../core/array.hh"
+#include "../core/parallel.hh"
+#include "__header_check__"
+
+namespace devi::vis::internal
+{
+  using core::internal::array;
+  using core::internal::shape;
+  using core::internal::type;
+
+  /* Returns the erosion (minimum) or the dilation (maximum) of the (H, W) or (H, W, C)
+   * image `src` over a rectangular structuring element of `kh` x `kw` pixels, anchored at
+   * its center pixel (kh / 2, kw / 2); channels are filtered independently, and pixels
+   * outside the image are ignored
+   *
+   * `bool8` masks are eroded and dilated as binary images. The rectangle is separated
+   * into a horizontal and a vertical pass, each of which costs a constant number of
+   * comparisons per pixel whatever the size of the element (van Herk/Gil-Werman), while
+   * small elements compare whole rows of pixels at once
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `src` is neither 2- nor 3-dimensional, or if `kh` or
+   *    `kw` is zero
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<_DType> erode(
+    const array<_DType> &src, const std::size_t kh, const std::size_t kw);
+  template<type _DType>
+  [[nodiscard]] array<_DType> dilate(
+    const array<_DType> &src, const std::size_t kh, const std::size_t kw);
+
+  /* Returns the opening (erosion followed by dilation) or the closing (dilation followed
+   * by erosion) of `src`, i.e. removes the bright or the dark details smaller than the
+   * structuring element, like specks and holes of a mask
+   *
+   * Errors:
+   * Same as `erode`
+   */
+  template<type _DType>
+  [[nodiscard]] array<_DType> open(
+    const array<_DType> &src, const std::size_t kh, const std::size_t kw);
+  template<type _DType>
+  [[nodiscard]] array<_DType> close(
+    const array<_DType> &src, const std::size_t kh, const std::size_t kw);
+
+  /* Returns the morphological gradient (dilation minus erosion) of `src`, i.e. the
+   * boundaries of the regions of a mask
+   *
+   * Errors:
+   * Same as `erode`
+   */
+  template<type _DType>
+  [[nodiscard]] array<_DType> gradient(
+    const array<_DType> &src, const std::size_t kh, const std::size_t kw);
+
+}  // namespace devi::vis::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace devi::vis::internal
+{
+  namespace  // for internal linkage
+  {
+    // largest window filtered directly (above it, van Herk/Gil-Werman is cheaper)
+    constexpr std::size_t morphology_direct { 4 };
+    // elements of every row filtered at a time by the vertical pass, to stay in L2
+    constexpr std::size_t morphology_tile { 4096 };
+
+    // Writes the element-wise minimum (or maximum) of `n` elements of `a` and `b`
+    template<bool _Max, typename _Type>
+    void extremum(_Type *const dst, const _Type *const a, const _Type *const b,
+      const std::size_t n) noexcept
+    {
+      std::size_t i { 0 };
+#if defined(__AVX2__)
+      if constexpr (sizeof(_Type) == 1)  // (bool8, uint8 and int8) 32 pixels at a time
+        for (; i + 32 <= n; i += 32) {
+          const auto x { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)) };
+          const auto y { _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)) };
+          __m256i z;
+          if constexpr (std::is_signed_v<_Type>)
+            z = _Max ? _mm256_max_epi8(x, y) : _mm256_min_epi8(x, y);
+          else
+            z = _Max ? _mm256_max_epu8(x, y) : _mm256_min_epu8(x, y);
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), z);
+        }
+#endif
+      for (; i < n; ++i) dst[i] = _Max ? std::max(a[i], b[i]) : std::min(a[i], b[i]);
+    }
+
+    /* Writes `n` output lines of `length` elements with `out(i)`, every one of which is
+     * the minimum (or maximum) of the input lines [i, i + k) returned by `line(j)`
+     *
+     * Above `morphology_direct`, outputs are taken in blocks of `k` (van Herk and
+     * Gil-Werman): all the windows of a block contain its last input line, so every
+     * window is the extremum of a suffix of the lines up to it (computed backwards into
+     * `scratch`) and a prefix of the lines after it (accumulated forwards), i.e. three
+     * comparisons per element whatever `k` is
+     */
+    template<bool _Max, typename _Type, typename _Line, typename _Out>
+    void filter_lines(const _Line &line, const _Out &out, const std::size_t n,
+      const std::size_t length, const std::size_t k, std::vector<_Type> &scratch)
+    {
+      if (k == 1)
+        for (std::size_t i { 0 }; i < n; ++i) std::copy_n(line(i), length, out(i));
+      else if (k <= morphology_direct)
+        for (std::size_t i { 0 }; i < n; ++i) {
+          extremum<_Max>(out(i), line(i), line(i + 1), length);
+          for (std::size_t t { 2 }; t < k; ++t)
+            extremum<_Max>(out(i), out(i), line(i + t), length);
+        }
+      else {
+        scratch.resize((k + 1) * length);
+        auto *const suffix { scratch.data() };  // line `t` is the extremum of [b + t, c]
+        auto *const prefix { suffix + k * length };
+        for (std::size_t b { 0 }; b < n; b += k) {
+          const auto c { b + k - 1 };
+          std::copy_n(line(c), length, suffix + (k - 1) * length);
+          for (auto t { k - 1 }; t-- > 0;)
+            extremum<_Max>(
+              suffix + t * length, line(b + t), suffix + (t + 1) * length, length);
+          std::copy_n(suffix, length, out(b));
+
+          const auto m { std::min(k, n - b) };
+          if (m > 1) std::copy_n(line(c + 1), length, prefix);
+          for (std::size_t t { 1 }; t < m; ++t) {
+            if (t > 1) extremum<_Max>(prefix, prefix, line(c + t), length);
+            extremum<_Max>(out(b + t), suffix + t * length, prefix, length);
+          }
+        }
+      }
+    }
+
+    /* Writes the `W` pixels (of `C` elements) of `out`, every one of which is the
+     * minimum (or maximum) of the pixels [x, x + k) of the padded row `in`
+     *
+     * The same blocks of `k` pixels as in `filter_lines`, but within a contiguous row:
+     * `forward` holds the extrema of every block from its first pixel and `backward` the
+     * extrema up to its last pixel, so that the window of every pixel is the extremum of
+     * one value of each, taken for whole rows at a time
+     */
+    template<bool _Max, typename _Type>
+    void filter_row(const _Type *const in, _Type *const out, const std::size_t W,
+      const std::size_t C, const std::size_t k, _Type *const forward,
+      _Type *const backward) noexcept
+    {
+      const std::size_t n { (W + k - 1) * C }, block { k * C };
+      const auto pick { [](const _Type a, const _Type b) {
+        return _Max ? std::max(a, b) : std::min(a, b);
+      } };
+      // running extrema stay in a register (reading them back would stall every step)
+      for (std::size_t b { 0 }; b < n; b += block) {
+        const auto e { std::min(n, b + block) };
+        for (auto c { b }; c < b + C; ++c) {
+          auto acc { in[c] };
+          for (auto i { c }; i < e; i += C) forward[i] = acc = pick(acc, in[i]);
+          acc = in[e - C + c - b];
+          for (auto i { e + c - b }; i > c;) {
+            i -= C;
+            backward[i] = acc = pick(acc, in[i]);
+          }
+        }
+      }
+      extremum<_Max>(out, backward, forward + (k - 1) * C, W * C);
+    }
+
+    // Returns the (H, W, C) extents of a 2- or 3-dimensional image shape
+    inline std::tuple<std::size_t, std::size_t, std::size_t> morphology_extents(
+      const shape &s, const std::size_t kh, const std::size_t kw)
+    {
+      if (s.ndims() != 2 && s.ndims() != 3)
+        throw std::invalid_argument { "Morphology: image must be of shape (H, W[, C])" };
+      if (kh == 0 || kw == 0)
+        throw std::invalid_argument { "Morphology: structuring element is empty" };
+      return { s[0], s[1], s.ndims() == 3 ? s[2] : 1 };
+    }
+
+    // Returns the value which never wins a minimum (or a maximum, if `_Max`)
+    template<bool _Max, typename _Native>
+    constexpr _Native morphology_identity() noexcept
+    {
+      using limits = std::numeric_limits<_Native>;
+      if constexpr (limits::has_infinity)
+        return _Max ? -limits::infinity() : limits::infinity();
+      else
+        return _Max ? limits::lowest() : limits::max();
+    }
+
+    // Returns the erosion (or dilation, if `_Max`) of `src`
+    template<bool _Max, type _DType>
+    array<_DType> morphology(const array<_DType> &src, const std::size_t kh,
+      const std::size_t kw)
+    {
+      static_assert(_DType != type::float16 && _DType != type::bfloat16,
+        "Morphology is not supported for `float16` and `bfloat16` images");
+      DEVI_PROFILE_SCOPE("vis::morphology");
+      // masks are filtered as bytes (of zeros and ones)
+      using native = typename core::internal::native_type<_DType>::type;
+      using word = std::conditional_t<std::is_same_v<native, bool>, std::uint8_t, native>;
+      constexpr auto identity { morphology_identity<_Max, word>() };
+
+      const auto [H, W, C] { morphology_extents(src.shape(), kh, kw) };
+      const std::size_t row { W * C };
+      array<_DType> ret { src.shape() };
+      if (src.size() == 0) return ret;
+      const auto *const in { reinterpret_cast<const word *>(src.data()) };
+      auto *const out { reinterpret_cast<word *>(ret.data()) };
+
+      // horizontal pass (unless the element is a column), one padded row at a time
+      const word *rows { in };
+      std::vector<word> across(kw > 1 && kh > 1 ? H * row : 0);
+      if (kw > 1) {
+        auto *const target { kh > 1 ? across.data() : out };
+        const std::size_t left { kw / 2 * C }, padded { (W + kw - 1) * C };
+        core::internal::parallel_for(
+          H,
+          [&](const std::size_t begin, const std::size_t end) {
+            std::vector<word> buffer(padded, identity), forward, backward;
+            if (kw > morphology_direct) {
+              forward.resize(padded);
+              backward.resize(padded);
+            }
+            for (auto y { begin }; y < end; ++y) {
+              std::copy_n(in + y * row, row, buffer.data() + left);
+              auto *const dst { target + y * row };
+              if (kw <= morphology_direct) {  // whole rows of pixels at a time
+                extremum<_Max>(dst, buffer.data(), buffer.data() + C, row);
+                for (std::size_t t { 2 }; t < kw; ++t)
+                  extremum<_Max>(dst, dst, buffer.data() + t * C, row);
+                continue;
+              }
+              filter_row<_Max>(
+                buffer.data(), dst, W, C, kw, forward.data(), backward.data());
+            }
+          },
+          (1UL << 15) / row + 1);
+        if (kh == 1) return ret;
+        rows = across.data();
+      }
+
+      // vertical pass, a band of rows and a tile of columns at a time
+      const std::size_t top { kh / 2 };
+      core::internal::parallel_for(
+        H,
+        [&](const std::size_t begin, const std::size_t end) {
+          std::vector<word> edge(std::min(row, morphology_tile), identity), scratch;
+          for (std::size_t x { 0 }; x < row; x += morphology_tile) {
+            const auto length { std::min(morphology_tile, row - x) };
+            // line `j` of the band is row `begin + j - top` of the image
+            const auto line { [&](const std::size_t j) {
+              const auto y { begin + j };
+              return y < top || y - top >= H ? edge.data() : rows + (y - top) * row + x;
+            } };
+            filter_lines<_Max>(line,
+              [&](const std::size_t i) { return out + (begin + i) * row + x; },
+              end - begin, length, kh, scratch);
+          }
+        },
+        (1UL << 15) / row + 1);
+      return ret;
+    }
+  }
+
+  template<type _DType>
+  array<_DType> erode(
+    const array<_DType> &src, const std::size_t kh, const std::size_t kw)
+  {
+    return morphology<false>(src, kh, kw);
+  }
+
+  template<type _DType>
+  array<_DType> dilate(
+    const array<_DType> &src, const std::size_t kh, const std::size_t kw)
+  {
+    return morphology<true>(src, kh, kw);
+  }
+
+  template<type _DType>
+  array<_DType> open(
+    const array<_DType> &src, const std::size_t kh, const std::size_t kw)
+  {
+    return morphology<true>(morphology<false>(src, kh, kw), kh, kw);
+  }
+
+  template<type _DType>
+  array<_DType> close(
+    const array<_DType> &src, const std::size_t kh, const std::size_t kw)
+  {
+    return morphology<false>(morphology<true>(src, kh, kw), kh, kw);
+  }
+
+  template<type _DType>
+  array<_DType> gradient(
+    const array<_DType> &src, const std::size_t kh, const std::size_t kw)
+  {
+    using native = typename core::internal::native_type<_DType>::type;
+    auto ret { morphology<true>(src, kh, kw) };
+    const auto eroded { morphology<false>(src, kh, kw) };
+    auto *const out { ret.data() };
+    const auto *const in { eroded.data() };
+    core::internal::parallel_for(
+      ret.size(),
+      [&](const std::size_t begin, const std::size_t end) {
+        for (auto i { begin }; i < end; ++i) out[i] = native(out[i] - in[i]);
+      },
+      1UL << 15);
+    return ret;
+  }
+
+}  // namespace devi::vis::internal
+
+#endif
@@ -0,0 +1,679 @@
+// DeVi: C++17 library for Computer Vision and Deep Learning
+// Copyright (C) 2023 Dasu Pradyumna dasupradyumna@gmail.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef _HEADER_GUARD__DEVI_SRC_VIS_PYRAMID_HH_
+#define _HEADER_GUARD__DEVI_SRC_VIS_PYRAMID_HH_
+
+#include "../core/array.hh"
+#include "../core/parallel.hh"
+#include "__header_check__"
+
+#include <vector>
+
+namespace devi::vis::internal
+{
+  using core::internal::array;
+  using core::internal::shape;
+  using core::internal::type;
+  using core::internal::view;
+
+  /* Gaussian pyramid of (H, W) or (H, W, C) images, whose level i + 1 is level i blurred
+   * by the 5x5 binomial kernel and downsampled by 2 (keeping the even rows and columns),
+   * i.e. of shape ((H + 1) / 2, (W + 1) / 2[, C]); borders are reflected without
+   * repeating the edge pixels
+   *
+   * All the levels live in a single allocation (each one starting on a cache line), so
+   * building the pyramid of a new frame of the same shape allocates nothing, and the
+   * views of the levels stay valid across frames. Every level is computed in one pass
+   * over the previous one, blurring only the pixels that are kept
+   */
+  template<type _DType>
+  class pyramid {
+    using native_type = typename core::internal::native_type<_DType>::type;
+
+  public:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    /* Constructs a pyramid of `levels` levels (including the base) for images of shape
+     * `base`, whose levels are all zero
+     *
+     * Errors:
+     * 1) `std::invalid_argument` if `base` is neither 2- nor 3-dimensional, or if
+     *    `levels` is zero
+     * 2) `new` can throw an `std::bad_alloc` exception
+     */
+    pyramid(const class shape &base, const std::size_t levels);
+
+    /* Constructs the pyramid of `levels` levels of `image`
+     *
+     * Errors:
+     * Same as the constructor from a shape
+     */
+    pyramid(const array<_DType> &image, const std::size_t levels);
+
+    ////////////////////////////// GENERAL ///////////////////////////////
+
+    /* Copies `image` into the base level and recomputes all the other levels, reusing
+     * the allocation of the pyramid
+     *
+     * Errors:
+     * `std::invalid_argument` if the shape of `image` is not the shape of the base
+     */
+    void build(const array<_DType> &image);
+
+    /* Recomputes all the levels above the base from its current contents, e.g. after a
+     * frame was written straight into `level(0)`
+     *
+     * Errors:
+     * `new` can throw an `std::bad_alloc` exception
+     */
+    void build();
+
+    ////////////////////////////// GETTERS ///////////////////////////////
+
+    // Returns the number of levels, including the base
+    [[nodiscard]] std::size_t levels() const noexcept;
+
+    /* Returns the shape of level `i`
+     *
+     * Errors:
+     * `std::out_of_range` if `i` is not less than `levels()`
+     */
+    [[nodiscard]] const class shape &shape(const std::size_t i) const;
+
+    /* Returns a view of level `i`, which shares the memory of the pyramid (so it must
+     * not outlive it)
+     *
+     * Errors:
+     * `std::out_of_range` if `i` is not less than `levels()`
+     */
+    [[nodiscard]] view<_DType> level(const std::size_t i);
+
+    // Returns the size (in bytes) of the allocation holding all the levels
+    [[nodiscard]] std::size_t bytes() const noexcept;
+
+  private:
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    std::vector<class shape> m_shapes;
+    std::vector<std::size_t> m_offsets;  // of the first element of every level
+    array<_DType> m_storage;
+
+  };  // class pyramid
+
+  // Datatype of the Laplacian levels of images of datatype `_DType` (which holds the
+  // differences of any two of their pixels)
+  template<type _DType>
+  static constexpr type laplacian_type {
+    _DType == type::uint8 || _DType == type::int8       ? type::int16
+    : _DType == type::uint16 || _DType == type::int16 ? type::int32
+                                                        : _DType
+  };
+
+  /* Laplacian pyramid of (H, W) or (H, W, C) images, whose level i is the difference
+   * between the levels i and i + 1 of their Gaussian pyramid (see `pyramid`), the
+   * latter expanded back to the shape of the former (see `expand`), and whose last level
+   * is the last level of the Gaussian pyramid; integer images are stored in a wider
+   * signed datatype, so that `reconstruct` gives back the image exactly
+   *
+   * All the levels live in a single allocation, and the Gaussian levels are computed in
+   * it before being replaced by the Laplacian levels from the base up, so no other
+   * memory is used while building
+   */
+  template<type _DType>
+  class laplacian_pyramid {
+    using native_type = typename core::internal::native_type<_DType>::type;
+    using level_type =
+      typename core::internal::native_type<laplacian_type<_DType>>::type;
+
+  public:
+    //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+    /* Constructs a pyramid of `levels` levels (including the base) for images of shape
+     * `base`, whose levels are all zero
+     *
+     * Errors:
+     * Same as the constructor of `pyramid` from a shape
+     */
+    laplacian_pyramid(const class shape &base, const std::size_t levels);
+
+    /* Constructs the Laplacian pyramid of `levels` levels of `image`
+     *
+     * Errors:
+     * Same as the constructor of `pyramid` from a shape
+     */
+    laplacian_pyramid(const array<_DType> &image, const std::size_t levels);
+
+    ////////////////////////////// GENERAL ///////////////////////////////
+
+    /* Recomputes all the levels from `image`, reusing the allocation of the pyramid
+     *
+     * Errors:
+     * 1) `std::invalid_argument` if the shape of `image` is not the shape of the base
+     * 2) `new` can throw an `std::bad_alloc` exception
+     */
+    void build(const array<_DType> &image);
+
+    /* Returns the image whose Laplacian pyramid are the current levels, i.e. expands
+     * every level and adds it to the one below, from the last level down to the base
+     * (the result is converted like `astype` into the datatype of the image)
+     *
+     * Errors:
+     * `new` can throw an `std::bad_alloc` exception
+     */
+    [[nodiscard]] array<_DType> reconstruct() const;
+
+    ////////////////////////////// GETTERS ///////////////////////////////
+
+    // Returns the number of levels, including the base
+    [[nodiscard]] std::size_t levels() const noexcept;
+
+    /* Returns the shape of level `i`
+     *
+     * Errors:
+     * `std::out_of_range` if `i` is not less than `levels()`
+     */
+    [[nodiscard]] const class shape &shape(const std::size_t i) const;
+
+    /* Returns a view of level `i`, which shares the memory of the pyramid (so it must
+     * not outlive it), and can be edited before `reconstruct` (e.g. to blend images)
+     *
+     * Errors:
+     * `std::out_of_range` if `i` is not less than `levels()`
+     */
+    [[nodiscard]] view<laplacian_type<_DType>> level(const std::size_t i);
+
+    // Returns the size (in bytes) of the allocation holding all the levels
+    [[nodiscard]] std::size_t bytes() const noexcept;
+
+  private:
+    ///////////////////////////// ATTRIBUTES /////////////////////////////
+
+    std::vector<class shape> m_shapes;
+    std::vector<std::size_t> m_offsets;  // of the first element of every level
+    array<laplacian_type<_DType>> m_storage;
+
+  };  // class laplacian_pyramid
+
+  /* Returns `src` upsampled by 2 to the shape `target` (of a level below it in a
+   * pyramid), i.e. with zeros inserted after every row and column, blurred by the 5x5
+   * binomial kernel (times 4), and with borders reflected without repeating the edge
+   * pixels
+   *
+   * Errors:
+   * 1) `std::invalid_argument` if `src` is neither 2- nor 3-dimensional, or if `target`
+   *    is not the shape of an image which `pyramid` would downsample to `src`
+   * 2) `new` can throw an `std::bad_alloc` exception
+   */
+  template<type _DType>
+  [[nodiscard]] array<_DType> expand(const array<_DType> &src, const class shape &target);
+  template<type _DType>
+  [[nodiscard]] array<_DType> expand(const view<_DType> &src, const class shape &target);
+
+}  // namespace devi::vis::internal
+
+//////////////////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////// IMPLEMENTATION /////////////////////////////////////
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+namespace devi::vis::internal
+{
+  namespace  // for internal linkage
+  {
+    // Datatype in which the binomial kernel accumulates pixels of the native type `_Type`
+    template<typename _Type>
+    using pyramid_sum = std::conditional_t<std::is_floating_point_v<_Type>, _Type,
+      std::conditional_t<(sizeof(_Type) <= 2), std::int32_t, std::int64_t>>;
+
+    // Returns the index of `i` (atleast -2) reflected into [0, n) about its end elements
+    inline std::size_t pyramid_reflect(std::ptrdiff_t i, const std::ptrdiff_t n) noexcept
+    {
+      if (n == 1) return 0;
+      while (i < 0 || i >= n) i = i < 0 ? -i : 2 * (n - 1) - i;
+      return std::size_t(i);
+    }
+
+    // Returns the shapes of `levels` pyramid levels over images of shape `base`
+    inline std::vector<shape> pyramid_shapes(const shape &base, const std::size_t levels)
+    {
+      if (base.ndims() != 2 && base.ndims() != 3)
+        throw std::invalid_argument { "Pyramid: image must be of shape (H, W[, C])" };
+      if (levels == 0)
+        throw std::invalid_argument { "Pyramid: atleast one level is required" };
+
+      std::vector<shape> ret { base };
+      std::size_t dims[3] { base[0], base[1], base.ndims() == 3 ? base[2] : 1 };
+      while (ret.size() < levels) {
+        dims[0] = (dims[0] + 1) / 2;
+        dims[1] = (dims[1] + 1) / 2;
+        ret.push_back(shape::from_dims(dims, base.ndims()));
+      }
+      return ret;
+    }
+
+    // Returns the offsets of the levels of `shapes` in a single allocation, each one
+    // rounded up to a cache line, followed by the total number of elements
+    template<typename _Type>
+    std::vector<std::size_t> pyramid_offsets(const std::vector<shape> &shapes)
+    {
+      constexpr std::size_t line { std::max<std::size_t>(64 / sizeof(_Type), 1) };
+      std::vector<std::size_t> ret { 0 };
+      for (const auto &s : shapes)
+        ret.push_back((ret.back() + s.size() + line - 1) / line * line);
+      return ret;
+    }
+
+    /* Writes the (H, W, C) image `src`, blurred by the 5x5 binomial kernel and keeping
+     * the even rows and columns, into `dst`
+     *
+     * Every output row sums its five input rows into a row of partial sums (vertical
+     * pass, over contiguous rows), then sums five partial sums for every kept column
+     */
+    template<typename _Type>
+    void pyramid_down(const _Type *const src, const std::size_t H, const std::size_t W,
+      const std::size_t C, _Type *const dst)
+    {
+      using sum = pyramid_sum<_Type>;
+      const std::size_t Hd { (H + 1) / 2 }, Wd { (W + 1) / 2 }, row { W * C };
+      // the 16 * 16 of the kernel normalization, with rounding for integers
+      const auto narrow { [](const sum s) {
+        if constexpr (std::is_floating_point_v<_Type>)
+          return _Type(s * sum(1.0 / 256));
+        else
+          return _Type((s + 128) >> 8);
+      } };
+      // columns with all five taps inside the image
+      const std::size_t first { std::min<std::size_t>(1, Wd) },
+        last { W >= 3 ? std::max((W - 3) / 2 + 1, first) : first };
+
+      core::internal::parallel_for(
+        Hd,
+        [&](const std::size_t begin, const std::size_t end) {
+          std::vector<sum> sums(row);
+          for (auto y { begin }; y < end; ++y) {
+            const _Type *r[5];
+            for (std::ptrdiff_t k { 0 }; k < 5; ++k)
+              r[k] = src + pyramid_reflect(std::ptrdiff_t(2 * y) + k - 2, H) * row;
+            for (std::size_t i { 0 }; i < row; ++i)
+              sums[i] = sum(r[0][i]) + sum(r[4][i]) + 4 * (sum(r[1][i]) + sum(r[3][i]))
+                + 6 * sum(r[2][i]);
+
+            auto *const out { dst + y * Wd * C };
+            const auto border { [&](const std::size_t x) {
+              std::size_t taps[5];
+              for (std::ptrdiff_t k { 0 }; k < 5; ++k)
+                taps[k] = pyramid_reflect(std::ptrdiff_t(2 * x) + k - 2, W) * C;
+              for (std::size_t c { 0 }; c < C; ++c)
+                out[x * C + c] = narrow(sums[taps[0] + c] + sums[taps[4] + c]
+                  + 4 * (sums[taps[1] + c] + sums[taps[3] + c]) + 6 * sums[taps[2] + c]);
+            } };
+            for (std::size_t x { 0 }; x < first; ++x) border(x);
+            if (C == 1)  // the common case, without the inner loop over channels
+              for (auto x { first }; x < last; ++x) {
+                const auto *const s { sums.data() + 2 * x - 2 };
+                out[x] = narrow(s[0] + s[4] + 4 * (s[1] + s[3]) + 6 * s[2]);
+              }
+            else
+              for (auto x { first }; x < last; ++x) {
+                const auto *const s { sums.data() + (2 * x - 2) * C };
+                for (std::size_t c { 0 }; c < C; ++c)
+                  out[x * C + c] = narrow(s[c] + s[4 * C + c]
+                    + 4 * (s[C + c] + s[3 * C + c]) + 6 * s[2 * C + c]);
+              }
+            for (auto x { last }; x < Wd; ++x) border(x);
+          }
+        },
+        (1UL << 15) / (row + 1) + 1);
+    }
+
+    /* Source pixels (atmost 3) and their weights (in eighths) of every pixel of a
+     * dimension of `T` pixels upsampled from (T + 1) / 2 pixels, which holds the source
+     * pixels at its even positions (and zeros elsewhere) and is reflected about its end
+     * pixels, then blurred by the binomial kernel (times 2)
+     */
+    struct pyramid_taps {
+      std::vector<std::size_t> m_index;
+      std::vector<std::int32_t> m_weight;
+
+      explicit pyramid_taps(const std::size_t T) : m_index(3 * T), m_weight(3 * T)
+      {
+        constexpr std::int32_t kernel[5] { 1, 4, 6, 4, 1 };
+        if (T == 1) m_weight[0] = 8;  // a single pixel has nothing to reflect about
+        for (std::size_t t { 0 }; T > 1 && t < T; ++t) {
+          auto *const index { m_index.data() + 3 * t };
+          auto *const weight { m_weight.data() + 3 * t };
+          std::size_t n { 0 };
+          for (std::ptrdiff_t k { 0 }; k < 5; ++k) {
+            const auto u {
+              pyramid_reflect(std::ptrdiff_t(t) + k - 2, std::ptrdiff_t(T)) };
+            if (u % 2) continue;
+            std::size_t i { 0 };
+            while (i < n && index[i] != u / 2) ++i;
+            if (i == n) index[n++] = u / 2;
+            weight[i] += kernel[k];
+          }
+        }
+      }
+    };
+
+    /* Writes the (Ht + 1) / 2 x (Wt + 1) / 2 x C image `src` upsampled to the shape
+     * (Ht, Wt, C) into `dst` (see `expand`), combining every pixel `v` with the pixel `d`
+     * already in `dst` as `d = combine(d, v)`
+     *
+     * Every output row sums its (atmost 3) input rows into a row of partial sums, then
+     * sums the (atmost 3) partial sums of every output column
+     */
+    template<typename _Type, typename _Combine>
+    void pyramid_up(const _Type *const src, const std::size_t C, _Type *const dst,
+      const std::size_t Ht, const std::size_t Wt, const _Combine &combine)
+    {
+      using sum = pyramid_sum<_Type>;
+      const std::size_t row { (Wt + 1) / 2 * C };
+      // the 8 * 8 of the kernel normalization, with rounding for integers
+      const auto narrow { [](const sum s) {
+        if constexpr (std::is_floating_point_v<_Type>)
+          return _Type(s * sum(1.0 / 64));
+        else
+          return _Type((s + 32) >> 6);
+      } };
+      const pyramid_taps rows { Ht }, cols { Wt };
+
+      core::internal::parallel_for(
+        Ht,
+        [&](const std::size_t begin, const std::size_t end) {
+          std::vector<sum> sums(row);
+          for (auto y { begin }; y < end; ++y) {
+            const auto *const i { rows.m_index.data() + 3 * y };
+            const auto *const w { rows.m_weight.data() + 3 * y };
+            const _Type *const r0 { src + i[0] * row }, *const r1 { src + i[1] * row },
+              *const r2 { src + i[2] * row };
+            for (std::size_t x { 0 }; x < row; ++x)
+              sums[x] = sum(w[0]) * sum(r0[x]) + sum(w[1]) * sum(r1[x])
+                + sum(w[2]) * sum(r2[x]);
+
+            // away from the borders, even columns weigh their pixel and its neighbours by
+            // (1, 6, 1), and odd columns their two neighbours by (4, 4)
+            auto *const out { dst + y * Wt * C };
+            const auto border { [&](const std::size_t x) {
+              const auto *const j { cols.m_index.data() + 3 * x };
+              const auto *const v { cols.m_weight.data() + 3 * x };
+              for (std::size_t c { 0 }; c < C; ++c)
+                out[x * C + c] = combine(out[x * C + c],
+                  narrow(sum(v[0]) * sums[j[0] * C + c] + sum(v[1]) * sums[j[1] * C + c]
+                    + sum(v[2]) * sums[j[2] * C + c]));
+            } };
+            const std::size_t inner { Wt < 3 ? 0 : (Wt - 1) / 2 };
+            for (std::size_t x { 0 }; x < std::min<std::size_t>(Wt, 2); ++x) border(x);
+            for (std::size_t k { 1 }; k < inner; ++k) {
+              const auto *const s { sums.data() + k * C }, *const left { s - C },
+                         *const right { s + C };
+              auto *const even { out + 2 * k * C };
+              for (std::size_t c { 0 }; c < C; ++c) {
+                even[c] = combine(even[c], narrow(left[c] + sum(6) * s[c] + right[c]));
+                even[c + C] = combine(even[c + C], narrow(sum(4) * (s[c] + right[c])));
+              }
+            }
+            for (auto x { std::max<std::size_t>(2, 2 * inner) }; x < Wt; ++x) border(x);
+          }
+        },
+        (1UL << 15) / (Wt * C + 1) + 1);
+    }
+
+    // Checks that `target` is the shape of an image which is downsampled to shape `s`
+    inline void check_expand(const shape &s, const shape &target)
+    {
+      if (s.ndims() != 2 && s.ndims() != 3)
+        throw std::invalid_argument { "Pyramid: image must be of shape (H, W[, C])" };
+      if (target.ndims() != s.ndims() || (target[0] + 1) / 2 != s[0]
+          || (target[1] + 1) / 2 != s[1] || (s.ndims() == 3 && target[2] != s[2]))
+        throw std::invalid_argument { "Pyramid: target shape is not a level below" };
+    }
+  }
+
+  //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+  template<type _DType>
+  pyramid<_DType>::pyramid(const class shape &base, const std::size_t levels)
+    : m_shapes(pyramid_shapes(base, levels)),
+      m_offsets(pyramid_offsets<native_type>(m_shapes)),
+      m_storage { core::internal::shape(m_offsets.back()) }
+  {
+    static_assert(_DType != type::bool8 && _DType != type::float16
+        && _DType != type::bfloat16,
+      "Pyramids are not supported for `bool8`, `float16` and `bfloat16` images");
+    m_offsets.pop_back();
+  }
+
+  template<type _DType>
+  pyramid<_DType>::pyramid(const array<_DType> &image, const std::size_t levels)
+    : pyramid { image.shape(), levels }
+  {
+    build(image);
+  }
+
+  ////////////////////////////// GENERAL ///////////////////////////////
+
+  template<type _DType>
+  void pyramid<_DType>::build(const array<_DType> &image)
+  {
+    if (image.shape() != m_shapes[0])
+      throw std::invalid_argument { "Pyramid: image shape differs from the base shape" };
+
+    const auto *const in { image.data() };
+    auto *const out { m_storage.data() };
+    core::internal::parallel_for(
+      image.size(),
+      [&](const std::size_t begin, const std::size_t end) {
+        std::copy(in + begin, in + end, out + begin);
+      },
+      1UL << 16);
+    build();
+  }
+
+  template<type _DType>
+  void pyramid<_DType>::build()
+  {
+    DEVI_PROFILE_SCOPE("vis::pyramid::build");
+    auto *const data { m_storage.data() };
+    for (std::size_t i { 1 }; i < m_shapes.size(); ++i) {
+      const auto &s { m_shapes[i - 1] };
+      pyramid_down(data + m_offsets[i - 1], s[0], s[1], s.ndims() == 3 ? s[2] : 1,
+        data + m_offsets[i]);
+    }
+  }
+
+  ////////////////////////////// GETTERS ///////////////////////////////
+
+  template<type _DType>
+  std::size_t pyramid<_DType>::levels() const noexcept
+  {
+    return m_shapes.size();
+  }
+
+  template<type _DType>
+  const shape &pyramid<_DType>::shape(const std::size_t i) const
+  {
+    if (i >= m_shapes.size())
+      throw std::out_of_range { "Pyramid: level index out of range" };
+    return m_shapes[i];
+  }
+
+  template<type _DType>
+  view<_DType> pyramid<_DType>::level(const std::size_t i)
+  {
+    const auto &s { shape(i) };
+    return core::internal::view_access::window(m_storage, s, m_offsets[i],
+      core::internal::slice_data::get_stride(s));
+  }
+
+  template<type _DType>
+  std::size_t pyramid<_DType>::bytes() const noexcept
+  {
+    return m_storage.size() * sizeof(native_type);
+  }
+
+  //////////////////////////// CONSTRUCTORS ////////////////////////////
+
+  template<type _DType>
+  laplacian_pyramid<_DType>::laplacian_pyramid(
+    const class shape &base, const std::size_t levels)
+    : m_shapes(pyramid_shapes(base, levels)),
+      m_offsets(pyramid_offsets<level_type>(m_shapes)),
+      m_storage { core::internal::shape(m_offsets.back()) }
+  {
+    static_assert(_DType == type::uint8 || _DType == type::int8 || _DType == type::uint16
+        || _DType == type::int16 || _DType == type::float32 || _DType == type::float64,
+      "Laplacian pyramids are only supported for 8-bit, 16-bit, `float32` and "
+      "`float64` images");
+    m_offsets.pop_back();
+  }
+
+  template<type _DType>
+  laplacian_pyramid<_DType>::laplacian_pyramid(
+    const array<_DType> &image, const std::size_t levels)
+    : laplacian_pyramid { image.shape(), levels }
+  {
+    build(image);
+  }
+
+  ////////////////////////////// GENERAL ///////////////////////////////
+
+  template<type _DType>
+  void laplacian_pyramid<_DType>::build(const array<_DType> &image)
+  {
+    if (image.shape() != m_shapes[0])
+      throw std::invalid_argument { "Pyramid: image shape differs from the base shape" };
+
+    DEVI_PROFILE_SCOPE("vis::laplacian_pyramid::build");
+    const auto *const in { image.data() };
+    auto *const data { m_storage.data() };
+    core::internal::parallel_for(
+      image.size(),
+      [&](const std::size_t begin, const std::size_t end) {
+        for (auto i { begin }; i < end; ++i) data[i] = level_type(in[i]);
+      },
+      1UL << 16);
+
+    // the Gaussian levels, then every one of them but the last minus the expansion of
+    // the one above it (which is still Gaussian)
+    const auto C { m_shapes[0].ndims() == 3 ? m_shapes[0][2] : 1 };
+    for (std::size_t i { 1 }; i < m_shapes.size(); ++i)
+      pyramid_down(data + m_offsets[i - 1], m_shapes[i - 1][0], m_shapes[i - 1][1], C,
+        data + m_offsets[i]);
+    for (std::size_t i { 0 }; i + 1 < m_shapes.size(); ++i)
+      pyramid_up(data + m_offsets[i + 1], C, data + m_offsets[i], m_shapes[i][0],
+        m_shapes[i][1],
+        [](const level_type d, const level_type v) { return level_type(d - v); });
+  }
+
+  template<type _DType>
+  array<_DType> laplacian_pyramid<_DType>::reconstruct() const
+  {
+    DEVI_PROFILE_SCOPE("vis::laplacian_pyramid::reconstruct");
+    auto work { m_storage };
+    auto *const data { work.data() };
+    const auto C { m_shapes[0].ndims() == 3 ? m_shapes[0][2] : 1 };
+    for (auto i { m_shapes.size() - 1 }; i-- > 0;)
+      pyramid_up(data + m_offsets[i + 1], C, data + m_offsets[i], m_shapes[i][0],
+        m_shapes[i][1],
+        [](const level_type d, const level_type v) { return level_type(d + v); });
+
+    array<_DType> ret { m_shapes[0] };
+    auto *const out { ret.data() };
+    core::internal::parallel_for(
+      ret.size(),
+      [&](const std::size_t begin, const std::size_t end) {
+        for (auto i { begin }; i < end; ++i) out[i] = native_type(data[i]);
+      },
+      1UL << 16);
+    return ret;
+  }
+
+  ////////////////////////////// GETTERS ///////////////////////////////
+
+  template<type _DType>
+  std::size_t laplacian_pyramid<_DType>::levels() const noexcept
+  {
+    return m_shapes.size();
+  }
+
+  template<type _DType>
+  const shape &laplacian_pyramid<_DType>::shape(const std::size_t i) const
+  {
+    if (i >= m_shapes.size())
+      throw std::out_of_range { "Pyramid: level index out of range" };
+    return m_shapes[i];
+  }
+
+  template<type _DType>
+  view<laplacian_type<_DType>> laplacian_pyramid<_DType>::level(const std::size_t i)
+  {
+    const auto &s { shape(i) };
+    return core::internal::view_access::window(m_storage, s, m_offsets[i],
+      core::internal::slice_data::get_stride(s));
+  }
+
+  template<type _DType>
+  std::size_t laplacian_pyramid<_DType>::bytes() const noexcept
+  {
+    return m_storage.size() * sizeof(level_type);
+  }
+
+  ////////////////////////////// EXPANSION /////////////////////////////
+
+  namespace  // for internal linkage
+  {
+    // Returns the contiguous image at `src` of shape `s` upsampled to `target`
+    template<type _DType>
+    array<_DType> expanded(const typename core::internal::native_type<_DType>::type *src,
+      const shape &s, const shape &target)
+    {
+      static_assert(_DType != type::bool8 && _DType != type::float16
+          && _DType != type::bfloat16,
+        "Pyramids are not supported for `bool8`, `float16` and `bfloat16` images");
+      DEVI_PROFILE_SCOPE("vis::expand");
+      using native = typename core::internal::native_type<_DType>::type;
+      check_expand(s, target);
+      array<_DType> ret { target };
+      pyramid_up(src, s.ndims() == 3 ? s[2] : 1, ret.data(), target[0], target[1],
+        [](const native, const native v) { return v; });
+      return ret;
+    }
+  }
+
+  template<type _DType>
+  array<_DType> expand(const array<_DType> &src, const shape &target)
+  {
+    return expanded<_DType>(src.data(), src.shape(), target);
+  }
+
+  template<type _DType>
+  array<_DType> expand(const view<_DType> &src, const shape &target)
+  {
+    if (src.is_contiguous()) return expanded<_DType>(src.data(), src.shape(), target);
+
+    array<_DType> dense { src.shape() };
+    for (std::size_t i { 0 }; i < dense.size(); ++i) dense[i] = src[i];
+    return expanded<_DType>(dense.data(), dense.shape(), target);
+  }
+
+}  // namespace devi::vis::internal
+
+#endif
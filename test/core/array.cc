@@ -42,7 +42,10 @@ unsigned operators()
   // equality
   ASSERT(12, a != int32(shape(4, 1)));
   ASSERT(13, a == a && a != a1 && a1 == a1);
-  ASSERT(14, a != int64(shape(2, 2)) && !(a == float32(shape(2, 2))));
+  // different datatypes compare their values after promotion
+  ASSERT(14, a == int64(shape(2, 2)) && a == float32(shape(2, 2)));
+  ASSERT(15, a != uint8(shape(4)));
+  ASSERT(16, a1 == float64(shape(2, 2), 0.0) + a1 && a1 != float32(shape(2, 2), 0.5F));
 
   TEST_SUCCESS;
 }
@@ -79,6 +82,8 @@ unsigned getters()
   ASSERT(2, a.shape() == shape(2, 2));
   ASSERT(3, a.size() == 4);
   ASSERT(4, a.type() == type::int32);
+  ASSERT(5, a.stride().ndims() == 2 && a.stride()[0] == 2 && a.stride()[1] == 1);
+  ASSERT(6, a.is_contiguous());
 
   TEST_SUCCESS;
 }
@@ -110,6 +115,10 @@ unsigned mutation()
   ASSERT(4, a_.shape() == s && a_.size() == 4);
   a_.squeeze();
   ASSERT(5, a_ == a);
+  // the size can never change
+  EXPECT_THROW(6, std::invalid_argument, a_.reshape(5));
+  EXPECT_THROW(7, std::invalid_argument, a_.reshape(shape(2, 1, 3)));
+  ASSERT(8, a_.shape() == shape(2, 2));
 
   TEST_SUCCESS;
 }
@@ -0,0 +1,66 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+using namespace devi::core;
+
+unsigned access()
+{
+  uint8 frame { shape(6, 8, 3) };
+  for (std::size_t i { 0 }; i < frame.size(); ++i) frame[i] = std::uint8_t(i * 3);
+
+  const auto lazy { frame.as<type::float32>() };
+  ASSERT(1, lazy.type() == type::float32 && lazy.shape() == frame.shape());
+  ASSERT(2, lazy[10] == 30.0F && lazy(5, 7, 2) == float(frame(5, 7, 2)));
+
+  // narrowing conversions behave like `astype`
+  float32 f { shape(4), 2.75F };
+  f[1] = -1.5F;
+  const auto ints { f.as<type::int16>() };
+  ASSERT(3, ints[0] == 2 && ints[1] == -1);
+  ASSERT(4, f.as<type::float16>()[0] == float16_t(2.75F));
+
+  EXPECT_THROW(5, std::invalid_argument, (void)lazy(1, 2));
+
+  TEST_SUCCESS;
+}
+
+unsigned slicing()
+{
+  uint8 frame { shape(120, 160, 3) };
+  for (std::size_t i { 0 }; i < frame.size(); ++i) frame[i] = std::uint8_t(i * 7 + 1);
+
+  // a crop of the frame is read as float32 without an intermediate copy
+  auto crop { frame(slice(10, 74), slice(20, 148, 2)) };
+  const auto lazy { crop.as<type::float32>() };
+  ASSERT(1, lazy.shape() == shape(64, 64, 3));
+  ASSERT(2, lazy(3, 5, 1) == float(frame(13, 30, 1)));
+
+  const auto copied { lazy.copy() };
+  ASSERT(3, copied.type() == type::float32 && copied.shape() == crop.shape());
+  for (std::size_t i { 0 }; i < 64; ++i)
+    for (std::size_t j { 0 }; j < 64; ++j)
+      ASSERT(4, copied(i, j, 2) == float(frame(10 + i, 20 + 2 * j, 2)));
+
+  // blocks cover every element exactly once, in row-major positions
+  float32 visited { crop.shape() };
+  lazy.for_each_block([&](const std::size_t index, const float *block, std::size_t n) {
+    for (std::size_t k { 0 }; k < n; ++k) visited[index + k] += block[k] + 1.0F;
+  });
+  ASSERT(5, visited == copied + uint8(crop.shape(), 1));
+
+  // a whole array read through the window is identical to `astype`
+  ASSERT(6, frame.as<type::bfloat16>().copy() == frame.astype<type::bfloat16>());
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/cast.hh", "devi::core::cast_view" };
+
+  tester.run("Access", access);
+  tester.run("Slicing", slicing);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,132 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+#include <cmath>
+#include <limits>
+
+using namespace devi::core;
+
+unsigned equality()
+{
+  // long enough to be split across threads and several early exit blocks
+  int32 a { shape(1000, 301) };
+  for (std::size_t i { 0 }; i < a.size(); ++i) a[i] = int(i % 1009) - 500;
+  auto b { a.copy() };
+  ASSERT(1, array_equal(a, b) && a == b);
+
+  // a single mismatch anywhere is found, including in the last block
+  b[a.size() - 1] += 1;
+  ASSERT(2, !array_equal(a, b) && a != b);
+  b[a.size() - 1] -= 1;
+  b[12345] = 0;
+  ASSERT(3, !array_equal(a, b) && a != b);
+
+  // shapes are compared first, without throwing
+  ASSERT(4, !array_equal(a, int32(shape(301, 1000))));
+
+  // mixed datatypes are compared after promotion
+  ASSERT(5, array_equal(a, a.astype<type::float64>()));
+  ASSERT(6, !array_equal(int8(shape(4), -1), uint8(shape(4), 255)));
+
+  // NaNs are never equal
+  const auto nan { std::numeric_limits<float>::quiet_NaN() };
+  float32 f { shape(3, 3), nan };
+  ASSERT(7, !array_equal(f, f) && f != f);
+
+  TEST_SUCCESS;
+}
+
+unsigned views()
+{
+  float32 a { shape(6, 8) };
+  for (std::size_t i { 0 }; i < a.size(); ++i) a[i] = float(i);
+
+  // every other row, and every column but the first
+  auto v { a(slice(0, 0, 2), slice(1)) };
+  float32 expected { shape(3, 7) };
+  for (std::size_t i { 0 }; i < 3; ++i)
+    for (std::size_t j { 0 }; j < 7; ++j) expected(i, j) = float(16 * i + j + 1);
+
+  ASSERT(1, array_equal(v, expected) && array_equal(expected, v));
+  ASSERT(2, allclose(v, expected.astype<type::float16>()));
+
+  // two views of different layouts
+  auto w { expected(slice(), slice()) };
+  ASSERT(3, array_equal(v, w) && allclose(w, v));
+  expected(2, 6) = 0.0F;
+  ASSERT(4, !array_equal(v, w) && !allclose(w, v));
+
+  auto mask { equal(v, w) };
+  ASSERT(5, mask.type() == type::bool8 && mask.shape() == shape(3, 7));
+  ASSERT(6, mask(2, 5) && !mask(2, 6));
+
+  TEST_SUCCESS;
+}
+
+unsigned closeness()
+{
+  float64 a { shape(2, 3) }, b { shape(2, 3) };
+  a[0] = 1.0, b[0] = 1.0 + 1e-6;  // within rtol
+  a[1] = 1.0, b[1] = 1.001;       // outside rtol
+  a[2] = 0.0, b[2] = 1e-9;        // within atol
+  a[3] = std::numeric_limits<double>::infinity(), b[3] = a[3];
+  a[4] = -a[3], b[4] = a[3];
+  a[5] = std::nan(""), b[5] = std::nan("");
+
+  auto mask { isclose(a, b) };
+  ASSERT(1, mask[0] && !mask[1] && mask[2]);
+  ASSERT(2, mask[3] && !mask[4] && !mask[5]);
+  mask = isclose(a, b, 1e-5, 1e-8, true);
+  ASSERT(3, mask[5]);
+  mask = isclose(a, b, 1e-2);
+  ASSERT(4, mask[1]);
+
+  ASSERT(5, !allclose(a, b) && !allclose(a, b, 1e-2, 1e-8, true));
+  b[4] = a[4];
+  ASSERT(6, allclose(a, b, 1e-2, 1e-8, true));
+
+  // a NaN anywhere in a large array stops every thread
+  float32 big { shape(2000, 500), 1.0F };
+  ASSERT(7, allclose(big, big.astype<type::int32>()));
+  big[777777] = std::nanf("");
+  ASSERT(8, !allclose(big, big) && allclose(big, big, 0.0, 0.0, true));
+
+  EXPECT_THROW(9, std::invalid_argument, (void)allclose(a, float64(shape(3, 2))));
+
+  TEST_SUCCESS;
+}
+
+unsigned masks()
+{
+  int16 a { shape(3, 4) };
+  float32 b { shape(3, 4), 5.5F };
+  for (std::size_t i { 0 }; i < a.size(); ++i) a[i] = std::int16_t(i);
+
+  const auto lt { less(a, b) }, le { less_equal(a, b) }, gt { greater(a, b) },
+    ge { greater_equal(a, b) }, eq { equal(a, b) }, ne { not_equal(a, b) };
+  for (std::size_t i { 0 }; i < a.size(); ++i) {
+    ASSERT(1, lt[i] == (i < 6) && le[i] == (i < 6));
+    ASSERT(2, gt[i] == (i > 5) && ge[i] == (i > 5));
+    ASSERT(3, !eq[i] && ne[i]);
+  }
+
+  const auto self { equal(a, a) };
+  ASSERT(4, self == bool8(shape(3, 4), true));
+
+  EXPECT_THROW(5, std::invalid_argument, (void)less(a, float32(shape(12))));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/compare.hh", "devi::core::allclose" };
+
+  tester.run("Equality", equality);
+  tester.run("Views", views);
+  tester.run("Closeness", closeness);
+  tester.run("Masks", masks);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,115 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+#include <cmath>
+
+using namespace devi::core;
+
+unsigned promotion()
+{
+  static_assert(result_type<type::int32, type::int32> == type::int32);
+  static_assert(result_type<type::bool8, type::uint16> == type::uint16);
+  static_assert(result_type<type::int8, type::int64> == type::int64);
+  static_assert(result_type<type::float32, type::float64> == type::float64);
+  static_assert(result_type<type::float16, type::bfloat16> == type::float32);
+
+  // signed with unsigned
+  ASSERT(1, promote_types(type::int8, type::uint8) == type::int16);
+  ASSERT(2, promote_types(type::uint16, type::int64) == type::int64);
+  ASSERT(3, promote_types(type::int32, type::uint32) == type::int64);
+  ASSERT(4, promote_types(type::uint64, type::int8) == type::float64);
+
+  // integers with floating point numbers
+  ASSERT(5, promote_types(type::uint8, type::float32) == type::float32);
+  ASSERT(6, promote_types(type::uint8, type::float16) == type::float16);
+  ASSERT(7, promote_types(type::int8, type::bfloat16) == type::bfloat16);
+  ASSERT(8, promote_types(type::int16, type::float16) == type::float32);
+  ASSERT(9, promote_types(type::int32, type::float32) == type::float64);
+  ASSERT(10, promote_types(type::float32, type::uint64) == type::float64);
+
+  // the table is symmetric
+  for (int i { 0 }; i <= int(type::float64); ++i)
+    for (int j { 0 }; j <= int(type::float64); ++j)
+      ASSERT(11, promote_types(type(i), type(j)) == promote_types(type(j), type(i)));
+
+  TEST_SUCCESS;
+}
+
+unsigned arithmetic()
+{
+  // long enough to be split across threads and conversion blocks
+  uint8 image { shape(300, 257) };
+  float32 weight { shape(300, 257) };
+  for (std::size_t i { 0 }; i < image.size(); ++i) {
+    image[i]  = std::uint8_t(i * 7);
+    weight[i] = float(i % 13) * 0.25F - 1.0F;
+  }
+
+  auto product { image * weight };
+  ASSERT(1, product.type() == type::float32 && product.shape() == image.shape());
+  for (std::size_t i { 0 }; i < image.size(); ++i)
+    ASSERT(2, product[i] == float(image[i]) * weight[i]);
+
+  // results wider than both operands
+  int8 s { shape(2, 3), -100 };
+  uint8 u { shape(2, 3), 200 };
+  auto sum { s + u }, difference { s - u };
+  ASSERT(3, sum.type() == type::int16 && sum(1, 2) == 100 && difference(0, 1) == -300);
+  auto quotient { int32(shape(4), 7) / int32(shape(4), -2) };
+  ASSERT(4, quotient.type() == type::int32 && quotient[3] == -3);
+
+  // 16-bit floating point numbers are computed in float32
+  float16 h { shape(3, 300), 1.5F };
+  auto scaled { h * uint8(shape(3, 300), 3) };
+  ASSERT(5, scaled.type() == type::float16 && scaled == float16(shape(3, 300), 4.5F));
+  auto mixed { h + bfloat16(shape(3, 300), 0.25F) };
+  ASSERT(6, mixed.type() == type::float32 && mixed(2, 299) == 1.75F);
+
+  EXPECT_THROW(7, std::invalid_argument, (void)(s + uint8(shape(3, 2))));
+
+  TEST_SUCCESS;
+}
+
+unsigned inplace()
+{
+  uint8 image { shape(5, 100), 100 };
+  image *= float32(shape(5, 100), 1.26F);
+  ASSERT(1, image == uint8(shape(5, 100), 126));
+  image -= int16(shape(5, 100), 26);
+  ASSERT(2, image == uint8(shape(5, 100), 100));
+
+  float16 h { shape(2, 50), 2.0F };
+  h /= float16(shape(2, 50), 8.0F);
+  h += int8(shape(2, 50), 1);
+  ASSERT(3, h == float32(shape(2, 50), 1.25F));
+
+  EXPECT_THROW(4, std::invalid_argument, image += uint8(shape(500)));
+
+  TEST_SUCCESS;
+}
+
+unsigned comparison()
+{
+  int32 i { shape(2, 3), 3 };
+  ASSERT(1, i == float32(shape(2, 3), 3.0F) && i == uint8(shape(2, 3), 3));
+  ASSERT(2, i != float32(shape(2, 3), 3.5F) && i != float32(shape(3, 2), 3.0F));
+  // -1 only equals 255 after truncation, which promotion avoids
+  ASSERT(3, int8(shape(4), -1) != uint8(shape(4), 255));
+  ASSERT(4, bool8(shape(2), true) == float16(shape(2), 1.0F));
+  ASSERT(5, float64(shape(2), 0.1) != float32(shape(2), 0.1F));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/elementwise.hh", "devi::core::result_type" };
+
+  tester.run("Promotion", promotion);
+  tester.run("Arithmetic", arithmetic);
+  tester.run("In-place", inplace);
+  tester.run("Comparison", comparison);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
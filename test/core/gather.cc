@@ -0,0 +1,134 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+using namespace devi::core;
+
+// Returns an array of the specified shape whose elements count up from `start`
+int32 iota(const shape &s, const int start = 0)
+{
+  int32 ret { s };
+  for (std::size_t i { 0 }; i < ret.size(); ++i) ret[i] = start + int(i);
+  return ret;
+}
+
+unsigned indices()
+{
+  const auto a { iota(shape(5, 4)) };
+
+  // rows, with repeats and negative indices
+  int64 rows { shape(3) };
+  rows[0] = 4, rows[1] = 0, rows[2] = -1;
+  const auto picked { take(a, rows) };
+  ASSERT(1, picked.shape() == shape(3, 4));
+  ASSERT(2, picked(0, 1) == 17 && picked(1, 3) == 3 && picked(2, 0) == 16);
+
+  // a 2D index array along the last axis
+  uint8 cols { shape(2, 2) };
+  cols[0] = 3, cols[1] = 1, cols[2] = 0, cols[3] = 3;
+  const auto grid { take(a, cols, 1) };
+  ASSERT(3, grid.shape() == shape(5, 2, 2));
+  ASSERT(4, grid(2, 0, 0) == 11 && grid(2, 0, 1) == 9 && grid(4, 1, 1) == 19);
+
+  // scatter is the inverse of take, and the last of repeated indices wins
+  int32 b { shape(5, 4), 0 };
+  scatter(b, rows, picked);
+  ASSERT(5, b(0, 2) == 2 && b(4, 2) == 18 && b(2, 2) == 0);
+  int32 c { shape(5, 4), 0 };
+  scatter(c, cols, grid, 1);
+  ASSERT(6, c(2, 3) == 11 && c(2, 1) == 9 && c(2, 2) == 0);
+
+  // large enough to be split between threads both ways
+  const auto big { iota(shape(1000, 300)) };
+  int32 reversed { shape(1000) };
+  for (std::size_t i { 0 }; i < 1000; ++i) reversed[i] = int(999 - i);
+  const auto flipped { take(big, reversed) };
+  ASSERT(7, flipped(0, 7) == big(999, 7) && flipped(999, 299) == 299);
+  int32 restored { shape(1000, 300) };
+  scatter(restored, reversed, flipped);
+  ASSERT(8, restored == big);
+  int16 every { shape(300) };
+  for (std::size_t i { 0 }; i < 300; ++i) every[i] = std::int16_t(299 - i);
+  int32 columns { shape(1000, 300) };
+  scatter(columns, every, take(big, every, 1), 1);
+  ASSERT(9, columns == big);
+
+  EXPECT_THROW(10, std::out_of_range, (void)take(a, int64(shape(1), 5)));
+  EXPECT_THROW(11, std::out_of_range, (void)take(a, int64(shape(1), -6)));
+  EXPECT_THROW(12, std::invalid_argument, (void)take(a, rows, 2));
+  EXPECT_THROW(13, std::invalid_argument, scatter(b, rows, a));
+
+  TEST_SUCCESS;
+}
+
+unsigned masks()
+{
+  // elements, in row-major order
+  const auto a { iota(shape(4, 6)) };
+  bool8 even { shape(4, 6) };
+  for (std::size_t i { 0 }; i < even.size(); ++i) even[i] = i % 2 == 0;
+  const auto selected { masked_select(a, even) };
+  ASSERT(1, selected.shape() == shape(12) && selected[0] == 0 && selected[11] == 22);
+
+  const auto positions { flatnonzero(even) };
+  ASSERT(2, positions.shape() == shape(12) && positions[5] == 10);
+
+  // whole rows, like filtering detections
+  float32 boxes { shape(5, 4) };
+  for (std::size_t i { 0 }; i < boxes.size(); ++i) boxes[i] = float(i);
+  bool8 keep { shape(5), false };
+  keep[1] = keep[4] = true;
+  const auto kept { masked_select(boxes, keep) };
+  ASSERT(3, kept.shape() == shape(2, 4) && kept(0, 0) == 4.0F && kept(1, 3) == 19.0F);
+
+  // nothing selected
+  const auto none { masked_select(boxes, bool8(shape(5), false)) };
+  ASSERT(4, none.shape() == shape(0, 4) && none.size() == 0);
+
+  // writing back and filling
+  auto copy { boxes.copy() };
+  masked_fill(copy, keep, -1.0F);
+  ASSERT(5, copy(1, 2) == -1.0F && copy(4, 0) == -1.0F && copy(2, 2) == 10.0F);
+  masked_scatter(copy, keep, kept);
+  ASSERT(6, copy == boxes);
+
+  // large masks are split between threads, with sizes which leave partial SIMD blocks
+  for (const std::size_t n : { std::size_t(1000003), std::size_t(77) }) {
+    float64 values { shape(n) };
+    int16 halves { shape(n) };
+    bool8 mask { shape(n) };
+    std::size_t expected { 0 };
+    for (std::size_t i { 0 }; i < n; ++i) {
+      values[i] = double(i), halves[i] = std::int16_t(i);
+      mask[i] = (i * 2654435761U) % 7 < 3;
+      expected += mask[i];
+    }
+    const auto chosen { masked_select(values, mask) };
+    const auto short_chosen { masked_select(halves, mask) };
+    const auto where { flatnonzero(mask) };
+    ASSERT(7, chosen.size() == expected && where.size() == expected);
+    for (std::size_t k { 0 }; k < expected; ++k)
+      ASSERT(8, chosen[k] == double(where[k]) && short_chosen[k] == halves[where[k]]);
+    ASSERT(9, masked_select(values.astype<type::float32>(), mask) == chosen);
+
+    masked_fill(values, mask, -1.0);
+    for (std::size_t k { 0 }; k < expected; ++k) ASSERT(10, values[where[k]] == -1.0);
+    masked_scatter(values, mask, chosen);
+    for (std::size_t i { 0 }; i < n; ++i) ASSERT(11, values[i] == double(i));
+  }
+
+  EXPECT_THROW(12, std::invalid_argument, (void)masked_select(boxes, bool8(shape(4))));
+  EXPECT_THROW(13, std::invalid_argument, masked_scatter(copy, keep, boxes));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/gather.hh", "devi::core::take" };
+
+  tester.run("Indices", indices);
+  tester.run("Masks", masks);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,147 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace devi::core;
+
+unsigned recording()
+{
+  const float32 a { shape(64, 64), 2.0F };
+  const int32 b { shape(64, 64), 3 };
+
+  // a diamond, with a node reusing its input twice and a custom operation
+  graph g;
+  const auto x { g.input(a) };
+  const auto y { g.input(b) };
+  const auto sum { x + y }, product { x * y };
+  const auto squared { product * product };
+  const auto out { g.call(
+    [](buffer_pool &pool, const float64 &s, const float64 &p) {
+      float64 ret { s.shape(), pool };
+      for (std::size_t i { 0 }; i < ret.size(); ++i) ret[i] = s[i] - p[i];
+      return ret;
+    },
+    sum, squared) };
+  const auto total { g.call(
+    [](const float64 &o) { return float64(shape(1), o[0]); }, out) };
+  ASSERT(1, g.size() == 7 && out.node() == 5 && &total.owner() == &g);
+
+  EXPECT_THROW(2, std::invalid_argument, (void)g.result(out));
+  g.keep(out);
+  g.run();
+  ASSERT(3, g.result(out) == float64(shape(64, 64), 5.0 - 36.0));
+  ASSERT(4, g.result(total)[0] == -31.0);
+
+  // intermediate results are released after their last use, unless kept
+  EXPECT_THROW(5, std::invalid_argument, (void)g.result(product));
+  g.keep(product);
+  g.run();
+  ASSERT(6, g.result(product) == float64(shape(64, 64), 6.0));
+
+  // inputs are read again every run, and every node runs again
+  float32 c { shape(4), 1.0F };
+  graph h;
+  const auto input { h.input(c) };
+  const auto doubled { input + input };
+  h.run();
+  c.fill(4.0F);
+  h.run();
+  ASSERT(7, h.result(doubled) == float32(shape(4), 8.0F));
+
+  EXPECT_THROW(8, std::invalid_argument, (void)h.result(out));
+  EXPECT_THROW(9, std::invalid_argument, (void)(x + input));
+  EXPECT_THROW(10, std::invalid_argument, h.keep(x));
+
+  TEST_SUCCESS;
+}
+
+unsigned scheduling()
+{
+  // every branch waits (for a while) until the other branch is running too
+  const int32 seed { shape(1) };
+  graph g;
+  const auto source { g.input(seed) };
+  std::atomic<unsigned> running { 0 };
+  std::atomic<bool> overlapped { false };
+  const auto branch { [&](const int32 &s) {
+    ++running;
+    const auto until { std::chrono::steady_clock::now() + std::chrono::seconds(1) };
+    while (running < 2 && std::chrono::steady_clock::now() < until)
+      std::this_thread::yield();
+    if (running >= 2) overlapped = true;
+    --running;
+    return s.copy();
+  } };
+  const auto left { g.call(branch, source) }, right { g.call(branch, source) };
+  (void)(left + right);
+  g.run();
+  const auto &threads { devi::core::internal::thread_pool::instance() };
+  ASSERT(1, overlapped == (threads.concurrency() > 1));
+
+  // the first exception of any node is rethrown, and the graph can run again afterwards
+  bool fail { true };
+  graph h;
+  const auto in { h.input(seed) };
+  std::vector<lazy<type::int32>> branches;
+  for (int i { 0 }; i < 8; ++i)
+    branches.push_back(h.call(
+      [&fail, i](const int32 &s) {
+        if (fail && i == 5) throw std::out_of_range { "node" };
+        return s.copy();
+      },
+      in));
+  auto joined { branches[0] };
+  for (int i { 1 }; i < 8; ++i) joined = joined + branches[i];
+  EXPECT_THROW(2, std::out_of_range, h.run());
+  fail = false;
+  h.run();
+  ASSERT(3, h.result(joined)[0] == 0);
+
+  // shapes of the operands of element-wise nodes are checked when they run
+  const int32 other { shape(2) };
+  graph bad;
+  (void)(bad.input(seed) + bad.input(other));
+  EXPECT_THROW(4, std::invalid_argument, bad.run());
+
+  TEST_SUCCESS;
+}
+
+unsigned liveness()
+{
+  // a chain of element-wise operations on arrays of 1MB
+  const float32 frame { shape(512, 512), 1.0F };
+  const std::size_t bytes { frame.size() * sizeof(float) };
+  graph g;
+  const auto x { g.input(frame) };
+  auto y { x + x };
+  for (int i { 0 }; i < 10; ++i) y = y * x + x;
+  g.run();
+  ASSERT(1, g.size() == 22 && g.result(y)[0] == 12.0F);
+
+  // atmost an input and an output of a node are alive at once, and their buffers are
+  // recycled by the nodes after them
+  ASSERT(2, g.peak_bytes() == 2 * bytes);
+  const auto first { g.pool().statistics() };
+  ASSERT(3, first.m_requests == 21 && first.m_allocations <= 3);
+  g.run();
+  const auto second { g.pool().statistics() };
+  ASSERT(4, second.m_allocations == first.m_allocations && g.result(y)[100] == 12.0F);
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/graph.hh", "devi::core::graph" };
+
+  tester.run("Recording", recording);
+  tester.run("Scheduling", scheduling);
+  tester.run("Liveness", liveness);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
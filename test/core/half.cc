@@ -0,0 +1,126 @@
+#include "../utils.hh"
+
+#include <devi/core>
+#include <devi/vis>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace devi::core;
+
+float from_bits(const std::uint32_t bits)
+{
+  float f;
+  std::memcpy(&f, &bits, sizeof f);
+  return f;
+}
+
+// reference binary16 decoding straight from the definition of the format
+float decode(const std::uint16_t h)
+{
+  const int e { (h >> 10) & 0x1F }, m { h & 0x3FF };
+  const float sign { h & 0x8000 ? -1.0F : 1.0F };
+  if (e == 0x1F) return m ? std::numeric_limits<float>::quiet_NaN() : sign * INFINITY;
+  if (e == 0) return sign * std::ldexp(float(m), -24);
+  return sign * std::ldexp(float(m + 1024), e - 25);
+}
+
+unsigned half_precision()
+{
+  // every bit pattern decodes exactly, and encodes back to itself
+  for (std::uint32_t h { 0 }; h < 65536; ++h) {
+    float16_t v;
+    v.m_bits      = std::uint16_t(h);
+    const float f { v }, expected { decode(std::uint16_t(h)) };
+    if (std::isnan(expected)) {
+      ASSERT(1, std::isnan(f) && (float16_t(f).m_bits & 0x7C00) == 0x7C00);
+      continue;
+    }
+    ASSERT(2, std::memcmp(&f, &expected, sizeof f) == 0);
+    ASSERT(3, float16_t(f).m_bits == h);
+  }
+
+  // rounding to nearest even, overflow and underflow
+  ASSERT(4, float16_t(1.0F + 1.0F / 2048).m_bits == 0x3C00);
+  ASSERT(5, float16_t(1.0F + 3.0F / 2048).m_bits == 0x3C02);
+  ASSERT(6, float16_t(65520.0F).m_bits == 0x7C00 && float16_t(65519.0F).m_bits == 0x7BFF);
+  ASSERT(7, float16_t(-1e-8F).m_bits == 0x8000 && float16_t(3e-8F).m_bits == 0x0001);
+  ASSERT(8, float16_t(2.5) == 2.5F && float16_t(-7) == -7.0F);
+
+  TEST_SUCCESS;
+}
+
+unsigned brain_float()
+{
+  ASSERT(1, bfloat16_t(1.0F).m_bits == 0x3F80 && float(bfloat16_t(-2.0F)) == -2.0F);
+  // ties round to even, everything else to nearest
+  ASSERT(2, bfloat16_t(from_bits(0x3F808000)).m_bits == 0x3F80);
+  ASSERT(3, bfloat16_t(from_bits(0x3F818000)).m_bits == 0x3F82);
+  ASSERT(4, bfloat16_t(from_bits(0x3F808001)).m_bits == 0x3F81);
+  ASSERT(5, bfloat16_t(from_bits(0x7F7FFFFF)).m_bits == 0x7F80);
+  ASSERT(6, std::isnan(float(bfloat16_t(std::numeric_limits<float>::quiet_NaN()))));
+  ASSERT(7, std::isnan(float(bfloat16_t(from_bits(0x7F800001)))));
+
+  TEST_SUCCESS;
+}
+
+unsigned arrays()
+{
+  // long enough to take the vectorized paths along with the scalar tails
+  float32 f { shape(3, 37) };
+  for (std::size_t i { 0 }; i < f.size(); ++i) f[i] = (float(i) - 50.0F) * 0.37F;
+
+  auto h { f.astype<type::float16>() };
+  auto b { f.astype<type::bfloat16>() };
+  ASSERT(1, h.type() == type::float16 && b.type() == type::bfloat16);
+  for (std::size_t i { 0 }; i < f.size(); ++i) {
+    ASSERT(2, h[i].m_bits == float16_t(f[i]).m_bits);
+    ASSERT(3, b[i].m_bits == bfloat16_t(f[i]).m_bits);
+  }
+
+  auto back { h.astype<type::float32>() };
+  for (std::size_t i { 0 }; i < f.size(); ++i)
+    ASSERT(4, std::fabs(back[i] - f[i]) <= std::fabs(f[i]) / 2048);
+
+  // conversions between other datatypes go through float32
+  auto i16 { h.astype<type::int16>() };
+  ASSERT(5, i16(0, 0) == -18 && i16(2, 36) == 22);
+  auto hb { h.astype<type::bfloat16>() };
+  ASSERT(6, float(hb(1, 0)) == float(bfloat16_t(float(h(1, 0)))));
+  ASSERT(7, uint8(shape(2), 200).astype<type::float16>() == float16(shape(2), 200.0F));
+
+  // filling, indexing and comparisons
+  bfloat16 z { shape(2, 2) };
+  ASSERT(8, float(z(1, 1)) == 0.0F && z == bfloat16(shape(2, 2), 0.0F));
+  z(1, 0) = 3.5F;
+  ASSERT(9, z(1, 0) == 3.5F && z != bfloat16(shape(2, 2)));
+
+  TEST_SUCCESS;
+}
+
+unsigned kernels()
+{
+  // 16-bit storage with 32-bit accumulation
+  float16 img { shape(20, 30), 0.1F };
+  auto table { devi::vis::integral(img) };
+  ASSERT(1, table.type() == type::float32);
+  ASSERT(2, std::fabs(table(20, 30) - 600 * float(float16_t(0.1F))) < 1e-3F);
+
+  auto hist { devi::vis::histogram(float16(shape(10), 0.25F), 10) };
+  ASSERT(3, hist[2] == 10);
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/half.hh", "devi::core::float16_t" };
+
+  tester.run("Float16", half_precision);
+  tester.run("BFloat16", brain_float);
+  tester.run("Arrays", arrays);
+  tester.run("Kernels", kernels);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,122 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+#include <vector>
+
+using namespace devi::core;
+
+// Returns an array of the specified shape whose elements count up from `start`
+int32 iota(const shape &s, const int start = 0)
+{
+  int32 ret { s };
+  for (std::size_t i { 0 }; i < ret.size(); ++i) ret[i] = start + int(i);
+  return ret;
+}
+
+unsigned concatenation()
+{
+  const std::vector<int32> parts { iota(shape(2, 3)), iota(shape(1, 3), 6),
+    iota(shape(3, 3), 9) };
+  ASSERT(1, concatenate(parts) == iota(shape(6, 3)));
+
+  // along the last axis, every row is gathered from all the inputs
+  const std::vector<int32> cols { iota(shape(4, 1)), iota(shape(4, 2), 100) };
+  const auto joined { concatenate(cols, 1) };
+  ASSERT(2, joined.shape() == shape(4, 3));
+  ASSERT(3, joined(2, 0) == 2 && joined(2, 1) == 104 && joined(2, 2) == 105);
+
+  // large enough to be split between threads, across the boundaries of the inputs
+  const std::vector<int32> big { iota(shape(300, 500)), iota(shape(300, 500), 150000) };
+  ASSERT(4, concatenate(big, 0) == iota(shape(600, 500)));
+  const auto wide { concatenate(big, 1) };
+  ASSERT(5, wide(299, 499) == 149999 && wide(0, 500) == 150000);
+
+  // strided views, written into a provided output
+  auto source { iota(shape(6, 8)) };
+  const std::vector<view<type::int32>> views { source(slice(0, 0, 2), slice(1, 3)),
+    source(slice(1, 0, 2), slice(5)) };
+  int32 out { shape(3, 5) };
+  concatenate(views, 1, out);
+  ASSERT(6, out(1, 0) == 17 && out(1, 1) == 18 && out(2, 2) == 45 && out(2, 4) == 47);
+
+  EXPECT_THROW(7, std::invalid_argument, (void)concatenate(std::vector<int32> {}));
+  EXPECT_THROW(8, std::invalid_argument, (void)concatenate(cols, 0));
+  EXPECT_THROW(9, std::invalid_argument, (void)concatenate(cols, 2));
+  EXPECT_THROW(10, std::invalid_argument, concatenate(views, 0, out));
+
+  TEST_SUCCESS;
+}
+
+unsigned stacking()
+{
+  std::vector<uint8> frames;
+  for (int i { 0 }; i < 4; ++i) frames.emplace_back(shape(6, 8, 3), std::uint8_t(i + 1));
+  const auto batch { stack(frames) };
+  ASSERT(1, batch.shape() == shape(4, 6, 8, 3));
+  ASSERT(2, batch(0, 5, 7, 2) == 1 && batch(3, 0, 0, 0) == 4);
+
+  // a new last dimension interleaves the inputs
+  const std::vector<int32> planes { iota(shape(2, 2)), iota(shape(2, 2), 10) };
+  const auto pixels { stack(planes, 2) };
+  ASSERT(3, pixels.shape() == shape(2, 2, 2));
+  ASSERT(4, pixels(1, 0, 0) == 2 && pixels(1, 0, 1) == 12);
+
+  int32 out { shape(2, 2, 2) };
+  stack(planes, 1, out);
+  ASSERT(5, out(0, 1, 0) == 10 && out(1, 0, 1) == 3);
+
+  EXPECT_THROW(6, std::invalid_argument, (void)stack(planes, 3));
+  EXPECT_THROW(7, std::invalid_argument,
+    (void)stack(std::vector<int32> { iota(shape(2)), iota(shape(3)) }));
+  int32 flat { shape(8) };
+  EXPECT_THROW(8, std::invalid_argument, stack(planes, 0, flat));
+
+  TEST_SUCCESS;
+}
+
+unsigned splitting()
+{
+  auto a { iota(shape(6, 4)) };
+
+  // views of the array, so writes reach it
+  auto rows { split(a, 3) };
+  ASSERT(1, rows.size() == 3 && rows[1].shape() == shape(2, 4) && rows[1](0, 0) == 8);
+  rows[2](1, 3) = -1;
+  ASSERT(2, a(5, 3) == -1);
+
+  auto heads { split(a, std::vector<std::size_t> { 1, 3 }, 1) };
+  ASSERT(3, heads.size() == 3 && heads[0].shape() == shape(6, 1));
+  ASSERT(4, heads[1].shape() == shape(6, 2) && heads[1](4, 1) == 18);
+  ASSERT(5, heads[2](0, 0) == 3);
+
+  // uneven sections, from a strided view
+  auto v { a(slice(0, 0, 2)) };
+  auto parts { array_split(v, 2, 1) };
+  ASSERT(6, parts[0].shape() == shape(3, 2) && parts[0](2, 1) == 17);
+  auto thirds { array_split(a, 4) };
+  ASSERT(7, thirds[0].shape() == shape(2, 4) && thirds[3].shape() == shape(1, 4));
+  ASSERT(8, thirds[3](0, 2) == 22);
+
+  // splitting and joining again gives back the original
+  ASSERT(9, concatenate(split(a, 2, 1), 1) == a);
+
+  EXPECT_THROW(10, std::invalid_argument, (void)split(a, 4));
+  EXPECT_THROW(11, std::invalid_argument, (void)split(a, 2, 2));
+  EXPECT_THROW(12, std::invalid_argument, (void)array_split(a, 7));
+  const std::vector<std::size_t> repeated { 3, 3 };
+  EXPECT_THROW(13, std::invalid_argument, (void)split(a, repeated));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/join.hh", "devi::core::concatenate" };
+
+  tester.run("Concatenation", concatenation);
+  tester.run("Stacking", stacking);
+  tester.run("Splitting", splitting);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
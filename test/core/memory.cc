@@ -0,0 +1,137 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace devi::core;
+
+unsigned placement()
+{
+  const auto initial { numa::placement() };
+  numa::set_placement(numa::policy::interleave);
+  ASSERT(1, numa::placement() == numa::policy::interleave);
+  numa::set_placement(numa::policy::local);
+  ASSERT(2, numa::placement() == numa::policy::local);
+  numa::set_placement(initial);
+
+  const auto nodes { int(numa::node_count()) };
+  ASSERT(3, nodes >= 1);
+
+  // touched pages are on some online node (or unknown without NUMA support)
+  const float32 touched { shape(1 << 20) };
+  const auto node { numa::node_of(touched.data()) };
+  ASSERT(4, node >= -1 && node < nodes);
+
+  // ranges without a whole page are never interleaved
+  std::uint8_t bytes[16] {};
+  ASSERT(5, !numa::interleave(bytes + 1, 8));
+
+  TEST_SUCCESS;
+}
+
+unsigned initialization()
+{
+  const auto initial { numa::placement() };
+  bool ok { true };
+  for (const auto policy : { numa::policy::local, numa::policy::interleave }) {
+    numa::set_placement(policy);
+
+    // large enough to be initialized by all the threads
+    float32 zeros { shape(1000, 1000) };
+    for (std::size_t i { 0 }; i < zeros.size(); ++i) ok &= zeros[i] == 0.0F;
+    const float16 halves { shape(300, 300) };
+    for (std::size_t i { 0 }; i < halves.size(); ++i) ok &= halves[i].m_bits == 0;
+
+    for (std::size_t i { 0 }; i < zeros.size(); ++i) zeros[i] = float(i % 251);
+    const auto copy { zeros };
+    ok &= copy == zeros && copy.data() != zeros.data();
+    ok &= int32(shape(0, 4)).size() == 0 && uint8(shape(3), 9)[2] == 9;
+  }
+  numa::set_placement(initial);
+  ASSERT(1, ok);
+
+  TEST_SUCCESS;
+}
+
+unsigned pooling()
+{
+  buffer_pool pool;
+  for (int frame { 0 }; frame < 10; ++frame) {
+    float32 input { shape(240, 320), pool }, scratch { shape(64, 64), pool };
+    uint8 mask { shape(240, 320), pool };
+    ASSERT(1, input[0] == 0.0F && scratch[4095] == 0.0F && mask[76799] == 0);
+    input[0] = scratch[4095] = 1.0F;  // recycled buffers are zeroed again
+    mask[76799] = 1;
+  }
+  // the first frame allocates, and every later one reuses the same buffers
+  auto stats { pool.statistics() };
+  ASSERT(2, stats.m_requests == 30 && stats.m_allocations == 3 && stats.m_hits == 27);
+  ASSERT(3, stats.m_idle_buffers == 3 && stats.m_releases == 0);
+  ASSERT(4, stats.m_idle_bytes == 240 * 320 * 5 + 64 * 64 * 4);
+
+  // moved arrays hand back their storage once, wherever they end up
+  {
+    float32 a { shape(240, 320), pool };
+    const float32 b { std::move(a) };
+    float32 c { shape(8), pool };
+    ASSERT(5, pool.statistics().m_idle_buffers == 2 && b.size() == 76800);
+  }
+  ASSERT(6, pool.statistics().m_idle_buffers == 4
+              && pool.statistics().m_allocations == 4);
+
+  pool.trim();
+  stats = pool.statistics();
+  ASSERT(7, stats.m_idle_buffers == 0 && stats.m_idle_bytes == 0
+              && stats.m_releases == 4);
+
+  // buffers over the high-water marks are given back to the system
+  pool.set_limits(240 * 320 * 5, 2);
+  { const float32 a { shape(240, 320), pool }, b { shape(240, 320), pool }; }
+  stats = pool.statistics();
+  ASSERT(8, stats.m_idle_buffers == 1 && stats.m_idle_bytes == 240 * 320 * 4);
+  ASSERT(9, stats.m_releases == 5);
+
+  // arrays and idle buffers can outlive the pool object
+  auto survivor { [] {
+    buffer_pool local;
+    return int32(shape(100), local);
+  }() };
+  survivor[99] = 5;
+  ASSERT(10, survivor[99] == 5);
+
+  // concurrent releases never keep more than the limits between them, even briefly
+  buffer_pool shared;
+  shared.set_limits(3 * 4096, 1000);
+  std::atomic<unsigned> running { 8 };
+  std::vector<std::thread> threads;
+  for (unsigned t { 0 }; t < 8; ++t)
+    threads.emplace_back([&] {
+      for (unsigned i { 0 }; i < 2000; ++i) {
+        const float32 a { shape(1024), shared }, b { shape(1024), shared };
+      }
+      --running;
+    });
+  std::size_t most { 0 };
+  while (running) most = std::max(most, shared.statistics().m_idle_bytes);
+  for (auto &t : threads) t.join();
+  ASSERT(11, most <= 3 * 4096 && shared.statistics().m_idle_bytes <= 3 * 4096);
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/memory.hh", "devi::core::numa" };
+
+  tester.run("Placement", placement);
+  tester.run("Initialization", initialization);
+  tester.run("Pooling", pooling);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
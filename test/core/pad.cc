@@ -0,0 +1,109 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+#include <vector>
+
+using namespace devi::core;
+
+// Returns an array of the specified shape whose elements count up from `start`
+int32 iota(const shape &s, const int start = 0)
+{
+  int32 ret { s };
+  for (std::size_t i { 0 }; i < ret.size(); ++i) ret[i] = start + int(i);
+  return ret;
+}
+
+unsigned access()
+{
+  const auto line { iota(shape(4), 1) };  // 1 2 3 4
+  const padded_view<type::int32> constant { line, 3, border::constant, -1 };
+  ASSERT(1, constant.shape() == shape(10));
+  ASSERT(2, constant(0) == -1 && constant(3) == 1 && constant(6) == 4
+              && constant(9) == -1);
+
+  // every border mode, around the interior 1 2 3 4
+  const padded_view<type::int32> replicate { line, pad_width(3, 1), border::replicate };
+  ASSERT(3, replicate(0) == 1 && replicate(2) == 1 && replicate(7) == 4);
+  const padded_view<type::int32> reflect { line, 5, border::reflect };
+  const int reflected[] { 2, 3, 4, 3, 2, 1, 2, 3, 4, 3, 2, 1, 2, 3 };
+  bool ok { true };
+  for (std::size_t i { 0 }; i < 14; ++i) ok &= reflect(i) == reflected[i];
+  ASSERT(4, ok);
+  const padded_view<type::int32> wrap { line, 5, border::wrap };
+  const int wrapped[] { 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1 };
+  for (std::size_t i { 0 }; i < 14; ++i) ok &= wrap(i) == wrapped[i];
+  ASSERT(5, ok);
+  ASSERT(6, wrap.resolve(0, 0) == 3 && constant.resolve(0, 2) == -1);
+
+  // the interior of a strided view, with different widths for every dimension
+  auto grid { iota(shape(6, 8)) };
+  const padded_view<type::int32> padded { grid(slice(0, 0, 2), slice(1, 7, 3)),
+    std::vector<pad_width> { { 1, 0 }, { 0, 2 } }, border::replicate };
+  ASSERT(7, padded.shape() == shape(4, 4));
+  ASSERT(8, padded.interior_begin(0) == 1 && padded.interior_end(0) == 4
+              && padded.interior_begin(1) == 0 && padded.interior_end(1) == 2);
+  ASSERT(9, padded(0, 0) == 1 && padded(1, 1) == 4 && padded(3, 0) == 33);
+  ASSERT(10, padded(3, 3) == 36 && padded.interior()(2, 1) == 36);
+
+  EXPECT_THROW(11, std::invalid_argument, (void)padded(1));
+  EXPECT_THROW(12, std::out_of_range, (void)padded(4, 0));
+  EXPECT_THROW(13, std::invalid_argument,
+    (padded_view<type::int32> { grid, std::vector<pad_width> { 1 } }));
+  const int32 empty { shape(0, 3) };
+  EXPECT_THROW(14, std::invalid_argument,
+    (padded_view<type::int32> { empty, 1, border::reflect }));
+
+  TEST_SUCCESS;
+}
+
+unsigned materialization()
+{
+  const auto image { iota(shape(3, 4)) };
+  const auto constant { pad(image, 1, border::constant, 7) };
+  ASSERT(1, constant.shape() == shape(5, 6));
+  ASSERT(2, constant(0, 0) == 7 && constant(0, 5) == 7 && constant(1, 0) == 7);
+  ASSERT(3, constant(1, 1) == 0 && constant(3, 4) == 11 && constant(4, 3) == 7);
+
+  // every element of a copy matches the virtual view it was made from
+  bool ok { true };
+  auto volume { iota(shape(5, 7, 9)) };
+  const auto cube { volume(slice(1, 5), slice(0, 0, 2), slice(2, 8)) };
+  const std::vector<pad_width> widths { { 2, 1 }, 3, { 0, 5 } };
+  for (const auto mode : { border::constant, border::replicate, border::reflect,
+         border::wrap }) {
+    const padded_view<type::int32> virt { cube, widths, mode, -3 };
+    const auto copy { pad(cube, widths, mode, -3) };
+    ok &= copy.shape() == virt.shape();
+    for (std::size_t i { 0 }; i < copy.shape()[0]; ++i)
+      for (std::size_t j { 0 }; j < copy.shape()[1]; ++j)
+        for (std::size_t k { 0 }; k < copy.shape()[2]; ++k)
+          ok &= copy(i, j, k) == virt(i, j, k);
+  }
+  ASSERT(4, ok);
+
+  // large enough to be split between threads
+  const float32 frame { shape(480, 640), 0.5F };
+  const auto framed { pad(frame, 16, border::reflect) };
+  ASSERT(5, framed.shape() == shape(512, 672));
+  float sum { 0 };
+  for (std::size_t i { 0 }; i < framed.size(); ++i) sum += framed[i];
+  ASSERT(6, sum == 0.5F * 512 * 672);
+
+  // zero widths copy the source, and empty dimensions can be filled with a constant
+  ASSERT(7, pad(image, 0) == image);
+  const int32 empty { shape(0, 3) };
+  ASSERT(8, pad(empty, 1, border::constant, 4) == int32(shape(2, 5), 4));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/pad.hh", "devi::core::padded_view" };
+
+  tester.run("Access", access);
+  tester.run("Materialization", materialization);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
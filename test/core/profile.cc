@@ -0,0 +1,97 @@
+#define DEVI_PROFILE
+#include "../utils.hh"
+
+#include <devi/vis>
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace devi::core;
+
+// returns the counters of the region `name`, or zeros if it was never entered
+profile::region_stats region(const std::string &name)
+{
+  for (const auto &r : profile::regions())
+    if (name == r.m_name) return r;
+  return { nullptr, 0, 0.0 };
+}
+
+unsigned allocations()
+{
+  static_assert(profile::enabled());
+  profile::reset();
+
+  float32 a { shape(10, 20) };
+  auto b { a.astype<type::uint8>() };
+  const auto arrays { profile::allocations(profile::site::array) };
+  ASSERT(1, arrays.m_count == 2 && arrays.m_bytes == 200 * sizeof(float) + 200);
+  ASSERT(2, profile::allocations(profile::site::dimension).m_count >= 2);
+
+  auto v { a(slice(0, 0, 2), 3) };
+  ASSERT(3, profile::allocations(profile::site::view).m_count == 1);
+  ASSERT(4, v.size() == 5 && b.size() == 200);
+
+  profile::reset();
+  ASSERT(5, profile::allocations(profile::site::array).m_count == 0);
+  ASSERT(6, profile::allocations(profile::site::view).m_count == 0);
+
+  TEST_SUCCESS;
+}
+
+unsigned regions()
+{
+  profile::reset();
+
+  float32 a { shape(30, 40), 1.0F };
+  for (int i { 0 }; i < 3; ++i) a.fill(float(i));
+  (void)a.astype<type::int16>();
+  (void)a.astype<type::uint8>();  // another instantiation of the same region
+  (void)devi::vis::histogram(a, 4);
+
+  ASSERT(1, region("core::array::fill").m_calls == 4);  // the fill constructor as well
+  ASSERT(2, region("core::array::astype").m_calls == 2);
+  ASSERT(3, region("vis::histogram").m_calls == 1);
+  ASSERT(4, region("core::array::fill").m_seconds >= 0.0);
+  ASSERT(5, region("net::conv2d").m_calls == 0);
+
+  std::ostringstream out;
+  profile::dump(out);
+  ASSERT(6, out.str().find("core::array::astype") != std::string::npos);
+  ASSERT(7, out.str().find("workspace") != std::string::npos);
+
+  TEST_SUCCESS;
+}
+
+unsigned threads()
+{
+  profile::reset();
+
+  // counters are updated concurrently from several threads
+  std::vector<std::thread> workers;
+  for (int t { 0 }; t < 4; ++t)
+    workers.emplace_back([] {
+      for (int i { 0 }; i < 100; ++i) {
+        uint8 a { shape(16), 1 };
+        a.fill(2);
+      }
+    });
+  for (auto &w : workers) w.join();
+
+  const auto arrays { profile::allocations(profile::site::array) };
+  ASSERT(1, arrays.m_count == 400 && arrays.m_bytes == 400 * 16);
+  ASSERT(2, region("core::array::fill").m_calls == 800);
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/profile.hh", "devi::core::profile" };
+
+  tester.run("Allocations", allocations);
+  tester.run("Regions", regions);
+  tester.run("Threads", threads);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,112 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+#include <cmath>
+
+using namespace devi::core;
+
+unsigned reproducibility()
+{
+  // with seed 0, the first block of stream 0 is the Philox4x32-10 known answer for zeros
+  random::generator gen { 0 };
+  uint32 words { shape(1000, 999) };
+  random::integers(words, 0, 1LL << 32, gen);
+  ASSERT(1, words[0] == 0x6627E8D5U && words[1] == 0xBC57AC4CU);
+  ASSERT(2, gen.seed() == 0 && gen.stream() == 1);
+
+  // the whole array is the same for any number of threads
+  std::uint64_t checksum { 0 };
+  for (std::size_t i { 0 }; i < words.size(); ++i) checksum = checksum * 31 + words[i];
+  ASSERT(3, checksum == 7503963571445133801ULL);
+
+  // elements only depend on their position, so shorter arrays are prefixes of longer ones
+  random::generator a { 42 }, b { 42 };
+  float32 small { shape(1000) }, large { shape(500, 999) };
+  random::uniform(small, -1.0, 1.0, a);
+  random::uniform(large, -1.0, 1.0, b);
+  for (std::size_t i { 0 }; i < small.size(); ++i) ASSERT(4, small[i] == large[i]);
+
+  // the next array comes from a new stream, and a copy replays the same streams
+  random::generator c { a };
+  float32 next { shape(1000) }, replay { shape(1000) };
+  random::uniform(next, -1.0, 1.0, a);
+  random::uniform(replay, -1.0, 1.0, c);
+  ASSERT(5, next != small && next == replay);
+
+  // a different seed gives different numbers
+  random::generator d { 43 };
+  random::uniform(replay, -1.0, 1.0, d);
+  ASSERT(6, next != replay);
+
+  TEST_SUCCESS;
+}
+
+unsigned distributions()
+{
+  random::generator gen { 7 };
+  const std::size_t n { 1UL << 20 };
+
+  float64 u { shape(n) };
+  random::uniform(u, 2.0, 5.0, gen);
+  double sum { 0 }, lo { 5 }, hi { 2 };
+  for (std::size_t i { 0 }; i < n; ++i)
+    sum += u[i], lo = std::min(lo, u[i]), hi = std::max(hi, u[i]);
+  ASSERT(1, lo >= 2.0 && hi < 5.0 && std::abs(sum / n - 3.5) < 0.01);
+
+  float32 z { shape(n) };
+  random::normal(z, 1.0, 2.0, gen);
+  double mean { 0 }, square { 0 };
+  for (std::size_t i { 0 }; i < n; ++i) mean += z[i], square += double(z[i]) * z[i];
+  mean /= n, square /= n;
+  ASSERT(2, std::abs(mean - 1.0) < 0.01 && std::abs(square - mean * mean - 4.0) < 0.05);
+
+  bool8 mask { shape(1024, 1024) };
+  random::bernoulli(mask, 0.25, gen);
+  std::size_t ones { 0 };
+  for (std::size_t i { 0 }; i < mask.size(); ++i) ones += mask[i];
+  ASSERT(3, std::abs(double(ones) / mask.size() - 0.25) < 0.005);
+
+  int16 dice { shape(6000) };
+  random::integers(dice, 1, 7, gen);
+  std::size_t counts[8] {};
+  for (std::size_t i { 0 }; i < dice.size(); ++i) ++counts[dice[i]];
+  ASSERT(4, counts[0] == 0 && counts[7] == 0);
+  for (unsigned face { 1 }; face <= 6; ++face)
+    ASSERT(5, std::abs(int(counts[face]) - 1000) < 150);
+
+  // half precision and odd sizes (the last block is only partly used)
+  float16 h { shape(3, 5, 7) };
+  random::uniform(h, 0.0, 1.0, gen);
+  ASSERT(6, float(h[h.size() - 1]) >= 0.0F && float(h[h.size() - 1]) < 1.0F);
+  random::bernoulli(h, 1.0, gen);
+  ASSERT(7, h == float16(shape(3, 5, 7), 1.0F));
+
+  // draws which round up to `high` in the datatype are kept below it (in float16 above
+  // 1 - 2^-12, and in float32 an eighth of the draws, whose values are spaced 2 apart)
+  float16 halves { shape(1 << 16) };
+  random::uniform(halves, 0.0, 1.0, gen);
+  float32 coarse { shape(4096) };
+  random::uniform(coarse, 16777216.0, 16777224.0, gen);
+  bool below { true };
+  for (std::size_t i { 0 }; i < halves.size(); ++i) below &= float(halves[i]) < 1.0F;
+  for (std::size_t i { 0 }; i < coarse.size(); ++i) below &= coarse[i] < 16777224.0F;
+  ASSERT(8, below);
+
+  EXPECT_THROW(9, std::invalid_argument, random::uniform(u, 1.0, 1.0));
+  EXPECT_THROW(10, std::invalid_argument, random::normal(u, 0.0, -1.0));
+  EXPECT_THROW(11, std::invalid_argument, random::bernoulli(u, 1.5));
+  EXPECT_THROW(12, std::invalid_argument, random::integers(dice, 3, 2));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/random.hh", "devi::core::random" };
+
+  tester.run("Reproducibility", reproducibility);
+  tester.run("Distributions", distributions);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
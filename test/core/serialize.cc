@@ -0,0 +1,148 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace devi::core;
+
+// Returns true if `a` survives a round trip through `serialize` and `deserialize`
+template<type _DType>
+bool round_trip(const array<_DType> &a)
+{
+  const auto bytes { serialize(a) };
+  return deserialize<_DType>(bytes.data(), bytes.size()) == a;
+}
+
+unsigned encoding()
+{
+  // constant, smooth and random arrays of every element size, spanning several chunks
+  const uint8 flat { shape(300, 500), 9 };
+  ASSERT(1, round_trip(flat));
+  const auto packed { serialize(flat) };
+  ASSERT(2, packed.size() * 50 < flat.size());
+
+  int32 ramp { shape(7, 40000) };
+  for (std::size_t i { 0 }; i < ramp.size(); ++i) ramp[i] = int(i) * 3 - 100000;
+  ASSERT(3, round_trip(ramp));
+  ASSERT(4, serialize(ramp).size() * 20 < ramp.size() * 4);
+
+  float64 noise { shape(3, 50000) };
+  random::uniform(noise, -1, 1);
+  ASSERT(5, round_trip(noise));
+  ASSERT(6, round_trip(noise.astype<type::float16>()));
+  float32 tiny { shape(1, 2, 3, 4) };
+  random::normal(tiny);
+  ASSERT(7, round_trip(tiny));
+
+  // masks, small and empty arrays
+  bool8 mask { shape(1000, 70) };
+  for (std::size_t i { 0 }; i < mask.size(); ++i) mask[i] = (i / 97) % 2;
+  ASSERT(8, round_trip(mask));
+  ASSERT(9, round_trip(int16(shape(1), -5)) && round_trip(uint64(shape(0, 4))));
+
+  // decoding into an existing array, whose datatype and shape must match
+  float64 into { noise.shape() };
+  const auto bytes { serialize(noise) };
+  deserialize(bytes.data(), bytes.size(), into);
+  ASSERT(10, into == noise);
+  float64 wrong { shape(50000, 3) };
+  EXPECT_THROW(11, std::invalid_argument, deserialize(bytes.data(), bytes.size(), wrong));
+  EXPECT_THROW(12, std::invalid_argument,
+    (void)deserialize<type::float32>(bytes.data(), bytes.size()));
+
+  TEST_SUCCESS;
+}
+
+unsigned corruption()
+{
+  int32 ramp { shape(100, 1000) };
+  for (std::size_t i { 0 }; i < ramp.size(); ++i) ramp[i] = int(i % 777);
+  const auto bytes { serialize(ramp) };
+
+  // truncated, extended and damaged bytes are rejected without reading out of bounds
+  EXPECT_THROW(1, std::invalid_argument, (void)deserialize<type::int32>(bytes.data(), 3));
+  EXPECT_THROW(2, std::invalid_argument,
+    (void)deserialize<type::int32>(bytes.data(), bytes.size() - 1));
+  auto longer { bytes };
+  longer.push_back(0);
+  EXPECT_THROW(3, std::invalid_argument,
+    (void)deserialize<type::int32>(longer.data(), longer.size()));
+  auto magic { bytes };
+  magic[0] = 'X';
+  EXPECT_THROW(4, std::invalid_argument,
+    (void)deserialize<type::int32>(magic.data(), magic.size()));
+
+  std::size_t rejected { 0 }, decoded { 0 };
+  for (std::size_t i { 40 }; i < bytes.size(); i += 7) {
+    auto damaged { bytes };
+    damaged[i] ^= 0x5A;
+    try {
+      decoded += deserialize<type::int32>(damaged.data(), damaged.size()).size() > 0;
+    } catch (const std::invalid_argument &) {
+      ++rejected;
+    }
+  }
+  ASSERT(5, rejected > 0 && rejected + decoded == (bytes.size() - 40 + 6) / 7);
+
+  // a forged shape of 2^64 elements (0 after wrapping around) and no chunks
+  auto forged { serialize(uint8(shape(1, 1))) };
+  forged.resize(6 + 16 + 4);
+  const std::uint64_t huge { 1ULL << 32 };
+  std::memcpy(forged.data() + 6, &huge, 8);
+  std::memcpy(forged.data() + 14, &huge, 8);
+  std::memset(forged.data() + 22, 0, 4);
+  EXPECT_THROW(6, std::invalid_argument,
+    (void)deserialize<type::uint8>(forged.data(), forged.size()));
+  std::stringstream stream { std::string(forged.begin(), forged.end()) };
+  EXPECT_THROW(7, std::invalid_argument, (void)load<type::uint8>(stream));
+
+  TEST_SUCCESS;
+}
+
+unsigned streams()
+{
+  std::stringstream stream;
+  uint8 image { shape(120, 160, 3) };
+  random::integers(image, 0, 256);
+  const float32 filled { shape(64, 64), 0.25F };
+  save(stream, image);
+  save(stream, filled);
+
+  // arrays are read back in order, consuming exactly their own bytes
+  ASSERT(1, load<type::uint8>(stream) == image);
+  ASSERT(2, load<type::float32>(stream) == filled);
+  EXPECT_THROW(3, std::invalid_argument, (void)load<type::float32>(stream));
+
+  std::stringstream truncated { stream.str().substr(0, 10) };
+  EXPECT_THROW(4, std::invalid_argument, (void)load<type::uint8>(truncated));
+
+  // headers whose chunk table does not fit the array are rejected before it is read
+  const auto bytes { serialize(filled) };
+  const auto forged { [&](const std::size_t at, const std::uint8_t value) {
+    auto copy { bytes };
+    for (std::size_t i { 0 }; i < 4; ++i) copy[at + i] = value;
+    return std::stringstream { std::string(copy.begin(), copy.end()) };
+  } };
+  auto chunks { forged(22, 0xFF) }, lengths { forged(26, 0xF0) };
+  EXPECT_THROW(5, std::invalid_argument, (void)load<type::float32>(chunks));
+  EXPECT_THROW(6, std::invalid_argument, (void)load<type::float32>(lengths));
+  std::stringstream other { std::string(bytes.begin(), bytes.end()) };
+  EXPECT_THROW(7, std::invalid_argument, (void)load<type::int32>(other));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/serialize.hh", "devi::core::serialize" };
+
+  tester.run("Encoding", encoding);
+  tester.run("Corruption", corruption);
+  tester.run("Streams", streams);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -29,6 +29,13 @@ unsigned construction()
   //   TEST_FAILURE(1);
   // }
 
+  // dimensionality known only at runtime
+  const std::size_t dims[] { 4, 0, 7 };
+  ASSERT(1, shape::from_dims(dims, 3) == shape(4, 0, 7));
+  ASSERT(2, shape::from_dims(dims, 1) == shape(4));
+  EXPECT_THROW(3, std::invalid_argument, (void)shape::from_dims(dims, 0));
+  EXPECT_THROW(4, std::invalid_argument, (void)shape::from_dims(dims, 11));
+
   TEST_SUCCESS;
 }
 
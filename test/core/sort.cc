@@ -0,0 +1,138 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+#include <cmath>
+#include <limits>
+
+using namespace devi::core;
+
+unsigned sorting()
+{
+  int16 a { shape(2, 5) };
+  const std::int16_t values[] { 3, -1, 4, -1, 5, 9, 2, -6, 5, 3 };
+  for (std::size_t i { 0 }; i < a.size(); ++i) a[i] = values[i];
+
+  // along the last axis (rows)
+  auto rows { sort(a, 1) };
+  const std::int16_t rows_expected[] { -1, -1, 3, 4, 5, -6, 2, 3, 5, 9 };
+  for (std::size_t i { 0 }; i < a.size(); ++i) ASSERT(1, rows[i] == rows_expected[i]);
+
+  // along the first axis (columns), in descending order
+  auto cols { sort(a, 0, true) };
+  const std::int16_t cols_expected[] { 9, 2, 4, 5, 5, 3, -1, -6, -1, 3 };
+  for (std::size_t i { 0 }; i < a.size(); ++i) ASSERT(2, cols[i] == cols_expected[i]);
+
+  // equal elements keep their order
+  auto order { argsort(a, 1) };
+  ASSERT(3, order.type() == type::int64 && order.shape() == a.shape());
+  ASSERT(4, order(0, 0) == 1 && order(0, 1) == 3 && order(1, 0) == 2);
+  auto reverse { argsort(a, 1, true) };
+  ASSERT(5, reverse(0, 0) == 4 && reverse(0, 3) == 1 && reverse(0, 4) == 3);
+
+  EXPECT_THROW(6, std::invalid_argument, (void)sort(a, 2));
+
+  TEST_SUCCESS;
+}
+
+unsigned radix()
+{
+  // long enough lanes to be radix sorted, and enough of them to be split across threads
+  const std::size_t lanes { 64 }, n { 3000 };
+  int32 ints { shape(lanes, n) };
+  float32 floats { shape(lanes, n) };
+  for (std::size_t i { 0 }; i < ints.size(); ++i) {
+    ints[i]   = int((i * 2654435761UL) % 100003) - 50000;
+    floats[i] = float(ints[i]) * 0.125F;
+  }
+  floats[5]  = -0.0F;
+  floats[17] = std::numeric_limits<float>::infinity();
+  floats[29] = std::nanf("");
+
+  const auto sorted_ints { sort(ints, 1) };
+  const auto sorted_floats { sort(floats, 1) };
+  const auto order { argsort(floats, 1) };
+  for (std::size_t l { 0 }; l < lanes; ++l)
+    for (std::size_t i { 1 }; i < n; ++i) {
+      ASSERT(1, sorted_ints(l, i - 1) <= sorted_ints(l, i));
+      if (l) ASSERT(2, sorted_floats(l, i - 1) <= sorted_floats(l, i));
+      ASSERT(3, floats(l, std::size_t(order(l, i))) == sorted_floats(l, i)
+                  || std::isnan(sorted_floats(l, i)));
+    }
+
+  // NaNs are last, after infinity
+  ASSERT(4, std::isnan(sorted_floats(0, n - 1)) && std::isinf(sorted_floats(0, n - 2)));
+  ASSERT(5, sort(ints, 1, true)(7, 0) == sorted_ints(7, n - 1));
+
+  // 16-bit floating point numbers are ordered like their values
+  const auto halves { sort(floats.astype<type::float16>(), 1) };
+  for (std::size_t i { 1 }; i < n - 2; ++i)
+    ASSERT(6, float(halves(3, i - 1)) <= float(halves(3, i)));
+
+  TEST_SUCCESS;
+}
+
+unsigned views()
+{
+  float64 a { shape(4, 6) };
+  for (std::size_t i { 0 }; i < a.size(); ++i) a[i] = double((i * 7) % 11);
+
+  // every other column, sorted along the rows and the columns
+  auto v { a(slice(), slice(0, 0, 2)) };
+  auto rows { sort(v, 1) }, cols { sort(v, 0) };
+  ASSERT(1, rows.shape() == shape(4, 3) && cols.shape() == shape(4, 3));
+  for (std::size_t i { 0 }; i < 4; ++i)
+    for (std::size_t j { 1 }; j < 3; ++j) ASSERT(2, rows(i, j - 1) <= rows(i, j));
+  for (std::size_t i { 1 }; i < 4; ++i)
+    for (std::size_t j { 0 }; j < 3; ++j) ASSERT(3, cols(i - 1, j) <= cols(i, j));
+
+  auto order { argsort(v, 0) };
+  for (std::size_t i { 0 }; i < 4; ++i)
+    ASSERT(4, v(std::size_t(order(i, 2)), 2) == cols(i, 2));
+
+  TEST_SUCCESS;
+}
+
+unsigned top()
+{
+  float32 scores { shape(3, 1000) };
+  for (std::size_t i { 0 }; i < scores.size(); ++i)
+    scores[i] = float((i * 37) % 1000) / 1000.0F;
+
+  auto [values, indices] { topk(scores, 5, 1) };
+  ASSERT(1, values.shape() == shape(3, 5) && indices.shape() == shape(3, 5));
+  ASSERT(2, values(0, 0) == 0.999F && values(0, 4) == 0.995F);
+  for (std::size_t l { 0 }; l < 3; ++l)
+    for (std::size_t i { 0 }; i < 5; ++i)
+      ASSERT(3, scores(l, std::size_t(indices(l, i))) == values(l, i));
+
+  // smallest elements, with ties broken by position
+  int8 ties { shape(6), 1 };
+  ties[4] = 0;
+  auto smallest { topk(ties, 3, 0, false) };
+  ASSERT(4, smallest.m_values[0] == 0 && smallest.m_values[2] == 1);
+  ASSERT(5, smallest.m_indices[0] == 4 && smallest.m_indices[1] == 0
+              && smallest.m_indices[2] == 1);
+
+  // along the first axis of a view
+  auto column { topk(scores(slice(), slice(0, 10)), 2, 0) };
+  ASSERT(6, column.m_values.shape() == shape(2, 10));
+  ASSERT(7, column.m_values(0, 3) >= column.m_values(1, 3));
+
+  EXPECT_THROW(8, std::invalid_argument, (void)topk(scores, 0, 1));
+  EXPECT_THROW(9, std::invalid_argument, (void)topk(scores, 4, 0));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/sort.hh", "devi::core::sort" };
+
+  tester.run("Sorting", sorting);
+  tester.run("Radix", radix);
+  tester.run("Views", views);
+  tester.run("Top-k", top);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,72 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+using namespace devi::core;
+
+unsigned contiguity()
+{
+  int32 a { shape(4, 6, 5) };
+  for (std::size_t i { 0 }; i < a.size(); ++i) a[i] = int(i);
+
+  ASSERT(1, a(slice(1, 3)).is_contiguous());
+  ASSERT(2, a(2, slice()).is_contiguous() && !a(2, slice(), slice(0, 1)).is_contiguous());
+  ASSERT(3, !a(slice(), slice(1, 4)).is_contiguous());
+  ASSERT(4, !a(slice(0, 0, 2)).is_contiguous());
+  // dimensions of length one do not matter
+  ASSERT(5, a(slice(1, 2), slice(), slice()).is_contiguous());
+  ASSERT(6, a(slice(), 3, 2).stride()[0] == 30);
+
+  TEST_SUCCESS;
+}
+
+unsigned reshape()
+{
+  int32 a { shape(4, 6, 5) };
+  for (std::size_t i { 0 }; i < a.size(); ++i) a[i] = int(i);
+
+  // contiguous views never copy, and share memory with the array
+  auto rows { a(slice(1, 3)) };
+  auto flat { rows.flatten() };
+  ASSERT(1, !flat.owns_data() && flat.shape() == shape(60) && flat.data() == rows.data());
+  ASSERT(2, flat[0] == 30 && flat[59] == 89);
+  flat[1] = -1;
+  ASSERT(3, a(1, 0, 1) == -1);
+
+  // a range of columns can be split anywhere, but only merged across contiguous ones
+  auto cols { a(slice(), slice(2, 4)) };  // ( 4 2 5 )
+  auto split { cols.reshape(4, 2, 5, 1) };
+  ASSERT(4, !split.owns_data() && split(3, 1, 4, 0) == a(3, 3, 4));
+  auto merged { cols.reshape(4, 10) };
+  ASSERT(5, !merged.owns_data() && merged(2, 7) == a(2, 3, 2));
+  auto copied { cols.reshape(8, 5) };
+  ASSERT(6, copied.owns_data() && copied(3, 0) == a(1, 3, 0));
+  auto gathered { cols.reshape(40) };
+  ASSERT(7, gathered.owns_data() && gathered.is_contiguous());
+  for (std::size_t i { 0 }; i < 40; ++i)
+    ASSERT(8, gathered[i] == a(i / 10, 2 + i / 5 % 2, i % 5));
+
+  // views made from a copy keep it alive
+  auto again { gathered.reshape(2, 20) };
+  ASSERT(9, again.owns_data() && again.data() == gathered.data());
+  ASSERT(10, again(1, 19) == a(3, 3, 4));
+
+  // a strided view can still be split
+  auto every_other { a(slice(), slice(0, 0, 2), 0) };  // ( 4 3 ) with strides ( 30 10 )
+  auto split_rows { every_other.reshape(2, 2, 3) };
+  ASSERT(11, !split_rows.owns_data() && split_rows(1, 1, 2) == a(3, 4, 0));
+
+  EXPECT_THROW(12, std::invalid_argument, (void)cols.reshape(41));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/view.hh", "devi::core::view" };
+
+  tester.run("Contiguity", contiguity);
+  tester.run("Reshape", reshape);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,119 @@
+#include "../utils.hh"
+
+#include <devi/core>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+using namespace devi::core;
+
+// Returns an array of the specified shape whose elements count up from `start`
+int32 iota(const shape &s, const int start = 0)
+{
+  int32 ret { s };
+  for (std::size_t i { 0 }; i < ret.size(); ++i) ret[i] = start + int(i);
+  return ret;
+}
+
+unsigned windows()
+{
+  auto signal { iota(shape(10)) };
+  auto frames { sliding_window_view(signal, shape(4), { 3 }) };
+  ASSERT(1, frames.shape() == shape(3, 4));
+  ASSERT(2, frames(0, 3) == 3 && frames(1, 0) == 3 && frames(2, 3) == 9);
+  ASSERT(3, !frames.is_contiguous());
+
+  // windows share their elements with the source
+  frames(1, 0) = -1;
+  ASSERT(4, signal[3] == -1 && frames(0, 3) == -1);
+
+  auto image { iota(shape(5, 6)) };
+  auto patches { sliding_window_view(image, shape(3, 2)) };
+  ASSERT(5, patches.shape() == shape(3, 5, 3, 2));
+  ASSERT(6, patches(2, 4, 0, 0) == 16 && patches(2, 4, 2, 1) == 29);
+  ASSERT(7, patches(1, 1, 1, 1) == patches(2, 2, 0, 0));
+
+  // windows of a strided view, copied out through a reshape
+  auto odd { image(slice(), slice(1, 0, 2)) };
+  auto crops { sliding_window_view(odd, shape(2, 2), { 2, 1 }) };
+  ASSERT(8, crops.shape() == shape(2, 2, 2, 2));
+  ASSERT(9, crops(1, 1, 1, 0) == 21 && crops(0, 0, 0, 1) == 3);
+  const auto flat { crops.reshape(4, 4) };
+  ASSERT(10, flat(3, 0) == 15 && flat(3, 3) == 23);
+
+  EXPECT_THROW(11, std::invalid_argument, (void)sliding_window_view(image, shape(3)));
+  EXPECT_THROW(12, std::invalid_argument, (void)sliding_window_view(image, shape(6, 2)));
+  EXPECT_THROW(13, std::invalid_argument, (void)sliding_window_view(image, shape(0, 2)));
+  EXPECT_THROW(14, std::invalid_argument,
+    (void)sliding_window_view(image, shape(2, 2), { 1, 0 }));
+  auto volume { iota(shape(2, 2, 2, 2, 2, 2)) };
+  EXPECT_THROW(15, std::invalid_argument,
+    (void)sliding_window_view(volume, shape(1, 1, 1, 1, 1, 1)));
+
+  TEST_SUCCESS;
+}
+
+unsigned consumers()
+{
+  auto image { iota(shape(6, 8)) };
+  auto pools { sliding_window_view(image, shape(2, 2), { 2, 2 }) };
+  const auto pooled { reduce_windows(pools, 0,
+    [](const int a, const int b) { return std::max(a, b); }) };
+  ASSERT(1, pooled.shape() == shape(3, 4));
+  ASSERT(2, pooled(0, 0) == 9 && pooled(2, 3) == 47);
+  const auto sums { reduce_windows(sliding_window_view(image, shape(3, 3)), 0,
+    std::plus<int> {}) };
+  ASSERT(3, sums.shape() == shape(4, 6) && sums(0, 0) == 9 * 9 && sums(3, 5) == 9 * 38);
+
+  // products of the windows with a weight matrix match the products of their copies
+  float32 values { shape(40, 50) };
+  for (std::size_t i { 0 }; i < values.size(); ++i) values[i] = float(i % 17) - 8;
+  float32 weight { shape(9, 5) };
+  for (std::size_t i { 0 }; i < weight.size(); ++i) weight[i] = float(i % 7) - 3;
+  auto patches { sliding_window_view(values, shape(3, 3)) };
+  const auto product { window_matmul(patches, weight) };
+  ASSERT(4, product.shape() == shape(38, 48, 5));
+  bool ok { true };
+  for (std::size_t y { 0 }; y < 38; ++y)
+    for (std::size_t x { 0 }; x < 48; ++x)
+      for (std::size_t o { 0 }; o < 5; ++o) {
+        float expected { 0 };
+        for (std::size_t k { 0 }; k < 9; ++k)
+          expected += patches(y, x, k / 3, k % 3) * weight(k, o);
+        ok &= product(y, x, o) == expected;
+      }
+  ASSERT(5, ok);
+
+  // the windows of a signal are multiplied in place
+  auto signal { values.copy() };
+  signal.reshape(2000);
+  auto frames { sliding_window_view(signal, shape(9), { 4 }) };
+  const auto filtered { window_matmul(frames, weight) };
+  ASSERT(6, filtered.shape() == shape(498, 5));
+  for (std::size_t i { 0 }; i < 498; ++i)
+    for (std::size_t o { 0 }; o < 5; ++o) {
+      float expected { 0 };
+      for (std::size_t k { 0 }; k < 9; ++k) expected += signal[i * 4 + k] * weight(k, o);
+      ok &= filtered(i, o) == expected;
+    }
+  ASSERT(7, ok);
+
+  EXPECT_THROW(8, std::invalid_argument,
+    (void)window_matmul(frames, float32(shape(8, 5))));
+  auto line { image(0, slice()) };
+  EXPECT_THROW(9, std::invalid_argument,
+    (void)reduce_windows(line, 0, std::plus<int> {}));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/core/window.hh", "devi::core::sliding_window_view" };
+
+  tester.run("Windows", windows);
+  tester.run("Consumers", consumers);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
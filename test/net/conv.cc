@@ -0,0 +1,140 @@
+#include "../utils.hh"
+
+#include <devi/net>
+
+#include <cmath>
+
+using namespace devi::core;
+using namespace devi::net;
+
+// fills an array with a deterministic pattern of small values
+void fill(float32 &a, const unsigned seed)
+{
+  for (std::size_t i { 0 }; i < a.size(); ++i)
+    a[i] = float(int((i * 7 + seed * 13) % 19) - 9) / 8.0F;
+}
+
+// naive convolution used as the reference
+float32 reference(const float32 &in, const float32 &w, const float32 &b,
+  const size2d stride, const size2d pad, const size2d dil, const std::size_t groups,
+  const shape &out_shape)
+{
+  float32 out { out_shape };
+  const auto &s { in.shape() }, &k { w.shape() };
+  const std::size_t Cg { s[1] / groups }, Og { k[0] / groups };
+  for (std::size_t n { 0 }; n < out_shape[0]; ++n)
+    for (std::size_t o { 0 }; o < out_shape[1]; ++o)
+      for (std::size_t y { 0 }; y < out_shape[2]; ++y)
+        for (std::size_t x { 0 }; x < out_shape[3]; ++x) {
+          float sum { b.size() ? float(b[o]) : 0.0F };
+          for (std::size_t c { 0 }; c < Cg; ++c)
+            for (std::size_t ky { 0 }; ky < k[2]; ++ky)
+              for (std::size_t kx { 0 }; kx < k[3]; ++kx) {
+                const auto iy { std::ptrdiff_t(y * stride.m_y + ky * dil.m_y - pad.m_y) };
+                const auto ix { std::ptrdiff_t(x * stride.m_x + kx * dil.m_x - pad.m_x) };
+                if (iy < 0 || ix < 0 || iy >= std::ptrdiff_t(s[2])
+                    || ix >= std::ptrdiff_t(s[3]))
+                  continue;
+                sum += float(in(n, o / Og * Cg + c, iy, ix)) * float(w(o, c, ky, kx));
+              }
+          out(n, o, y, x) = sum;
+        }
+  return out;
+}
+
+bool close(const float32 &a, const float32 &b)
+{
+  if (a.shape() != b.shape()) return false;
+  for (std::size_t i { 0 }; i < a.size(); ++i)
+    if (std::fabs(float(a[i]) - float(b[i])) > 1e-3F) return false;
+  return true;
+}
+
+// compares the layer against the naive reference for a single configuration
+bool matches(const shape &input, const shape &weight, const bool bias,
+  const size2d stride, const size2d pad, const size2d dil, const std::size_t groups)
+{
+  float32 in { input }, w { weight }, b { shape(bias ? weight[0] : 0) };
+  fill(in, 1);
+  fill(w, 2);
+  fill(b, 3);
+
+  conv2d layer { w, b, stride, pad, dil, groups };
+  auto out { layer.forward(in) };
+  return close(out, reference(in, w, b, stride, pad, dil, groups, out.shape()));
+}
+
+unsigned construction()
+{
+  EXPECT_THROW(1, std::invalid_argument, conv2d(float32(shape(4, 3, 3))));
+  EXPECT_THROW(2, std::invalid_argument,
+    conv2d(float32(shape(4, 3, 3, 3)), float32(shape(3))));
+  EXPECT_THROW(3, std::invalid_argument, conv2d(float32(shape(4, 3, 3, 3)), 0));
+  EXPECT_THROW(4, std::invalid_argument, conv2d(float32(shape(4, 1, 3, 3)), 1, 0, 1, 3));
+
+  conv2d layer { float32(shape(8, 3, 3, 3)), 2, 1 };
+  ASSERT(5, layer.output_shape(shape(2, 3, 32, 31)) == shape(2, 8, 16, 16));
+  EXPECT_THROW(6, std::invalid_argument, (void)layer.output_shape(shape(2, 4, 32, 32)));
+  EXPECT_THROW(7, std::invalid_argument, (void)layer.output_shape(shape(3, 32, 32)));
+  EXPECT_THROW(8, std::invalid_argument, (void)layer.output_shape(shape(1, 3, 0, 0)));
+
+  float32 out { shape(2, 8, 15, 16) };
+  EXPECT_THROW(9, std::invalid_argument,
+    layer.forward(float32(shape(2, 3, 32, 32)), out));
+
+  TEST_SUCCESS;
+}
+
+unsigned standard()
+{
+  ASSERT(1, matches(shape(2, 3, 9, 11), shape(5, 3, 3, 3), true, 1, 1, 1, 1));
+  ASSERT(2, matches(shape(1, 4, 17, 13), shape(6, 4, 3, 5), false, { 2, 1 }, { 1, 2 },
+              1, 1));
+  ASSERT(3, matches(shape(1, 2, 12, 12), shape(3, 2, 3, 3), true, 1, 2, 2, 1));
+  ASSERT(4, matches(shape(2, 3, 20, 20), shape(4, 3, 7, 7), true, 2, 3, 1, 1));
+  ASSERT(5, matches(shape(1, 2, 4, 4), shape(2, 2, 5, 5), false, 3, 2, 1, 1));
+
+  // large enough to be split into several output tiles
+  ASSERT(6, matches(shape(1, 64, 40, 40), shape(8, 64, 3, 3), true, 1, 1, 1, 1));
+
+  TEST_SUCCESS;
+}
+
+unsigned grouped()
+{
+  ASSERT(1, matches(shape(2, 6, 10, 10), shape(4, 3, 3, 3), true, 1, 1, 1, 2));
+  ASSERT(2, matches(shape(1, 8, 9, 9), shape(8, 2, 3, 3), false, 2, 1, 1, 4));
+
+  TEST_SUCCESS;
+}
+
+unsigned depthwise()
+{
+  ASSERT(1, matches(shape(2, 4, 10, 12), shape(4, 1, 3, 3), true, 1, 1, 1, 4));
+  ASSERT(2, matches(shape(1, 3, 15, 15), shape(6, 1, 5, 5), false, 2, 2, 1, 3));
+  ASSERT(3, matches(shape(1, 2, 11, 11), shape(2, 1, 3, 3), true, { 1, 3 }, 2, 2, 2));
+
+  TEST_SUCCESS;
+}
+
+unsigned pointwise()
+{
+  ASSERT(1, matches(shape(2, 16, 7, 9), shape(8, 16, 1, 1), true, 1, 0, 1, 1));
+  ASSERT(2, matches(shape(1, 8, 8, 8), shape(4, 8, 1, 1), false, 2, 0, 1, 1));
+  ASSERT(3, matches(shape(1, 8, 6, 6), shape(4, 4, 1, 1), true, 1, 0, 1, 2));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/net/conv.hh", "devi::net::conv2d" };
+
+  tester.run("Construction", construction);
+  tester.run("Standard", standard);
+  tester.run("Grouped", grouped);
+  tester.run("Depthwise", depthwise);
+  tester.run("Pointwise", pointwise);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,183 @@
+#include "../utils.hh"
+
+#include <devi/net>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace devi::core;
+using namespace devi::net;
+
+// requantization of an int32 accumulator, as specified for the kernels
+std::int8_t requantize(const std::int32_t acc, const float multiplier, const int zero)
+{
+  const float v { float(acc) * multiplier + float(zero) };
+  return std::int8_t(std::lrint(std::clamp(v, -128.0F, 127.0F)));
+}
+
+unsigned construction()
+{
+  using q8 = quantized<type::int8>;
+  using u8 = quantized<type::uint8>;
+
+  quantized<type::uint8> q { uint8(shape(2, 3), 130), 0.5F, 128 };
+  ASSERT(1, !q.per_channel() && q.scale() == 0.5F && q.zero_point() == 128);
+  ASSERT(2, q.scale(7) == 0.5F && q.values().shape() == shape(2, 3));
+
+  quantized<type::int8> p { int8(shape(2, 3)), { 0.5F, 0.25F, 2.0F }, { 0, 1, -1 }, 1 };
+  ASSERT(3, p.per_channel() && p.axis() == 1);
+  ASSERT(4, p.scale(1) == 0.25F && p.zero_point(2) == -1);
+
+  EXPECT_THROW(5, std::invalid_argument, q8(int8(shape(2)), 0.0F));
+  EXPECT_THROW(6, std::invalid_argument, q8(int8(shape(2)), 1.0F, 128));
+  EXPECT_THROW(7, std::invalid_argument, u8(uint8(shape(2)), 1.0F, -1));
+  EXPECT_THROW(8, std::invalid_argument,
+    q8(int8(shape(2, 3)), { 1.0F, 1.0F }, { 0, 0 }, 1));
+  EXPECT_THROW(9, std::invalid_argument, q8(int8(shape(2, 3)), { 1.0F }, { 0 }, 2));
+
+  TEST_SUCCESS;
+}
+
+unsigned conversion()
+{
+  float32 x { shape(4, 5) };
+  for (std::size_t i { 0 }; i < x.size(); ++i) x[i] = float(i) * 0.75F - 6.0F;
+
+  auto q { quantize<type::uint8>(x, 0.5F, 20) };
+  ASSERT(1, q.values()[0] == 8 && q.values()[1] == 10 && q.values()[19] == 36);
+  auto y { q.dequantize() };
+  for (std::size_t i { 0 }; i < x.size(); ++i)
+    ASSERT(2, std::fabs(float(y[i]) - float(x[i])) <= 0.25F);
+
+  // saturation at the range of the datatype
+  auto s { quantize<type::int8>(x, 0.05F) };
+  ASSERT(3, s.values()[0] == -120 && s.values()[19] == 127);
+
+  // per-channel along the rows
+  auto r { quantize<type::int8>(x, { 1.0F, 0.5F, 0.25F, 0.125F }, { 0, 0, 2, -3 }, 0) };
+  ASSERT(4, r.values()(0, 4) == -3 && r.values()(1, 0) == -4 && r.values()(2, 1) == 11);
+  ASSERT(5, r.values()(3, 4) == 63);
+  auto z { r.dequantize() };
+  for (std::size_t i { 0 }; i < x.size(); ++i)
+    ASSERT(6, std::fabs(float(z[i]) - float(x[i])) <= 0.5F);
+
+  TEST_SUCCESS;
+}
+
+unsigned multiplication()
+{
+  const std::size_t M { 37 }, K { 70 }, N { 45 };
+  uint8 a { shape(M, K) };
+  int8 b { shape(K, N) };
+  for (std::size_t i { 0 }; i < a.size(); ++i) a[i] = (i * 37) % 256;
+  for (std::size_t i { 0 }; i < b.size(); ++i) b[i] = int((i * 53) % 256) - 128;
+
+  std::vector<float> scales(N);
+  std::vector<std::int32_t> zeros(N);
+  for (std::size_t j { 0 }; j < N; ++j) {
+    scales[j] = 0.01F + 0.001F * j;
+    zeros[j]  = int(j % 5) - 2;
+  }
+
+  quantized<type::uint8> qa { a, 0.02F, 120 };
+  quantized<type::int8> qt { b, 0.015F, 3 }, qc { b, scales, zeros, 1 };
+  auto ct { matmul(qa, qt, 0.5F, -4) }, cc { matmul(qa, qc, 0.25F) };
+  ASSERT(1, ct.values().shape() == shape(M, N) && ct.scale() == 0.5F);
+
+  for (std::size_t i { 0 }; i < M; ++i)
+    for (std::size_t j { 0 }; j < N; ++j) {
+      std::int32_t t { 0 }, c { 0 };
+      for (std::size_t k { 0 }; k < K; ++k) {
+        t += (a(i, k) - 120) * (b(k, j) - 3);
+        c += (a(i, k) - 120) * (b(k, j) - zeros[j]);
+      }
+      ASSERT(2, ct.values()(i, j) == requantize(t, 0.02F * 0.015F / 0.5F, -4));
+      ASSERT(3, cc.values()(i, j) == requantize(c, 0.02F * scales[j] / 0.25F, 0));
+    }
+
+  EXPECT_THROW(4, std::invalid_argument, (void)matmul(qa, qa, 1.0F));
+  EXPECT_THROW(5, std::invalid_argument, (void)matmul(qc, qt, 1.0F));
+
+  TEST_SUCCESS;
+}
+
+// compares the layer against a naive integer convolution for a single configuration
+bool matches(const shape &input, const shape &weight, const bool bias,
+  const size2d stride, const size2d pad, const std::size_t groups)
+{
+  uint8 x { input };
+  int8 w { weight };
+  float32 b { shape(bias ? weight[0] : 0) };
+  for (std::size_t i { 0 }; i < x.size(); ++i) x[i] = (i * 29) % 251;
+  for (std::size_t i { 0 }; i < w.size(); ++i) w[i] = int((i * 17) % 255) - 127;
+  for (std::size_t i { 0 }; i < b.size(); ++i) b[i] = float(i) - 1.5F;
+
+  std::vector<float> scales(weight[0]);
+  std::vector<std::int32_t> zeros(weight[0]);
+  for (std::size_t o { 0 }; o < weight[0]; ++o) scales[o] = 0.002F * float(o + 1);
+
+  const quantized<type::uint8> qx { x, 0.05F, 100 };
+  const quantized<type::int8> qw { w, scales, zeros, 0 };
+  qconv2d layer { qw, b, 0.75F, 5, stride, pad, 1, groups };
+  const auto out { layer.forward(qx) };
+  const auto &o { out.values().shape() };
+  const std::size_t Cg { input[1] / groups }, Og { weight[0] / groups };
+
+  for (std::size_t n { 0 }; n < o[0]; ++n)
+    for (std::size_t f { 0 }; f < o[1]; ++f)
+      for (std::size_t y { 0 }; y < o[2]; ++y)
+        for (std::size_t z { 0 }; z < o[3]; ++z) {
+          const float acc_scale { 0.05F * scales[f] };
+          std::int32_t acc { bias ? std::int32_t(std::lrint(b[f] / acc_scale)) : 0 };
+          for (std::size_t c { 0 }; c < Cg; ++c)
+            for (std::size_t ky { 0 }; ky < weight[2]; ++ky)
+              for (std::size_t kx { 0 }; kx < weight[3]; ++kx) {
+                const auto iy { std::ptrdiff_t(y * stride.m_y + ky - pad.m_y) };
+                const auto ix { std::ptrdiff_t(z * stride.m_x + kx - pad.m_x) };
+                if (iy < 0 || ix < 0 || iy >= std::ptrdiff_t(input[2])
+                    || ix >= std::ptrdiff_t(input[3]))
+                  continue;
+                acc += (x(n, f / Og * Cg + c, iy, ix) - 100) * w(f, c, ky, kx);
+              }
+          const auto expected { requantize(acc, acc_scale / 0.75F, 5) };
+          if (out.values()(n, f, y, z) != expected) return false;
+        }
+  return out.scale() == 0.75F && out.zero_point() == 5;
+}
+
+unsigned convolution()
+{
+  ASSERT(1, matches(shape(2, 3, 9, 11), shape(5, 3, 3, 3), true, 1, 1, 1));
+  ASSERT(2, matches(shape(1, 4, 13, 10), shape(6, 4, 3, 5), false, { 2, 1 }, { 1, 2 },
+              1));
+  ASSERT(3, matches(shape(1, 64, 24, 24), shape(8, 64, 3, 3), true, 1, 1, 1));
+  ASSERT(4, matches(shape(2, 6, 8, 8), shape(4, 3, 3, 3), true, 1, 1, 2));
+  ASSERT(5, matches(shape(1, 4, 7, 7), shape(4, 1, 3, 3), false, 1, 1, 4));
+  ASSERT(6, matches(shape(2, 16, 7, 9), shape(8, 16, 1, 1), true, 1, 0, 1));
+
+  using q8 = quantized<type::int8>;
+  const q8 w { int8(shape(4, 3, 3, 3)), 0.1F };
+  EXPECT_THROW(7, std::invalid_argument, qconv2d(w, 0.0F));
+  EXPECT_THROW(8, std::invalid_argument,
+    qconv2d(q8 { int8(shape(2, 2)), { 1.0F, 1.0F }, { 0, 0 }, 1 }, 1.0F));
+  EXPECT_THROW(9, std::invalid_argument,
+    qconv2d(q8 { int8(shape(4, 3, 1, 1)), { 1, 1, 1 }, { 0, 0, 0 }, 1 }, 1.0F));
+  qconv2d layer { w, 1.0F };
+  const quantized<type::uint8> x { uint8(shape(1, 3, 5, 5)), { 1, 1, 1 }, { 0, 0, 0 },
+    1 };
+  EXPECT_THROW(10, std::invalid_argument, (void)layer.forward(x));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/net/quantized.hh", "devi::net::quantized" };
+
+  tester.run("Construction", construction);
+  tester.run("Conversion", conversion);
+  tester.run("Multiplication", multiplication);
+  tester.run("Convolution", convolution);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,96 @@
+#include "../utils.hh"
+
+#include <devi/vis>
+
+using namespace devi::core;
+using namespace devi::vis;
+
+unsigned counting()
+{
+  uint8 img { shape(64, 50, 3) };
+  for (std::size_t i { 0 }; i < img.size(); ++i) img[i] = i % 256;
+
+  // 8-bit default range
+  auto h1 { histogram(img) };
+  ASSERT(1, h1.shape() == shape(256) && h1.type() == type::uint64);
+  ASSERT(2, h1[0] == 38 && h1[127] == 38 && h1[128] == 37 && h1[255] == 37);
+
+  // coarser bins over a partial range
+  auto h2 { histogram(img, 4, 0, 128) };
+  ASSERT(3, h2[0] == 32 * 38 && h2[3] == 32 * 38);
+
+  // strided view
+  using s = slice;
+  auto v { img(s(0, 64, 2), s(), 1) };
+  auto h3 { histogram(v, 256) };
+  std::uint64_t total { 0 };
+  for (std::size_t b { 0 }; b < 256; ++b) total += h3[b];
+  ASSERT(4, total == 32 * 50 && h3[img(2, 3, 1)] > 0);
+
+  // floating point values
+  float32 f { shape(10), 0.25F };
+  f[3] = 0.75F;
+  f[4] = 1.5F;
+  auto h4 { histogram(f, 2) };
+  ASSERT(5, h4[0] == 8 && h4[1] == 1);
+
+  EXPECT_THROW(6, std::invalid_argument, (void)histogram(f, 0));
+  EXPECT_THROW(7, std::invalid_argument, (void)histogram(f, 4, 1, 1));
+
+  TEST_SUCCESS;
+}
+
+unsigned equalization()
+{
+  uint8 img { shape(16, 16) };
+  for (std::size_t i { 0 }; i < img.size(); ++i) img[i] = 100 + i % 4;
+
+  auto eq { equalize(img) };
+  ASSERT(1, eq.shape() == img.shape());
+  ASSERT(2, eq(0, 0) == 0 && eq(0, 1) == 85 && eq(0, 2) == 170 && eq(0, 3) == 255);
+
+  uint16 u { shape(8, 8), 1000 };
+  ASSERT(3, equalize(u) == u);
+
+  TEST_SUCCESS;
+}
+
+unsigned adaptive()
+{
+  uint8 img { shape(64, 96) };
+  for (std::size_t y { 0 }; y < 64; ++y)
+    for (std::size_t x { 0 }; x < 96; ++x) img(y, x) = (x < 48 ? 20 : 200) + (y + x) % 8;
+
+  auto out { clahe(img, 2.0, 4, 4) };
+  ASSERT(1, out.shape() == img.shape() && out.type() == type::uint8);
+  // contrast within both halves is stretched, and ordering is preserved within a tile
+  ASSERT(2, out(5, 5) != img(5, 5) && out(0, 7) > out(0, 0));
+
+  uint8 flat { shape(32, 32), 77 };
+  auto same { clahe(flat, 40.0, 2, 2) };
+  ASSERT(3, same(0, 0) == same(31, 31) && same(15, 16) == same(0, 0));
+
+  EXPECT_THROW(4, std::invalid_argument, (void)clahe(uint8(shape(4, 4, 1))));
+  EXPECT_THROW(5, std::invalid_argument, (void)clahe(flat, 2.0, 0, 4));
+
+  // a single tile clipped at 1 count per bin, with an excess of 397 counts (uniform 1,
+  // residual 141): the mapping only reaches the top of the range at the last bin
+  uint8 spike { shape(20, 20) };
+  spike(19, 18) = 254;
+  spike(19, 19) = 255;
+  const auto clipped { clahe(spike, 1.0, 1, 1) };
+  ASSERT(6, clipped(19, 18) == 254 && clipped(19, 19) == 255 && clipped(0, 0) == 2);
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/vis/histogram.hh", "devi::vis::histogram" };
+
+  tester.run("Counting", counting);
+  tester.run("Equalization", equalization);
+  tester.run("Adaptive", adaptive);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
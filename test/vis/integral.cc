@@ -0,0 +1,81 @@
+#include "../utils.hh"
+
+#include <devi/vis>
+
+#include <cstdlib>
+
+using namespace devi::core;
+using namespace devi::vis;
+
+unsigned construction()
+{
+  uint8 img { shape(3, 4), 2 };
+  img(1, 2) = 10;
+
+  auto table { integral(img) };
+  ASSERT(1, table.shape() == shape(4, 5) && table.type() == type::uint32);
+  ASSERT(2, table(0, 0) == 0 && table(0, 4) == 0 && table(3, 0) == 0);
+  ASSERT(3, table(1, 1) == 2 && table(2, 3) == 20 && table(3, 4) == 32);
+
+  float32 f { shape(2, 2, 2), 1.5F };
+  auto sq { integral_squared(f) };
+  ASSERT(4, sq.shape() == shape(3, 3, 2) && sq.type() == type::float64);
+  ASSERT(5, sq(2, 2, 0) == 9.0 && sq(2, 1, 1) == 4.5 && sq(1, 1, 1) == 2.25);
+
+  EXPECT_THROW(6, std::invalid_argument, (void)integral(uint8(shape(2))));
+
+  TEST_SUCCESS;
+}
+
+unsigned banded()
+{
+  // large enough to be split across multiple bands
+  int16 img { shape(300, 257) };
+  for (std::size_t i { 0 }; i < img.size(); ++i) img[i] = int(i % 41) - 20;
+
+  auto table { integral(img) };
+  for (std::size_t y { 0 }; y <= 300; y += 23) {
+    std::int64_t sum { 0 };
+    for (std::size_t i { 0 }; i < y; ++i)
+      for (std::size_t j { 0 }; j < 100; ++j) sum += img(i, j);
+    ASSERT(1, table(y, 100) == sum);
+  }
+
+  // fewer rows than threads, with enough pixels for a band per thread
+  const auto wide { integral(uint8(shape(2, 200000), 1)) };
+  ASSERT(2, wide(1, 200000) == 200000 && wide(2, 200000) == 400000);
+
+  TEST_SUCCESS;
+}
+
+unsigned query()
+{
+  uint8 img { shape(5, 6, 3) };
+  for (std::size_t i { 0 }; i < img.size(); ++i) img[i] = i % 7;
+
+  auto table { integral(img) };
+  std::uint32_t sum { 0 };
+  for (std::size_t i { 1 }; i < 4; ++i)
+    for (std::size_t j { 2 }; j < 6; ++j) sum += img(i, j, 1);
+  ASSERT(1, region_sum(table, 1, 2, 4, 6, 1) == sum);
+  ASSERT(2, region_sum(table, 2, 2, 2, 5) == 0);
+
+  EXPECT_THROW(3, std::out_of_range, (void)region_sum(table, 0, 0, 6, 1));
+  EXPECT_THROW(4, std::out_of_range, (void)region_sum(table, 3, 0, 2, 1));
+  EXPECT_THROW(5, std::out_of_range, (void)region_sum(table, 0, 0, 1, 1, 3));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  // more threads than the rows of some images, even on machines with few cores
+  setenv("DEVI_NUM_THREADS", "8", 1);
+  UnitTestRunner tester { "src/vis/integral.hh", "devi::vis::integral" };
+
+  tester.run("Construction", construction);
+  tester.run("Banded", banded);
+  tester.run("Query", query);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
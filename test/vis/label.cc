@@ -0,0 +1,141 @@
+#include "../utils.hh"
+
+#include <devi/vis>
+
+#include <cmath>
+#include <vector>
+
+using namespace devi::core;
+using namespace devi::vis;
+
+// Returns the labels of `mask` by flood filling from every pixel in raster order, and
+// writes the statistics of the components into `regions`
+template<type _DType>
+int32 reference(const array<_DType> &mask, const unsigned connectivity,
+  std::vector<region> &regions)
+{
+  const long H { long(mask.shape()[0]) }, W { long(mask.shape()[1]) };
+  int32 ret { mask.shape() };
+  regions.clear();
+  std::vector<long> stack;
+  for (long start { 0 }; start < H * W; ++start) {
+    if (!mask[start] || ret[start]) continue;
+    region g { 0, std::size_t(H), std::size_t(W), 0, 0, 0, 0 };
+    ret[start] = int(regions.size() + 1);
+    stack.push_back(start);
+    while (!stack.empty()) {
+      const long p { stack.back() }, y { p / W }, x { p % W };
+      stack.pop_back();
+      ++g.m_area;
+      g.m_top    = std::min(g.m_top, std::size_t(y));
+      g.m_left   = std::min(g.m_left, std::size_t(x));
+      g.m_bottom = std::max(g.m_bottom, std::size_t(y + 1));
+      g.m_right  = std::max(g.m_right, std::size_t(x + 1));
+      g.m_cy += double(y);
+      g.m_cx += double(x);
+      for (long dy { -1 }; dy <= 1; ++dy)
+        for (long dx { -1 }; dx <= 1; ++dx) {
+          const long v { y + dy }, u { x + dx };
+          if ((dy && dx && connectivity == 4) || v < 0 || v >= H || u < 0 || u >= W)
+            continue;
+          if (mask[v * W + u] && !ret[v * W + u]) {
+            ret[v * W + u] = ret[start];
+            stack.push_back(v * W + u);
+          }
+        }
+    }
+    g.m_cy /= double(g.m_area);
+    g.m_cx /= double(g.m_area);
+    regions.push_back(g);
+  }
+  return ret;
+}
+
+// Returns true if both lists hold the same statistics
+bool same(const std::vector<region> &a, const std::vector<region> &b)
+{
+  if (a.size() != b.size()) return false;
+  for (std::size_t i { 0 }; i < a.size(); ++i)
+    if (a[i].m_area != b[i].m_area || a[i].m_top != b[i].m_top
+        || a[i].m_left != b[i].m_left || a[i].m_bottom != b[i].m_bottom
+        || a[i].m_right != b[i].m_right || std::abs(a[i].m_cy - b[i].m_cy) > 1e-9
+        || std::abs(a[i].m_cx - b[i].m_cx) > 1e-9)
+      return false;
+  return true;
+}
+
+unsigned labels()
+{
+  // noise of several densities, with runs crossing the 64-pixel chunks of a row
+  bool ok { true };
+  std::vector<region> expected, regions;
+  for (const unsigned density : { 20, 45, 60, 90 }) {
+    uint8 mask { shape(61, 150) };
+    for (std::size_t i { 0 }; i < mask.size(); ++i)
+      mask[i] = (i * 2654435761UL >> 11) % 100 < density ? 255 : 0;
+    for (const unsigned connectivity : { 4, 8 }) {
+      ok &= label(mask, regions, connectivity) == reference(mask, connectivity, expected);
+      ok &= same(regions, expected);
+    }
+  }
+  ASSERT(1, ok);
+
+  // diagonal neighbours only connect with 8-connectivity
+  bool8 diagonal { shape(4, 4) };
+  for (std::size_t i { 0 }; i < 4; ++i) diagonal(i, i) = true;
+  ASSERT(2, label(diagonal, 4)(3, 3) == 4 && label(diagonal, 8)(3, 3) == 1);
+
+  // a ring around a spiral, whose arms are only merged rows below their first runs
+  bool8 spiral { shape(9, 9) };
+  for (std::size_t i { 0 }; i < 9; ++i) spiral(0, i) = spiral(i, 8) = spiral(8, i) = true;
+  for (std::size_t i { 2 }; i < 9; ++i) spiral(i, 0) = true;
+  for (std::size_t i { 2 }; i < 7; ++i) spiral(2, i) = spiral(6, i) = true;
+  for (std::size_t i { 2 }; i < 7; ++i) spiral(i, 6) = true;
+  spiral(4, 2) = spiral(5, 2) = spiral(4, 3) = spiral(4, 4) = true;
+  const auto rings { label(spiral, regions, 4) };
+  ASSERT(3, rings == reference(spiral, 4, expected) && same(regions, expected));
+  ASSERT(4, regions.size() == 2 && regions[1].m_top == 2 && regions[1].m_left == 2);
+
+  EXPECT_THROW(5, std::invalid_argument, (void)label(uint8(shape(4, 4, 1))));
+  EXPECT_THROW(6, std::invalid_argument, (void)label(diagonal, 6));
+  ASSERT(7, label(uint8(shape(0, 3)), regions).size() == 0 && regions.empty());
+
+  TEST_SUCCESS;
+}
+
+unsigned strips()
+{
+  // blobs spanning the seams between the strips of every thread
+  uint8 mask { shape(800, 640) };
+  for (std::size_t y { 0 }; y < 800; ++y)
+    for (std::size_t x { 0 }; x < 640; ++x) {
+      const auto blob { std::hypot(double(y % 160) - 80, double(x % 128) - 64) < 60 };
+      const auto speck { ((y * 640 + x) * 2654435761UL >> 13) % 1000 == 0 };
+      mask(y, x) = blob || speck || x == 600 || (y == 400 && x < 300) ? 1 : 0;
+    }
+  std::vector<region> expected, regions;
+  const auto labels { label(mask, regions, 8) };
+  ASSERT(1, labels == reference(mask, 8, expected));
+  ASSERT(2, same(regions, expected));
+  const auto &line { regions[std::size_t(labels(0, 600)) - 1] };
+  ASSERT(3, line.m_top == 0 && line.m_bottom == 800 && line.m_right >= 601);
+
+  // full and empty masks
+  const auto full { label(bool8(shape(700, 300), true), regions) };
+  ASSERT(4, regions.size() == 1 && regions[0].m_area == 210000 && full(699, 299) == 1);
+  ASSERT(5, std::abs(regions[0].m_cy - 349.5) < 1e-9 && regions[0].m_cx == 149.5);
+  ASSERT(6, label(bool8(shape(700, 300)), regions) == int32(shape(700, 300)));
+  ASSERT(7, regions.empty());
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/vis/label.hh", "devi::vis::label" };
+
+  tester.run("Labels", labels);
+  tester.run("Strips", strips);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,67 @@
+#include "../utils.hh"
+
+#include <devi/vis>
+
+using namespace devi::core;
+using devi::vis::to_planar;
+
+unsigned planar()
+{
+  uint8 img { shape(4, 5, 3) };
+  for (std::size_t i { 0 }; i < img.size(); ++i) img[i] = i % 251;
+
+  // plain deinterleave
+  auto p1 { to_planar(img) };
+  ASSERT(1, p1.shape() == shape(3, 4, 5) && p1.type() == type::float32);
+  ASSERT(2, p1(0, 0, 0) == img(0, 0, 0) && p1(2, 3, 4) == img(3, 4, 2)
+              && p1(1, 2, 3) == img(2, 3, 1));
+
+  // fused normalization
+  auto p2 { to_planar(img, { 1, 2, 3 }, { 2, 4, 8 }) };
+  ASSERT(3, p2(0, 1, 1) == (img(1, 1, 0) - 1) / 2.0F
+              && p2(2, 3, 2) == (img(3, 2, 2) - 3) / 8.0F);
+
+  // invalid arguments
+  EXPECT_THROW(4, std::invalid_argument, (void)to_planar(uint8(shape(4, 5))));
+  EXPECT_THROW(5, std::invalid_argument, (void)to_planar(img, { 1, 2 }));
+
+  TEST_SUCCESS;
+}
+
+unsigned crop()
+{
+  using s = slice;
+  uint8 img { shape(6, 8, 3) };
+  for (std::size_t i { 0 }; i < img.size(); ++i) img[i] = i % 253;
+
+  // strided view crop
+  auto v { img(s(1, 5), s(2, 8, 2)) };
+  auto p1 { to_planar(v, { 10, 20, 30 }) };
+  ASSERT(1, p1.shape() == shape(3, 4, 3));
+  ASSERT(2, p1(0, 0, 0) == img(1, 2, 0) - 10.0F && p1(2, 3, 2) == img(4, 6, 2) - 30.0F);
+
+  // channel-strided view (channels 0 and 2)
+  auto v2 { img(s(0, 6), s(0, 8), s(0, 3, 2)) };
+  auto p2 { to_planar(v2) };
+  ASSERT(3, p2.shape() == shape(2, 6, 8) && p2(1, 5, 7) == img(5, 7, 2));
+
+  // batch slot
+  float32 batch { shape(2, 3, 4, 3), -1 };
+  to_planar(v, batch, 1, { 10, 20, 30 });
+  ASSERT(4, batch(0, 2, 3, 2) == -1 && batch(1, 0, 0, 0) == p1(0, 0, 0)
+              && batch(1, 2, 3, 2) == p1(2, 3, 2));
+  EXPECT_THROW(5, std::out_of_range, to_planar(v, batch, 2));
+  EXPECT_THROW(6, std::invalid_argument, to_planar(img, batch, 0));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/vis/layout.hh", "devi::vis::to_planar" };
+
+  tester.run("Planar", planar);
+  tester.run("Crop", crop);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
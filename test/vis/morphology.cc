@@ -0,0 +1,106 @@
+#include "../utils.hh"
+
+#include <devi/vis>
+
+#include <algorithm>
+
+using namespace devi::core;
+using namespace devi::vis;
+
+// Returns the erosion (or dilation) of `src` by brute force, ignoring outside pixels
+template<type _DType>
+array<_DType> reference(
+  const array<_DType> &src, const std::size_t kh, const std::size_t kw, const bool max)
+{
+  const auto &s { src.shape() };
+  const std::size_t H { s[0] }, W { s[1] }, C { s.ndims() == 3 ? s[2] : 1 };
+  array<_DType> ret { s };
+  for (std::size_t y { 0 }; y < H; ++y)
+    for (std::size_t x { 0 }; x < W; ++x)
+      for (std::size_t c { 0 }; c < C; ++c) {
+        auto best { src[(y * W + x) * C + c] };
+        for (std::size_t i { 0 }; i < kh; ++i)
+          for (std::size_t j { 0 }; j < kw; ++j) {
+            const auto v { y + i }, u { x + j };
+            if (v < kh / 2 || v - kh / 2 >= H || u < kw / 2 || u - kw / 2 >= W) continue;
+            const auto p { src[((v - kh / 2) * W + u - kw / 2) * C + c] };
+            best = max ? std::max(best, p) : std::min(best, p);
+          }
+        ret[(y * W + x) * C + c] = best;
+      }
+  return ret;
+}
+
+unsigned filters()
+{
+  // every kernel size, through both the direct and the van Herk/Gil-Werman paths
+  uint8 gray { shape(37, 71) };
+  for (std::size_t i { 0 }; i < gray.size(); ++i) gray[i] = (i * 2654435761UL >> 7) % 256;
+  bool ok { true };
+  for (std::size_t kh { 1 }; kh <= 11; kh += 2)
+    for (std::size_t kw { 1 }; kw <= 12; kw += 3) {
+      ok &= erode(gray, kh, kw) == reference(gray, kh, kw, false);
+      ok &= dilate(gray, kh, kw) == reference(gray, kh, kw, true);
+    }
+  ASSERT(1, ok);
+
+  // channels are filtered independently, and windows can be larger than the image
+  float32 color { shape(9, 13, 3) };
+  for (std::size_t i { 0 }; i < color.size(); ++i) color[i] = float(i % 17) - 8.5F;
+  ASSERT(2, erode(color, 5, 6) == reference(color, 5, 6, false));
+  ASSERT(3, dilate(color, 25, 2) == reference(color, 25, 2, true));
+  int8 signs { shape(40, 70) };
+  for (std::size_t i { 0 }; i < signs.size(); ++i) signs[i] = int(i % 251) - 125;
+  ASSERT(4, erode(signs, 3, 4) == reference(signs, 3, 4, false));
+
+  // large enough to be split between threads
+  uint8 frame { shape(480, 640) };
+  for (std::size_t i { 0 }; i < frame.size(); ++i) frame[i] = (i * 40503UL >> 5) % 256;
+  ASSERT(5, erode(frame, 15, 15) == reference(frame, 15, 15, false));
+  ASSERT(6, dilate(frame, 2, 3) == reference(frame, 2, 3, true));
+
+  EXPECT_THROW(7, std::invalid_argument, (void)erode(uint8(shape(4)), 3, 3));
+  EXPECT_THROW(8, std::invalid_argument, (void)dilate(gray, 0, 3));
+  ASSERT(9, erode(uint8(shape(0, 5)), 3, 3).shape() == shape(0, 5));
+
+  TEST_SUCCESS;
+}
+
+unsigned masks()
+{
+  // a 20x20 square with a hole, a speck and a notch
+  bool8 mask { shape(40, 40) };
+  for (std::size_t y { 10 }; y < 30; ++y)
+    for (std::size_t x { 10 }; x < 30; ++x) mask(y, x) = true;
+  mask(20, 20) = false;
+  mask(3, 3)   = true;
+  mask(10, 15) = false;
+
+  ASSERT(1, erode(mask, 3, 3) == reference(mask, 3, 3, false));
+  ASSERT(2, dilate(mask, 7, 5) == reference(mask, 7, 5, true));
+
+  // opening removes the speck, closing fills the hole and the notch
+  const auto opened { open(mask, 3, 3) };
+  ASSERT(3, !opened(3, 3) && opened(15, 15) && !opened(20, 20));
+  const auto closed { close(mask, 3, 3) };
+  ASSERT(4, closed(20, 20) && closed(10, 15) && closed(3, 3) && !closed(5, 5));
+
+  // the gradient is the band around every boundary
+  const auto edges { gradient(mask, 3, 3) };
+  ASSERT(5, edges(9, 15) && edges(10, 12) && !edges(15, 15) && !edges(0, 39));
+  ASSERT(6, edges(19, 20) && edges(2, 2) && !edges(20, 35));
+  const auto dark { gradient(uint8(shape(5, 5), 7), 3, 3) };
+  ASSERT(7, dark == uint8(shape(5, 5)));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/vis/morphology.hh", "devi::vis::erode" };
+
+  tester.run("Filters", filters);
+  tester.run("Masks", masks);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
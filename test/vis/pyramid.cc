@@ -0,0 +1,210 @@
+#include "../utils.hh"
+
+#include <devi/vis>
+
+#include <cmath>
+
+using namespace devi::core;
+using namespace devi::vis;
+
+// Returns `src` blurred by the 5x5 binomial kernel and downsampled, by brute force
+template<type _DType>
+array<_DType> reference(const array<_DType> &src)
+{
+  const auto &s { src.shape() };
+  const long H { long(s[0]) }, W { long(s[1]) }, C { s.ndims() == 3 ? long(s[2]) : 1 };
+  const long Hd { (H + 1) / 2 }, Wd { (W + 1) / 2 };
+  const double weights[5] { 1, 4, 6, 4, 1 };
+  const auto mirror { [](long i, const long n) {
+    for (; n > 1 && (i < 0 || i >= n);) i = i < 0 ? -i : 2 * n - 2 - i;
+    return n > 1 ? i : 0;
+  } };
+  array<_DType> ret { s.ndims() == 3 ? shape(Hd, Wd, C) : shape(Hd, Wd) };
+  for (long y { 0 }; y < Hd; ++y)
+    for (long x { 0 }; x < Wd; ++x)
+      for (long c { 0 }; c < C; ++c) {
+        double sum { 0 };
+        for (long i { 0 }; i < 5; ++i)
+          for (long j { 0 }; j < 5; ++j) {
+            const long v { mirror(2 * y + i - 2, H) }, u { mirror(2 * x + j - 2, W) };
+            sum += weights[i] * weights[j] * double(src[(v * W + u) * C + c]);
+          }
+        sum /= 256;
+        ret[(y * Wd + x) * C + c] = std::is_integral_v<std::decay_t<decltype(ret[0])>>
+          ? std::floor(sum + 0.5)
+          : sum;
+      }
+  return ret;
+}
+
+// Returns `src` upsampled to `target` (zeros after every row and column, then blurred),
+// by brute force
+template<type _DType>
+array<_DType> upsampled(const array<_DType> &src, const shape &target)
+{
+  const long H { long(target[0]) }, W { long(target[1]) }, Ws { long(src.shape()[1]) },
+    C { target.ndims() == 3 ? long(target[2]) : 1 };
+  const double weights[5] { 1, 4, 6, 4, 1 };
+  const auto mirror { [](long i, const long n) {
+    for (; n > 1 && (i < 0 || i >= n);) i = i < 0 ? -i : 2 * n - 2 - i;
+    return n > 1 ? i : 0;
+  } };
+  array<_DType> ret { target };
+  for (long y { 0 }; y < H; ++y)
+    for (long x { 0 }; x < W; ++x)
+      for (long c { 0 }; c < C; ++c) {
+        // (the weights of every dimension add up to 8, or 16 for a single pixel)
+        double sum { 0 }, wy { 0 }, wx { 0 };
+        for (long i { 0 }; i < 5; ++i) {
+          wy += mirror(y + i - 2, H) % 2 ? 0 : weights[i];
+          wx += mirror(x + i - 2, W) % 2 ? 0 : weights[i];
+          for (long j { 0 }; j < 5; ++j) {
+            const long v { mirror(y + i - 2, H) }, u { mirror(x + j - 2, W) };
+            if (v % 2 || u % 2) continue;
+            sum += weights[i] * weights[j] * double(src[((v / 2) * Ws + u / 2) * C + c]);
+          }
+        }
+        sum /= wy * wx;
+        ret[(y * W + x) * C + c] = std::is_integral_v<std::decay_t<decltype(ret[0])>>
+          ? std::floor(sum + 0.5)
+          : sum;
+      }
+  return ret;
+}
+
+// Returns true if the elements of `level` (an array or a view) are close to the elements
+// of `expected`
+template<typename _Level, type _DType>
+bool matches(const _Level &level, const array<_DType> &expected)
+{
+  if (level.shape() != expected.shape()) return false;
+  for (std::size_t i { 0 }; i < expected.size(); ++i)
+    if (std::abs(double(level[i]) - double(expected[i])) > 1e-4) return false;
+  return true;
+}
+
+unsigned levels()
+{
+  // odd sizes, thin images and more levels than halvings of the width
+  uint8 gray { shape(37, 6) };
+  for (std::size_t i { 0 }; i < gray.size(); ++i) gray[i] = (i * 2654435761UL >> 7) % 256;
+  pyramid<type::uint8> p { gray, 5 };
+  ASSERT(1, p.levels() == 5 && p.shape(1) == shape(19, 3) && p.shape(4) == shape(3, 1));
+  bool ok { matches(p.level(0), gray) };
+  auto expected { gray };
+  for (std::size_t i { 1 }; i < p.levels(); ++i) {
+    expected = reference(expected);
+    ok &= matches(p.level(i), expected);
+  }
+  ASSERT(2, ok);
+
+  // channels are filtered independently, and large levels are split between threads
+  float32 color { shape(300, 257, 3) };
+  for (std::size_t i { 0 }; i < color.size(); ++i) color[i] = std::sin(float(i) / 7);
+  pyramid<type::float32> q { color, 3 };
+  const auto half { reference(color) };
+  ASSERT(3, matches(q.level(1), half) && matches(q.level(2), reference(half)));
+  int16 signs { shape(2, 9) };
+  for (std::size_t i { 0 }; i < signs.size(); ++i) signs[i] = int(i % 7) * 900 - 3000;
+  ASSERT(4, matches(pyramid<type::int16>(signs, 2).level(1), reference(signs)));
+
+  EXPECT_THROW(5, std::invalid_argument, (pyramid<type::uint8> { shape(4), 2 }));
+  EXPECT_THROW(6, std::invalid_argument, (pyramid<type::uint8> { gray, 0 }));
+  EXPECT_THROW(7, std::out_of_range, (void)p.level(5));
+
+  TEST_SUCCESS;
+}
+
+unsigned reuse()
+{
+  // all the levels are disjoint windows of one cache-aligned allocation
+  pyramid<type::uint16> p { shape(480, 640), 4 };
+  const auto *const base { p.level(0).data() };
+  std::size_t end { 0 };
+  bool ok { true };
+  for (std::size_t i { 0 }; i < p.levels(); ++i) {
+    const auto offset { std::size_t(p.level(i).data() - base) };
+    ok &= offset >= end && offset * sizeof(std::uint16_t) % 64 == 0;
+    end = offset + p.shape(i).size();
+  }
+  ASSERT(1, ok && p.bytes() == end * sizeof(std::uint16_t));
+  ASSERT(2, p.bytes() < 480 * 640 * 2 * 4 / 3 + 4 * 64);
+
+  // a new frame reuses the memory, so views taken earlier see it
+  auto top { p.level(3) };
+  uint16 frame { shape(480, 640), 1000 };
+  p.build(frame);
+  ASSERT(3, p.level(0).data() == base && top(59, 79) == 1000 && top(0, 0) == 1000);
+
+  // a frame can also be written into the base level directly
+  auto bottom { p.level(0) };
+  for (std::size_t i { 0 }; i < bottom.size(); ++i) bottom[i] = 256;
+  p.build();
+  ASSERT(4, top(30, 40) == 256);
+
+  EXPECT_THROW(5, std::invalid_argument, p.build(uint16(shape(480, 641))));
+
+  TEST_SUCCESS;
+}
+
+unsigned laplacian()
+{
+  // expansion to odd and even shapes, of single columns and of channels
+  uint8 gray { shape(37, 6) };
+  for (std::size_t i { 0 }; i < gray.size(); ++i) gray[i] = (i * 2654435761UL >> 7) % 256;
+  const auto half { reference(gray) }, quarter { reference(reference(half)) };
+  ASSERT(1, matches(expand(half, shape(37, 6)), upsampled(half, shape(37, 6))));
+  ASSERT(2, matches(expand(half, shape(38, 5)), upsampled(half, shape(38, 5))));
+  ASSERT(3, matches(expand(quarter, shape(9, 1)), upsampled(quarter, shape(9, 1))));
+  float32 color { shape(41, 30, 3) };
+  for (std::size_t i { 0 }; i < color.size(); ++i) color[i] = std::sin(float(i) / 7);
+  const auto small { reference(color) };
+  ASSERT(4, matches(expand(small, shape(41, 30, 3)), upsampled(small, shape(41, 30, 3))));
+
+  // every level is a Gaussian level minus the expansion of the one above it
+  laplacian_pyramid<type::uint8> p { gray, 3 };
+  pyramid<type::uint8> gaussian { gray, 3 };
+  int16 wide { gray.shape() }, expected { gray.shape() };
+  for (std::size_t i { 0 }; i < gray.size(); ++i) wide[i] = gray[i];
+  const auto up { upsampled(half, gray.shape()) };
+  for (std::size_t i { 0 }; i < gray.size(); ++i) expected[i] = wide[i] - up[i];
+  ASSERT(5, p.levels() == 3 && matches(p.level(0), expected));
+  bool ok { true };
+  for (std::size_t i { 0 }; i < p.shape(2).size(); ++i)
+    ok &= p.level(2)[i] == gaussian.level(2)[i];
+  ASSERT(6, ok && p.level(2).shape() == shape(10, 2));
+
+  // integer images are reconstructed exactly, and floating point ones closely
+  ASSERT(7, p.reconstruct() == gray);
+  uint16 frame { shape(300, 257) };
+  for (std::size_t i { 0 }; i < frame.size(); ++i)
+    frame[i] = (i * 2654435761UL >> 9) % 65536;
+  laplacian_pyramid<type::uint16> q { frame, 5 };
+  ASSERT(8, q.reconstruct() == frame);
+  laplacian_pyramid<type::float32> r { color, 4 };
+  ASSERT(9, matches(r.reconstruct(), color));
+
+  // all the levels share one allocation, which is reused for a new image
+  const auto *const base { p.level(0).data() };
+  ASSERT(10, p.level(2).data() > p.level(1).data() && p.level(1).data() > base);
+  p.build(uint8(gray.shape(), 7));
+  ASSERT(11, p.level(0).data() == base && p.level(0)(36, 5) == 0);
+  ASSERT(12, p.level(2)(0, 0) == 7);
+
+  EXPECT_THROW(13, std::invalid_argument, (void)expand(half, shape(36, 6)));
+  EXPECT_THROW(14, std::invalid_argument, (void)expand(half, shape(37, 6, 1)));
+  EXPECT_THROW(15, std::invalid_argument, p.build(uint8(shape(37, 7))));
+
+  TEST_SUCCESS;
+}
+
+int main()
+{
+  UnitTestRunner tester { "src/vis/pyramid.hh", "devi::vis::pyramid" };
+
+  tester.run("Levels", levels);
+  tester.run("Reuse", reuse);
+  tester.run("Laplacian", laplacian);
+
+  return tester.passed() == tester.total() ? EXIT_SUCCESS : EXIT_FAILURE;
+}